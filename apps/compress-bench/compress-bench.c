@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief Round-trip test and benchmark for the schedule compression
+ * 
+ * Generates random slot sets (sorted, with several slots per node, unsorted 
+ * and slowly changing ones), compresses them with lwb_sched_compress() and 
+ * checks that lwb_sched_uncompress() restores the original slots. For each 
+ * workload, the bytes saved, the chosen encodings and the percentiles of the
+ * execution time of both functions are reported in host cycles and as an
+ * estimate of the MSP430 cycles. Finally, random data is passed to
+ * lwb_sched_uncompress() to make sure invalid schedules are rejected without
+ * accessing memory outside of the schedule (run with -fsanitize=address).
+ *
+ * The program returns EXIT_FAILURE if a schedule is not restored or if the
+ * uncompression (on the critical path of the source nodes, between the 
+ * reception of the schedule and the first slot) exceeds LWB_CONF_T_GAP on
+ * the MSP430.
+ *
+ * Run 'make bench' to test with and without LWB_CONF_SCHED_DIFF.
+ */
+
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "contiki.h"
+#include "platform.h"
+
+/*---------------------------------------------------------------------------*/
+typedef enum {
+  SLOTS_SORTED = 0,             /* unique node IDs in increasing order */
+  SLOTS_STREAMS,                /* several slots per node */
+  SLOTS_UNSORTED,               /* unique node IDs in random order */
+  SLOTS_STABLE,                 /* few insertions / removals per round */
+} slots_mode_t;
+
+typedef struct {
+  const char*  name;
+  slots_mode_t mode;
+  uint16_t     id_range;        /* node IDs are between 1 and id_range */
+} workload_t;
+
+typedef struct {
+  uint32_t p50;
+  uint32_t p99;
+  uint32_t max;
+} percentiles_t;
+/*---------------------------------------------------------------------------*/
+static const workload_t workloads[] = {
+  { "dense",    SLOTS_SORTED,   2 * LWB_CONF_MAX_DATA_SLOTS },
+  { "sparse",   SLOTS_SORTED,   1000 },
+  { "wide",     SLOTS_SORTED,   65535 },
+  { "streams",  SLOTS_STREAMS,  LWB_CONF_MAX_DATA_SLOTS },
+  { "unsorted", SLOTS_UNSORTED, 1000 },
+  { "stable",   SLOTS_STABLE,   200 },
+};
+static lwb_schedule_t sched;
+static uint16_t slots[LWB_CONF_MAX_DATA_SLOTS];
+static uint8_t  n_slots;
+static uint32_t t_compress[COMPRESS_BENCH_CONF_ROUNDS];
+static uint32_t t_uncompress[COMPRESS_BENCH_CONF_ROUNDS];
+static double   cycles_per_us;
+/* available MSP430 cycles between the reception of the schedule and the 
+ * first slot */
+static const uint32_t budget_uncompress = (uint32_t)
+  ((uint64_t)LWB_CONF_T_GAP * MCLK_SPEED / RTIMER_SECOND_HF);
+/*---------------------------------------------------------------------------*/
+PROCESS(compress_bench_process, "Compression Benchmark");
+AUTOSTART_PROCESSES(&compress_bench_process);
+/*---------------------------------------------------------------------------*/
+static inline uint64_t
+get_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  /* no cycle counter: use nanoseconds */
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+static double
+calibrate(void)
+{
+  struct timespec t0, t1;
+  uint64_t c0, c1;
+  double elapsed_us;
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  c0 = get_cycles();
+  do {
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    elapsed_us = (t1.tv_sec - t0.tv_sec) * 1e6 + 
+                 (t1.tv_nsec - t0.tv_nsec) / 1e3;
+  } while(elapsed_us < 50000);
+  c1 = get_cycles();
+  return (c1 - c0) / elapsed_us;
+}
+/*---------------------------------------------------------------------------*/
+static int
+cmp_u16(const void* a, const void* b)
+{
+  uint16_t x = *(const uint16_t*)a, y = *(const uint16_t*)b;
+  return (x > y) - (x < y);
+}
+/*---------------------------------------------------------------------------*/
+static int
+cmp_u32(const void* a, const void* b)
+{
+  uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+  return (x > y) - (x < y);
+}
+/*---------------------------------------------------------------------------*/
+static percentiles_t
+get_percentiles(uint32_t* samples, uint32_t n)
+{
+  percentiles_t p = { 0 };
+  if(n) {
+    qsort(samples, n, sizeof(uint32_t), cmp_u32);
+    p.p50 = samples[n * 50 / 100];
+    p.p99 = samples[n * 99 / 100];
+    p.max = samples[n - 1];
+  }
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+static inline uint32_t
+msp430_cycles(uint32_t host_cycles)
+{
+  return host_cycles * COMPRESS_BENCH_CONF_MSP430_FACTOR;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+get_id(const workload_t* w)
+{
+  return 1 + ((uint32_t)random_rand() << 16 | random_rand()) % w->id_range;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+contains(uint16_t id)
+{
+  uint8_t i;
+  for(i = 0; i < n_slots; i++) {
+    if(slots[i] == id) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* generates the slots of the next schedule */
+static void
+next_slots(const workload_t* w)
+{
+  uint8_t i;
+  
+  if(w->mode == SLOTS_STABLE) {
+    /* remove or insert up to 3 slots */
+    uint8_t n_changes = random_rand() % 4;
+    while(n_changes--) {
+      if(n_slots && (n_slots == LWB_CONF_MAX_DATA_SLOTS || 
+                     (random_rand() & 1))) {
+        i = random_rand() % n_slots;
+        slots[i] = slots[--n_slots];
+      } else {
+        uint16_t id;
+        do {
+          id = get_id(w);
+        } while(contains(id));
+        slots[n_slots++] = id;
+      }
+    }
+  } else {
+    n_slots = random_rand() % (LWB_CONF_MAX_DATA_SLOTS + 1);
+    for(i = 0; i < n_slots; i++) {
+      uint16_t id;
+      do {
+        id = get_id(w);
+        /* only SLOTS_STREAMS allows several slots per node */
+      } while(w->mode != SLOTS_STREAMS && contains(id));
+      slots[i] = id;
+    }
+  }
+  if(w->mode != SLOTS_UNSORTED) {
+    qsort(slots, n_slots, sizeof(uint16_t), cmp_u16);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+run_workload(const workload_t* w)
+{
+  uint32_t r, n_raw = 0, n_compr = 0;
+  uint32_t n_enc[LWB_SCHED_N_ENC + 1] = { 0 };   /* last entry: diff */
+  percentiles_t p_compr, p_uncompr;
+  uint64_t t;
+  
+  n_slots = 0;
+  for(r = 0; r < COMPRESS_BENCH_CONF_ROUNDS; r++) {
+    uint16_t flags = random_rand() & 0xe000;    /* S-ACK, cont. and D-ACK */
+    uint16_t len;
+    
+    next_slots(w);
+    memset(&sched, 0, sizeof(sched));
+    memcpy(sched.slot, slots, n_slots * 2);
+    sched.n_slots = n_slots | flags;
+    
+    t = get_cycles();
+    len = lwb_sched_compress(&sched);
+    t_compress[r] = (uint32_t)(get_cycles() - t);
+#if LWB_CONF_SCHED_DIFF
+    if(LWB_SCHED_IS_DIFF(&sched)) {
+      n_enc[LWB_SCHED_N_ENC]++;
+    } else
+#endif /* LWB_CONF_SCHED_DIFF */
+    {
+      n_enc[LWB_SCHED_GET_ENC(&sched)]++;
+    }
+    n_raw   += n_slots * 2;
+    n_compr += len;
+    
+    t = get_cycles();
+    if(!lwb_sched_uncompress(&sched) || 
+       LWB_SCHED_N_SLOTS(&sched) != n_slots ||
+       (sched.n_slots & 0xe000) != flags ||
+       memcmp(sched.slot, slots, n_slots * 2)) {
+      printf("ERROR: %s: schedule %lu with %u slots not restored\r\n", 
+             w->name, (unsigned long)r, n_slots);
+      return 0;
+    }
+    t_uncompress[r] = (uint32_t)(get_cycles() - t);
+  }
+  
+  p_compr = get_percentiles(t_compress, COMPRESS_BENCH_CONF_ROUNDS);
+  p_uncompr = get_percentiles(t_uncompress, COMPRESS_BENCH_CONF_ROUNDS);
+  printf("%-9s %7.1f %7.1f %6.1f%% %5u %5u %5u %5u %5u %9u %9u %9u %9u "
+         "%11u\r\n", w->name, 
+         (double)n_raw / COMPRESS_BENCH_CONF_ROUNDS,
+         (double)n_compr / COMPRESS_BENCH_CONF_ROUNDS,
+         n_raw ? 100.0 * (n_raw - n_compr) / n_raw : 0.0,
+         n_enc[LWB_SCHED_ENC_RAW], n_enc[LWB_SCHED_ENC_DELTA_RLE], 
+         n_enc[LWB_SCHED_ENC_BITMAP], n_enc[LWB_SCHED_ENC_RICE], 
+         n_enc[LWB_SCHED_N_ENC], 
+         p_compr.p50, p_compr.p99, p_uncompr.p50, p_uncompr.p99, 
+         msp430_cycles(p_uncompr.p99));
+  
+  if(msp430_cycles(p_uncompr.p99) > budget_uncompress) {
+    printf("ERROR: uncompression exceeds the budget of %lu cycles\r\n",
+           (unsigned long)budget_uncompress);
+    return 0;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* passes random data to lwb_sched_uncompress(), must not crash */
+static void
+run_garbage(void)
+{
+  uint32_t r, n_ok = 0;
+  uint16_t i;
+  
+  for(r = 0; r < COMPRESS_BENCH_CONF_GARBAGE; r++) {
+    for(i = 0; i < sizeof(sched) / 2; i++) {
+      ((uint16_t*)&sched)[i] = random_rand();
+    }
+    sched.n_slots = (sched.n_slots & ~0x003f) | 
+                    (random_rand() % (LWB_CONF_MAX_DATA_SLOTS + 1));
+    n_ok += lwb_sched_uncompress(&sched);
+  }
+  printf("# %lu random schedules, %lu accepted\r\n", 
+         (unsigned long)COMPRESS_BENCH_CONF_GARBAGE, (unsigned long)n_ok);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(compress_bench_process, ev, data) 
+{
+  uint8_t i, success = 1;
+
+  PROCESS_BEGIN();
+
+  cycles_per_us = calibrate();
+  printf("# data slots: %u, diff: %u, rounds: %u, %.0f host cycles/us, "
+         "MSP430 factor: %u\r\n", LWB_CONF_MAX_DATA_SLOTS, 
+         LWB_CONF_SCHED_DIFF, COMPRESS_BENCH_CONF_ROUNDS, cycles_per_us, 
+         COMPRESS_BENCH_CONF_MSP430_FACTOR);
+  printf("# MSP430 budget: %lu cycles (uncompression)\r\n", 
+         (unsigned long)budget_uncompress);
+  printf("# %-7s %7s %7s %7s %5s %5s %5s %5s %5s %9s %9s %9s %9s %11s\r\n",
+         "workload", "raw[B]", "len[B]", "saved", "raw", "drle", "bmap", 
+         "rice", "diff", "comp_p50", "comp_p99", "unc_p50", "unc_p99", 
+         "msp430_p99");
+  for(i = 0; i < sizeof(workloads) / sizeof(workload_t); i++) {
+    success &= run_workload(&workloads[i]);
+  }
+  run_garbage();
+  exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __CONFIG_H__
+#define __CONFIG_H__
+
+/*
+ * application specific config file to override default settings
+ */
+
+#define HOST_ID    1
+
+/* the schedule compression does not depend on the scheduler */
+#define LWB_SCHED_STATIC
+
+#ifndef LWB_CONF_MAX_DATA_SLOTS
+#define LWB_CONF_MAX_DATA_SLOTS         57
+#endif /* LWB_CONF_MAX_DATA_SLOTS */
+
+/* number of schedules per workload */
+#define COMPRESS_BENCH_CONF_ROUNDS      20000
+
+/* number of random (invalid) schedules passed to lwb_sched_uncompress */
+#define COMPRESS_BENCH_CONF_GARBAGE     100000
+
+/* ratio between the number of MSP430 cycles and the number of host cycles, 
+ * see apps/sched-bench */
+#define COMPRESS_BENCH_CONF_MSP430_FACTOR  4
+
+#define DEBUG_PRINT_CONF_LEVEL          DEBUG_PRINT_LVL_EMERGENCY
+
+#endif /* __CONFIG_H__ */
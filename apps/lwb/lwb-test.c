@@ -78,29 +78,31 @@ PROCESS_THREAD(app_process, ev, data)
     PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
     TASK_ACTIVE;      /* application task runs now */
     
-    if(HOST_ID == node_id) {
+    if(lwb_is_host()) {
       /* we are the host */
-      /* print out the received data */
-      uint8_t pkt_buffer[LWB_CONF_MAX_DATA_PKT_LEN];
+      /* print out the received data (read in place, no copy needed) */
+#if LWB_VERSION == 2
+      /* the compact API does not report the sender */
+      while(lwb_rcv_pkt_peek(0)) {
+        DEBUG_PRINT_MSG_NOW("data packet received");
+        lwb_rcv_pkt_consume();
+      } 
+#else /* LWB_VERSION */
       uint16_t sender_id;
-      while(1) {
-        uint8_t pkt_len = lwb_rcv_pkt(pkt_buffer, &sender_id, 0);
-        if(pkt_len) {
-          /* use DEBUG_PRINT_MSG_NOW to prevent a queue overflow */
-          DEBUG_PRINT_MSG_NOW("data packet received from node %u",
-                              sender_id);
-        } else {
-          break;
-        }
+      while(lwb_rcv_pkt_peek(0, &sender_id, 0)) {
+        /* use DEBUG_PRINT_MSG_NOW to prevent a queue overflow */
+        DEBUG_PRINT_MSG_NOW("data packet received from node %u", sender_id);
+        lwb_rcv_pkt_consume();
       } 
+#endif /* LWB_VERSION */
     } else {
       /* we are a source node */
       if(stream_state != LWB_STREAM_STATE_ACTIVE) {
         stream_state = lwb_stream_get_state(1);
         if(stream_state == LWB_STREAM_STATE_INACTIVE) {
-          /* request a stream with ID 1 and an IPI (inter packet interval) 
-           * of 10 seconds */
-          lwb_stream_req_t my_stream = { node_id, 0, 1, 10 };
+          /* request a stream with ID 1, an IPI (inter packet interval) 
+           * of 10 seconds and a max. payload length of 2 bytes */
+          lwb_stream_req_t my_stream = { node_id, 2, 1, 10 };
           if(!lwb_request_stream(&my_stream, 0)) {
             DEBUG_PRINT_ERROR("stream request failed");
           }
@@ -108,7 +110,11 @@ PROCESS_THREAD(app_process, ev, data)
       } else {
         /* generate a dummy packet */
         uint16_t data = 0xaa;
+#if LWB_VERSION == 2
+        if(!lwb_send_pkt((uint8_t*)&data, 2)) {
+#else /* LWB_VERSION */
         if(!lwb_send_pkt(0, 1, (uint8_t*)&data, 2)) {
+#endif /* LWB_VERSION */
           DEBUG_PRINT_WARNING("out queue full, packet dropped");
         } /* else: data packet successfully passed to the LWB */
       }
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __CONFIG_H__
+#define __CONFIG_H__
+
+/*
+ * application specific config file to override default settings
+ */
+
+#define HOST_ID    1
+
+/* select the scheduler to benchmark (the Makefile passes one of these 
+ * defines, see 'make bench') */
+#if defined(SCHED_BENCH_MIN_ENERGY)
+  #define LWB_SCHED_MIN_ENERGY
+  #define SCHED_BENCH_NAME              "min-energy"
+#elif defined(SCHED_BENCH_EDF)
+  #define LWB_SCHED_EDF
+  #define SCHED_BENCH_NAME              "edf"
+#elif defined(SCHED_BENCH_MIN_DELAY)
+  #define LWB_SCHED_MIN_DELAY
+  #define SCHED_BENCH_NAME              "min-delay"
+#else
+  #define LWB_SCHED_STATIC
+  #define SCHED_BENCH_NAME              "static"
+#endif
+
+#ifndef LWB_CONF_MAX_DATA_SLOTS
+#define LWB_CONF_MAX_DATA_SLOTS         20
+#endif /* LWB_CONF_MAX_DATA_SLOTS */
+
+#ifndef LWB_CONF_MAX_N_STREAMS
+#define LWB_CONF_MAX_N_STREAMS          256
+#endif /* LWB_CONF_MAX_N_STREAMS */
+
+/* the stream requests of one round must fit into the S-ACK buffer */
+#define LWB_CONF_SCHED_SACK_BUFFER_SIZE 8
+
+/* number of rounds (calls to lwb_sched_compute) per workload */
+#define SCHED_BENCH_CONF_ROUNDS         2000
+
+/* number of runs per workload; all runs make the same decisions and the 
+ * shortest execution time of each call over all runs is evaluated, which
+ * removes the interruptions by the host OS from the measurement */
+#define SCHED_BENCH_CONF_RUNS           5
+
+/* ratio between the number of MSP430 cycles and the number of host cycles 
+ * needed to execute the scheduler; calibrate this value with a measurement 
+ * of stats.t_sched_max on the target */
+#define SCHED_BENCH_CONF_MSP430_FACTOR  4
+
+/* tolerance for the estimate of the MSP430 cycles in percent of the budget:
+ * an estimate above the budget only fails the benchmark if it exceeds the
+ * budget by more than this margin (a warning is printed otherwise) */
+#define SCHED_BENCH_CONF_MARGIN         10
+
+/* no debug output: measure the scheduler only */
+#define DEBUG_PRINT_CONF_LEVEL          DEBUG_PRINT_LVL_EMERGENCY
+
+#endif /* __CONFIG_H__ */
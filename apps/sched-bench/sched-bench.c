@@ -0,0 +1,416 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief Benchmark for the LWB schedulers
+ * 
+ * Runs the scheduler selected in config.h on the host machine and feeds it
+ * with synthetic workloads: the stream requests are passed to 
+ * lwb_sched_proc_srq() and the schedule is computed once per round with
+ * lwb_sched_compute(), as on the host node. For each workload, the 
+ * percentiles of the execution time of both functions are reported in host
+ * cycles and as an estimate of the MSP430 cycles, as well as the average
+ * size of the (compressed) schedule. Each workload is run 
+ * SCHED_BENCH_CONF_RUNS times with the same random numbers, and the shortest
+ * execution time of each call is used, so the interruptions by the host OS
+ * do not count. The program returns EXIT_FAILURE if the estimate (99th 
+ * percentile) exceeds the time available on the MSP430 by more than 
+ * SCHED_BENCH_CONF_MARGIN percent, i.e. the gap before 
+ * LWB_CONF_T_SCHED2_START for the schedule computation and LWB_CONF_T_GAP 
+ * for a stream request, or if the scheduler removed a stream although all 
+ * streams fit into one round and no packet was lost.
+ *
+ * Run 'make bench' to cover all schedulers and several values of
+ * LWB_CONF_MAX_DATA_SLOTS.
+ *
+ * With LWB_CONF_SCHED_PIPELINED, lwb_sched_proc_slot() is called after each 
+ * data slot; its execution time is reported separately and checked against
+ * LWB_CONF_T_GAP, the budget of lwb_sched_compute() is the gap after the
+ * contention slot.
+ *
+ * If the stream information is kept in the external memory 
+ * (LWB_CONF_SCHED_USE_XMEM), the number of accesses to the (emulated) 
+ * external memory per round is reported as well.
+ */
+
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "contiki.h"
+#include "platform.h"
+
+/*---------------------------------------------------------------------------*/
+#define MAX_REQ_PER_ROUND       4       /* stream requests per round */
+#define FIRST_NODE_ID           (HOST_ID + 1)
+
+typedef enum {
+  IPI_UNIFORM = 0,              /* all streams have the same IPI */
+  IPI_DIVERSE,                  /* random IPIs (many different periods) */
+  IPI_SATURATED,                /* IPI of 1s, exceeds the bandwidth */
+} ipi_mode_t;
+
+typedef struct {
+  const char* name;
+  uint16_t   n_streams;
+  uint8_t    streams_per_node;
+  ipi_mode_t ipi_mode;
+  uint8_t    loss;              /* packet loss in percent */
+  uint8_t    churn;             /* prob. of an update/removal per round in % */
+} workload_t;
+
+typedef struct {
+  uint32_t p50;
+  uint32_t p90;
+  uint32_t p99;
+  uint32_t max;
+} percentiles_t;
+/*---------------------------------------------------------------------------*/
+static const uint16_t n_streams[] = { 8, 32, 128, LWB_CONF_MAX_N_STREAMS };
+static const workload_t workloads[] = {
+  { "uniform",   0, 1, IPI_UNIFORM,   0,  0 },
+  { "diverse",   0, 1, IPI_DIVERSE,   0,  0 },
+  { "saturated", 0, 1, IPI_SATURATED, 0,  0 },
+  { "churn",     0, 2, IPI_DIVERSE,   5, 10 },
+};
+static lwb_schedule_t sched;
+static uint8_t  streams_to_update[LWB_CONF_MAX_DATA_SLOTS];
+static uint8_t  joined[LWB_CONF_MAX_N_STREAMS];
+static uint8_t  next_stream[LWB_CONF_MAX_N_STREAMS];    /* per node */
+static uint32_t t_compute[SCHED_BENCH_CONF_ROUNDS];
+static uint32_t t_srq[SCHED_BENCH_CONF_ROUNDS * MAX_REQ_PER_ROUND];
+#if LWB_CONF_SCHED_PIPELINED
+static uint32_t t_slot[SCHED_BENCH_CONF_ROUNDS * LWB_CONF_MAX_DATA_SLOTS];
+#endif /* LWB_CONF_SCHED_PIPELINED */
+static uint8_t  sack_buffer[LWB_CONF_MAX_PKT_LEN];
+static double   cycles_per_us;
+/* available MSP430 cycles: the schedule is computed after the contention slot
+ * of a full round, a stream request is processed between two slots */
+#if LWB_CONF_SCHED_PIPELINED
+static const uint32_t budget_compute = (uint32_t)
+  ((uint64_t)(LWB_CONF_T_SCHED2_GAP + LWB_CONF_T_GAP) *
+   MCLK_SPEED / RTIMER_SECOND_HF);
+#else /* LWB_CONF_SCHED_PIPELINED */
+static const uint32_t budget_compute = (uint32_t)
+  ((uint64_t)(LWB_CONF_T_SCHED2_START - LWB_T_ROUND_MAX + LWB_CONF_T_GAP) *
+   MCLK_SPEED / RTIMER_SECOND_HF);
+#endif /* LWB_CONF_SCHED_PIPELINED */
+static const uint32_t budget_srq = (uint32_t)
+  ((uint64_t)LWB_CONF_T_GAP * MCLK_SPEED / RTIMER_SECOND_HF);
+/*---------------------------------------------------------------------------*/
+PROCESS(sched_bench_process, "Scheduler Benchmark");
+AUTOSTART_PROCESSES(&sched_bench_process);
+/*---------------------------------------------------------------------------*/
+static inline uint64_t
+get_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  /* no cycle counter: use nanoseconds */
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+static double
+calibrate(void)
+{
+  struct timespec t0, t1;
+  uint64_t c0, c1;
+  double elapsed_us;
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  c0 = get_cycles();
+  do {
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    elapsed_us = (t1.tv_sec - t0.tv_sec) * 1e6 + 
+                 (t1.tv_nsec - t0.tv_nsec) / 1e3;
+  } while(elapsed_us < 50000);
+  c1 = get_cycles();
+  return (c1 - c0) / elapsed_us;
+}
+/*---------------------------------------------------------------------------*/
+static int
+cmp_u32(const void* a, const void* b)
+{
+  uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+  return (x > y) - (x < y);
+}
+/*---------------------------------------------------------------------------*/
+static percentiles_t
+get_percentiles(uint32_t* samples, uint32_t n)
+{
+  percentiles_t p = { 0 };
+  if(n) {
+    qsort(samples, n, sizeof(uint32_t), cmp_u32);
+    p.p50 = samples[n * 50 / 100];
+    p.p90 = samples[n * 90 / 100];
+    p.p99 = samples[n * 99 / 100];
+    p.max = samples[n - 1];
+  }
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+/* keeps the shortest execution time of a sample over all runs, i.e. without
+ * the interruptions by the host OS (the first run sets the initial value) */
+static inline void
+set_sample(uint32_t* sample, uint64_t t, uint8_t run)
+{
+  if(!run || t < *sample) {
+    *sample = (uint32_t)t;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static inline uint32_t
+msp430_cycles(uint32_t host_cycles)
+{
+  return host_cycles * SCHED_BENCH_CONF_MSP430_FACTOR;
+}
+/*---------------------------------------------------------------------------*/
+/* the estimate is only an approximation of the execution time on the MSP430:
+ * fails if it exceeds the budget by more than SCHED_BENCH_CONF_MARGIN 
+ * percent, warns if it exceeds the budget */
+static uint8_t
+check_budget(const char* what, uint32_t estimate, uint32_t budget)
+{
+  if(estimate > budget + budget / 100 * SCHED_BENCH_CONF_MARGIN) {
+    printf("ERROR: %s exceeds the budget of %lu cycles by more than %u%%\r\n",
+           what, budget, SCHED_BENCH_CONF_MARGIN);
+    return 0;
+  }
+  if(estimate > budget) {
+    printf("WARNING: %s exceeds the budget of %lu cycles\r\n", what, budget);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+get_ipi(ipi_mode_t mode)
+{
+  if(mode == IPI_DIVERSE) {
+    return 2 + random_rand() % 60;
+  } else if(mode == IPI_SATURATED) {
+    return 1;
+  }
+  return LWB_CONF_SCHED_PERIOD_IDLE;
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+send_request(const workload_t* w, uint16_t idx, uint16_t ipi)
+{
+  lwb_stream_req_t req;
+  uint64_t t;
+
+  memset(&req, 0, sizeof(req));
+  req.id = FIRST_NODE_ID + idx / w->streams_per_node;
+  req.stream_id = 1 + idx % w->streams_per_node;
+  req.ipi = ipi;
+#ifdef LWB_SCHED_EDF
+  /* every 4th stream must deliver its packets within one IPI */
+  if((idx & 3) == 0) {
+    LWB_STREAM_REQ_SET_DEADLINE(&req, ipi);
+  }
+#endif /* LWB_SCHED_EDF */
+  t = get_cycles();
+  lwb_sched_proc_srq(&req);
+  return (uint32_t)(get_cycles() - t);
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+run_workload(const workload_t* w)
+{
+  uint16_t r, i, n_srq, n_joined, n_slots, n_acked;
+  uint8_t run, success = 1;
+  percentiles_t p_compute, p_srq;
+  uint32_t sched_len, sched_len_raw;
+  unsigned short seed = random_rand();
+#if LWB_CONF_SCHED_PIPELINED
+  uint32_t n_proc_slot;
+  percentiles_t p_slot;
+#endif /* LWB_CONF_SCHED_PIPELINED */
+
+  /* all runs make the same decisions, only the execution times differ */
+  for(run = 0; run < SCHED_BENCH_CONF_RUNS; run++) {
+    random_init(seed);
+    n_srq = n_joined = n_acked = 0;
+    sched_len = sched_len_raw = 0;
+#if LWB_CONF_SCHED_PIPELINED
+    n_proc_slot = 0;
+#endif /* LWB_CONF_SCHED_PIPELINED */
+    memset(&sched, 0, sizeof(sched));
+    memset(joined, 0, sizeof(joined));
+    memset(next_stream, 0, sizeof(next_stream));
+#if LWB_CONF_SCHED_USE_XMEM
+    xmem_emu_free_all();
+#endif /* LWB_CONF_SCHED_USE_XMEM */
+    lwb_sched_init(&sched);
+#if LWB_CONF_SCHED_USE_XMEM
+    xmem_emu_reset_stats();
+#endif /* LWB_CONF_SCHED_USE_XMEM */
+
+    for(r = 0; r < SCHED_BENCH_CONF_ROUNDS; r++) {
+      uint64_t t;
+      uint8_t n_req = 0;
+
+      /* data slots of the last round: all packets received except for the
+       * lost ones */
+      n_slots = LWB_SCHED_N_SLOTS(&sched);
+#if LWB_CONF_SCHED_COMPRESS
+      lwb_sched_uncompress(&sched);
+#endif /* LWB_CONF_SCHED_COMPRESS */
+      for(i = 0; i < n_slots; i++) {
+        uint16_t node = sched.slot[i] - FIRST_NODE_ID;
+        streams_to_update[i] = LWB_INVALID_STREAM_ID;
+        if(sched.slot[i] >= FIRST_NODE_ID && 
+           (random_rand() % 100) >= w->loss) {
+          streams_to_update[i] = 1 + next_stream[node];
+          next_stream[node] = (next_stream[node] + 1) % w->streams_per_node;
+        }
+#if LWB_CONF_SCHED_PIPELINED
+        t = get_cycles();
+        lwb_sched_proc_slot(&sched, streams_to_update, i);
+        set_sample(&t_slot[n_proc_slot++], get_cycles() - t, run);
+#endif /* LWB_CONF_SCHED_PIPELINED */
+      }
+      /* 4 bytes per acknowledged stream request */
+      n_acked += lwb_sched_prepare_sack(sack_buffer) / 4;
+
+      /* stream requests (contention slot and piggybacked requests) */
+      for(i = 0; i < w->n_streams && n_req < MAX_REQ_PER_ROUND; i++) {
+        if(!joined[i]) {
+          set_sample(&t_srq[n_srq++], 
+                     send_request(w, i, get_ipi(w->ipi_mode)), run);
+          joined[i] = 1;
+          n_joined++;
+          n_req++;
+        }
+      }
+      if(n_joined == w->n_streams && (random_rand() % 100) < w->churn) {
+        i = random_rand() % w->n_streams;
+        if(random_rand() & 1) {
+          /* IPI update */
+          set_sample(&t_srq[n_srq++], 
+                     send_request(w, i, get_ipi(w->ipi_mode)), run);
+        } else {
+          /* removal, the stream joins again in the next round */
+          set_sample(&t_srq[n_srq++], send_request(w, i, 0), run);
+          joined[i] = 0;
+          n_joined--;
+        }
+      }
+
+      t = get_cycles();
+      sched_len += lwb_sched_compute(&sched, streams_to_update, 0);
+      set_sample(&t_compute[r], get_cycles() - t, run);
+      sched_len_raw += LWB_SCHED_PKT_HEADER_LEN + LWB_SCHED_N_SLOTS(&sched) * 2;
+    }
+  }
+
+  p_compute = get_percentiles(t_compute, SCHED_BENCH_CONF_ROUNDS);
+  p_srq = get_percentiles(t_srq, n_srq);
+  printf("%-10s %7u %9u %9u %9u %9u %8.2f %11u %9u %9u %11u\r\n", 
+         w->name, w->n_streams, 
+         p_compute.p50, p_compute.p90, p_compute.p99, p_compute.max,
+         p_compute.p99 / cycles_per_us, msp430_cycles(p_compute.p99), 
+         p_srq.p50, p_srq.p99, msp430_cycles(p_srq.p99));
+  printf("%-10s %7s schedule: avg %.1f bytes (uncompressed %.1f bytes)\r\n",
+         "", "", (double)sched_len / SCHED_BENCH_CONF_ROUNDS,
+         (double)sched_len_raw / SCHED_BENCH_CONF_ROUNDS);
+#if LWB_CONF_SCHED_PIPELINED
+  p_slot = get_percentiles(t_slot, n_proc_slot);
+  printf("%-10s %7s per slot: p50 %u, p99 %u, max %u (msp430_p99 %u)\r\n",
+         "", "", p_slot.p50, p_slot.p99, p_slot.max, 
+         msp430_cycles(p_slot.p99));
+#endif /* LWB_CONF_SCHED_PIPELINED */
+#if LWB_CONF_SCHED_USE_XMEM
+  const xmem_emu_stats_t* xs = xmem_emu_get_stats();
+  printf("%-10s %7s xmem per round: %.1f reads, %.1f writes, %.0f bytes\r\n",
+         "", "", (double)xs->n_read / SCHED_BENCH_CONF_ROUNDS, 
+         (double)xs->n_write / SCHED_BENCH_CONF_ROUNDS,
+         (double)xs->n_bytes / SCHED_BENCH_CONF_ROUNDS);
+#endif /* LWB_CONF_SCHED_USE_XMEM */
+
+  if(!w->loss && !w->churn && w->ipi_mode != IPI_SATURATED &&
+     w->n_streams < LWB_CONF_MAX_DATA_SLOTS &&
+     lwb_sched_get_n_streams() != n_acked) {
+    /* all streams fit into one round and no packet was lost: none of the
+     * accepted streams may be removed */
+    printf("ERROR: %u of %u streams removed without packet loss\r\n",
+           n_acked - lwb_sched_get_n_streams(), n_acked);
+    return 0;
+  }
+  success &= check_budget("schedule computation", 
+                          msp430_cycles(p_compute.p99), budget_compute);
+#if LWB_CONF_SCHED_PIPELINED
+  success &= check_budget("slot processing", 
+                          msp430_cycles(p_slot.p99), budget_srq);
+#endif /* LWB_CONF_SCHED_PIPELINED */
+  success &= check_budget("stream request processing", 
+                          msp430_cycles(p_srq.p99), budget_srq);
+  return success;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(sched_bench_process, ev, data) 
+{
+  uint8_t i, j, success = 1;
+
+  PROCESS_BEGIN();
+
+  cycles_per_us = calibrate();
+  printf("# scheduler: %s, data slots: %u, max. streams: %u, "
+         "rounds: %u, %.0f host cycles/us, MSP430 factor: %u\r\n",
+         SCHED_BENCH_NAME, LWB_CONF_MAX_DATA_SLOTS, LWB_CONF_MAX_N_STREAMS,
+         SCHED_BENCH_CONF_ROUNDS, cycles_per_us, 
+         SCHED_BENCH_CONF_MSP430_FACTOR);
+  printf("# MSP430 budget: %lu cycles (computation), %lu cycles (request)\r\n",
+         budget_compute, budget_srq);
+  printf("# %-8s %7s %9s %9s %9s %9s %8s %11s %9s %9s %11s\r\n",
+         "workload", "streams", "comp_p50", "comp_p90", "comp_p99", 
+         "comp_max", "p99[us]", "msp430_p99", "srq_p50", "srq_p99",
+         "msp430_p99");
+  for(i = 0; i < sizeof(workloads) / sizeof(workload_t); i++) {
+    for(j = 0; j < sizeof(n_streams) / sizeof(uint16_t); j++) {
+      workload_t w = workloads[i];
+      if((j && n_streams[j] <= n_streams[j - 1]) || 
+         n_streams[j] > LWB_CONF_MAX_N_STREAMS) {
+        continue;
+      }
+      w.n_streams = n_streams[j];
+      success &= run_workload(&w);
+    }
+  }
+  exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
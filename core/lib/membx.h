@@ -47,6 +47,7 @@
 #ifndef __MEMBX_H__
 #define __MEMBX_H__
 
+#include <stdint.h>
 #include <string.h>
 
 #define MEMBX_INVALID_ADDR      0xffffffff
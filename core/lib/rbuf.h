@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @addtogroup  lib
+ * @{
+ *
+ * @defgroup    rbuf Ring buffer with variable-size records
+ * @{
+ * 
+ * @file
+ *
+ * @brief Ring buffer that stores variable-size records in a linear data
+ * array. A record never wraps around the end of the array, i.e. each record
+ * occupies a contiguous memory block (the unused space at the end of the
+ * array is skipped if necessary).
+ * Like fifo.h, this lib provides address management only, no actual memory
+ * allocation. Therefore, it is suitable for any type of memory (RAM, Flash or 
+ * external memory). The record length is not stored by this lib, the user
+ * has to pass it to rbuf_drop() (e.g. store it in the first byte of each 
+ * record).
+ */
+
+#ifndef __RBUF_H__
+#define __RBUF_H__
+
+#include <stdint.h>
+
+#define RBUF_ERROR      0xffffffff
+
+/**
+ * @brief declare a ring buffer
+ * @param size size of the memory block in bytes (max. 65535)
+ * @note It is the users responsibility to allocate a memory block of the
+ * size 'size' starting at the address passed to rbuf_init(). The ring buffer
+ * itself uses 18 bytes.
+ */
+#define RBUF(name, size) \
+  static struct rbuf name = { 0, size, 0, 0, size, 0, 0, size }
+
+struct rbuf {
+  uint32_t start;     /* start address of the memory block */
+  uint16_t size;      /* size of the memory block in bytes */
+  uint16_t read;      /* offset of the next record to read */
+  uint16_t write;     /* offset of the next free byte */
+  uint16_t end;       /* end of the valid data at the end of the memory block
+                         (smaller than size if the unused space at the end
+                         was skipped) */
+  uint16_t count;     /* number of records */
+  uint16_t prev_read; /* read offset and end before the last rbuf_drop() */
+  uint16_t prev_end;
+};
+
+#define RBUF_RESET(rb)      ((rb)->read = (rb)->write = (rb)->count = 0, \
+                             (rb)->end = (rb)->size)
+#define RBUF_CNT(rb)        ((rb)->count)
+#define RBUF_EMPTY(rb)      ((rb)->count == 0)
+#define RBUF_READ_ADDR(rb)  ((rb)->start + (rb)->read)
+
+static inline void
+rbuf_init(struct rbuf * const rb, uint32_t start_addr)
+{
+  rb->start = start_addr;
+  RBUF_RESET(rb);
+  rb->prev_read = 0;
+  rb->prev_end = rb->size;
+}
+
+/**
+ * @brief delivers the address of the next record to read without removing
+ * it from the ring buffer
+ * @return the address of the next record or RBUF_ERROR if the ring buffer
+ * is empty
+ */
+static inline uint32_t
+rbuf_peek(struct rbuf * const rb)
+{
+  if(RBUF_EMPTY(rb)) { return RBUF_ERROR; }
+  return RBUF_READ_ADDR(rb);
+}
+
+/**
+ * @brief delivers the address of the record that follows the record at addr
+ * @param len the length of the record at addr in bytes
+ * @note the result is only valid if there is such a record (see RBUF_CNT)
+ */
+static inline uint32_t
+rbuf_next(struct rbuf * const rb, uint32_t addr, uint16_t len)
+{
+  uint32_t ofs = addr - rb->start + len;
+  /* the records behind the read offset end at rb->end */
+  return rb->start + ((ofs >= rb->end) ? 0 : ofs);
+}
+
+/**
+ * @brief get the address at which a record of len bytes would be stored
+ * (the record is not inserted, see rbuf_commit())
+ * @return the address of the record or RBUF_ERROR if there is not enough
+ * contiguous space left
+ */
+static inline uint32_t
+rbuf_reserve(struct rbuf * const rb, uint16_t len) 
+{
+  if(RBUF_EMPTY(rb)) {
+    /* start over at the beginning of the memory block */
+    return (len <= rb->size) ? rb->start : RBUF_ERROR;
+  }
+  if(rb->write > rb->read) {
+    if(len <= rb->size - rb->write) {
+      return rb->start + rb->write;
+    }
+    if(len <= rb->read) {
+      /* skip the unused space at the end */
+      return rb->start;
+    }
+  } else if(len <= rb->read - rb->write) {
+    return rb->start + rb->write;
+  }
+  return RBUF_ERROR;
+}
+
+/**
+ * @brief inserts a record of len bytes at the address addr
+ * @param addr the address returned by rbuf_reserve() (called with a length
+ * of at least len bytes)
+ */
+static inline void
+rbuf_commit(struct rbuf * const rb, uint32_t addr, uint16_t len) 
+{
+  if(RBUF_EMPTY(rb)) {
+    RBUF_RESET(rb);
+  }
+  if(addr != rb->start + rb->write) {
+    /* the record is stored at the beginning of the memory block */
+    rb->end = rb->write;
+    rb->write = 0;
+  }
+  rb->write += len;
+  rb->count++;
+}
+
+/**
+ * @brief allocates a record of len bytes
+ * @return the address of the record or RBUF_ERROR if the ring buffer is full
+ */
+static inline uint32_t
+rbuf_put(struct rbuf * const rb, uint16_t len) 
+{
+  uint32_t addr = rbuf_reserve(rb, len);
+  if(RBUF_ERROR != addr) {
+    rbuf_commit(rb, addr, len);
+  }
+  return addr;
+}
+
+/**
+ * @brief removes the next record to read
+ * @param len the length of this record in bytes
+ */
+static inline void
+rbuf_drop(struct rbuf * const rb, uint16_t len) 
+{
+  if(RBUF_EMPTY(rb)) { return; }
+  rb->prev_read = rb->read;
+  rb->prev_end = rb->end;
+  rb->read += len;
+  rb->count--;
+  if(rb->read >= rb->end) {
+    /* continue at the beginning of the memory block */
+    rb->read = 0;
+    rb->end = rb->size;
+  }
+}
+
+/**
+ * @brief restores the record removed by the last call of rbuf_drop()
+ * @note must be called before any other record is inserted
+ */
+static inline void
+rbuf_restore(struct rbuf * const rb) 
+{
+  rb->read = rb->prev_read;
+  rb->end = rb->prev_end;
+  rb->count++;
+}
+
+#endif /* __RBUF_H__ */
+
+/**
+ * @}
+ * @}
+ */
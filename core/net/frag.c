@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "lwb.h"
+
+#if LWB_CONF_FRAG
+
+#if LWB_VERSION != 1
+#error "LWB_CONF_FRAG requires LWB_VERSION 1"
+#endif
+#if LWB_FRAG_MAX_N_FRAGS > 32
+#error "LWB_CONF_FRAG_MAX_MSG_LEN too big (max. 32 fragments)"
+#endif
+#if LWB_CONF_FRAG_MAX_MSG_LEN < LWB_CONF_MAX_DATA_PKT_LEN
+#error "LWB_CONF_FRAG_MAX_MSG_LEN must be >= LWB_CONF_MAX_DATA_PKT_LEN"
+#endif
+
+/* an unused reassembly buffer has no fragments */
+#define FRAG_BUF_UNUSED(b)      ((b)->rcvd == 0)
+#define FRAG_ALL_RCVD(n)        (((n) == 32) ? 0xffffffff : \
+                                 (((uint32_t)1 << (n)) - 1))
+#define FRAG_MEM_INVALID        0xffffffff
+/*---------------------------------------------------------------------------*/
+typedef struct {
+  uint32_t rcvd;        /* bit i is set if fragment i has been received */
+  uint32_t t_last;      /* global time of the last received fragment */
+  uint16_t sender;
+  uint16_t len;         /* message length, known once the last fragment is in */
+  uint8_t  stream_id;
+  uint8_t  seq;
+  uint8_t  n_frags;     /* number of fragments (0 = last fragment missing) */
+} frag_buf_t;
+/*---------------------------------------------------------------------------*/
+static frag_buf_t frag_buf[LWB_CONF_FRAG_N_BUFFERS];
+static uint8_t    frag_seq = 0;                /* sequence no. of the sender */
+#if !LWB_CONF_USE_XMEM
+static uint8_t    frag_mem[LWB_CONF_FRAG_N_BUFFERS * LWB_CONF_FRAG_MAX_MSG_LEN];
+#define FRAG_MEM_WRITE(addr, len, src)   memcpy(frag_mem + (addr), src, len)
+#define FRAG_MEM_READ(addr, len, dest)   memcpy(dest, frag_mem + (addr), len)
+#else /* LWB_CONF_USE_XMEM */
+/* the reassembly buffers are allocated in the ext. memory on first use */
+static uint32_t   frag_mem_addr = FRAG_MEM_INVALID;
+#define FRAG_MEM_WRITE(addr, len, src)   xmem_write(frag_mem_addr + (addr), \
+                                                    len, src)
+#define FRAG_MEM_READ(addr, len, dest)   xmem_read(frag_mem_addr + (addr), \
+                                                   len, dest)
+#endif /* LWB_CONF_USE_XMEM */
+/*---------------------------------------------------------------------------*/
+uint8_t
+lwb_send_msg(uint16_t recipient,
+             uint8_t stream_id, 
+             const uint8_t * const data, 
+             uint16_t len)
+{
+  uint8_t pkt[LWB_FRAG_HEADER_LEN + LWB_FRAG_PAYLOAD_LEN];
+  uint8_t idx = 0;
+  uint16_t ofs = 0;
+  
+  if(!data || !len || len > LWB_CONF_FRAG_MAX_MSG_LEN) {
+    DEBUG_PRINT_ERROR("invalid message length");
+    return 0;
+  }
+  if(len <= LWB_CONF_MAX_DATA_PKT_LEN - LWB_CONF_HEADER_LEN - 
+            LWB_DATA_PKT_TRAILER_LEN) {
+    /* fits into one data packet, no fragmentation required */
+    return lwb_send_pkt(recipient, stream_id, data, len);
+  }
+#if LWB_CONF_SCHED_VAR_SLOTS
+  /* the fragments are sent in the data slots of the stream */
+  uint8_t max_len = lwb_stream_get_max_len(stream_id);
+  if(max_len && max_len < LWB_FRAG_HEADER_LEN + LWB_FRAG_PAYLOAD_LEN) {
+    DEBUG_PRINT_ERROR("max. length of stream %u too short for fragments",
+                      stream_id);
+    return 0;
+  }
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+  /* the fragments are sent in the priority class of the stream */
+  uint8_t prio = lwb_stream_get_prio(stream_id);
+  /* queue either all fragments or none (the last one may be shorter) */
+  if(!lwb_send_buffer_fits(prio, (len + LWB_FRAG_PAYLOAD_LEN - 1) / 
+                                 LWB_FRAG_PAYLOAD_LEN,
+                           LWB_FRAG_HEADER_LEN + LWB_FRAG_PAYLOAD_LEN)) {
+    DEBUG_PRINT_VERBOSE("out queue full, message of stream %u not sent", 
+                        stream_id);
+    return 0;
+  }
+  frag_seq++;
+  pkt[0] = stream_id;
+  pkt[1] = frag_seq;
+  while(ofs < len) {
+    uint8_t frag_len = LWB_FRAG_PAYLOAD_LEN;
+    pkt[2] = idx;
+    if(len - ofs <= LWB_FRAG_PAYLOAD_LEN) {
+      frag_len = len - ofs;
+      pkt[2] |= LWB_FRAG_LAST;
+    }
+    memcpy(pkt + LWB_FRAG_HEADER_LEN, data + ofs, frag_len);
+    if(!lwb_send_pkt_prio(recipient, LWB_FRAG_STREAM_ID, pkt, 
+                          frag_len + LWB_FRAG_HEADER_LEN, prio)) {
+      /* the receiver drops the incomplete message after the timeout */
+      DEBUG_PRINT_WARNING("message %u of stream %u truncated", 
+                          frag_seq, stream_id);
+      return 0;
+    }
+    ofs += frag_len;
+    idx++;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* returns the reassembly buffer for a fragment of message seq of stream 
+ * stream_id from node sender */
+static frag_buf_t*
+frag_get_buf(uint16_t sender, uint8_t stream_id, uint8_t seq)
+{
+  frag_buf_t* buf = 0;
+  uint8_t i;
+  for(i = 0; i < LWB_CONF_FRAG_N_BUFFERS; i++) {
+    if(!FRAG_BUF_UNUSED(&frag_buf[i]) && frag_buf[i].sender == sender &&
+       frag_buf[i].stream_id == stream_id) {
+      if(frag_buf[i].seq != seq) {
+        /* a new message of the same stream, the old one is incomplete */
+        DEBUG_PRINT_VERBOSE("incomplete message from node %u dropped", 
+                            sender);
+        frag_buf[i].rcvd = 0;
+      }
+      buf = &frag_buf[i];
+      break;
+    }
+  }
+  if(!buf) {
+    /* take a free buffer or the one that was updated least recently */
+    buf = &frag_buf[0];
+    for(i = 0; i < LWB_CONF_FRAG_N_BUFFERS; i++) {
+      if(FRAG_BUF_UNUSED(&frag_buf[i])) {
+        buf = &frag_buf[i];
+        break;
+      }
+      if(frag_buf[i].t_last < buf->t_last) {
+        buf = &frag_buf[i];
+      }
+    }
+    if(!FRAG_BUF_UNUSED(buf)) {
+      DEBUG_PRINT_WARNING("no free reassembly buffer, message of node %u "
+                          "dropped", buf->sender);
+      buf->rcvd = 0;
+    }
+  }
+  if(FRAG_BUF_UNUSED(buf)) {
+    buf->sender    = sender;
+    buf->stream_id = stream_id;
+    buf->seq       = seq;
+    buf->n_frags   = 0;
+    buf->len       = 0;
+  }
+  return buf;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+lwb_rcv_msg(uint8_t* out_data,
+            uint16_t * const out_node_id, 
+            uint8_t * const out_stream_id)
+{
+  const uint8_t* pkt;
+  uint8_t  pkt_len;
+  uint16_t sender;
+  uint8_t  stream_id;
+  uint32_t now = lwb_get_time(0);
+  uint8_t  i;
+  
+  if(!out_data) { return 0; }
+#if LWB_CONF_USE_XMEM
+  if(FRAG_MEM_INVALID == frag_mem_addr) {
+    frag_mem_addr = xmem_alloc(LWB_CONF_FRAG_N_BUFFERS * 
+                               LWB_CONF_FRAG_MAX_MSG_LEN);
+    if(FRAG_MEM_INVALID == frag_mem_addr) {
+      DEBUG_PRINT_ERROR("failed to allocate the reassembly buffers");
+      return 0;
+    }
+  }
+#endif /* LWB_CONF_USE_XMEM */
+  /* drop the messages that have timed out */
+  for(i = 0; i < LWB_CONF_FRAG_N_BUFFERS; i++) {
+    if(!FRAG_BUF_UNUSED(&frag_buf[i]) && 
+       (now - frag_buf[i].t_last) > LWB_CONF_FRAG_TIMEOUT) {
+      DEBUG_PRINT_VERBOSE("message from node %u timed out", 
+                          frag_buf[i].sender);
+      frag_buf[i].rcvd = 0;
+    }
+  }
+  
+  while((pkt = lwb_rcv_pkt_peek(&pkt_len, &sender, &stream_id))) {
+    if(LWB_FRAG_STREAM_ID != stream_id) {
+      /* a regular message, pass it on as is */
+      memcpy(out_data, pkt, pkt_len);
+      lwb_rcv_pkt_consume();
+      if(out_node_id) {
+        *out_node_id = sender;
+      }
+      if(out_stream_id) {
+        *out_stream_id = stream_id;
+      }
+      return pkt_len;
+    }
+    uint8_t  idx      = pkt[2] & ~LWB_FRAG_LAST;
+    uint8_t  frag_len = pkt_len - LWB_FRAG_HEADER_LEN;
+    uint16_t ofs      = (uint16_t)idx * LWB_FRAG_PAYLOAD_LEN;
+    if(pkt_len <= LWB_FRAG_HEADER_LEN || idx >= LWB_FRAG_MAX_N_FRAGS ||
+       ofs + frag_len > LWB_CONF_FRAG_MAX_MSG_LEN ||
+       (!(pkt[2] & LWB_FRAG_LAST) && frag_len != LWB_FRAG_PAYLOAD_LEN)) {
+      DEBUG_PRINT_WARNING("invalid fragment from node %u", sender);
+      lwb_rcv_pkt_consume();
+      continue;
+    }
+    frag_buf_t* buf = frag_get_buf(sender, pkt[0], pkt[1]);
+    FRAG_MEM_WRITE((uint16_t)(buf - frag_buf) * LWB_CONF_FRAG_MAX_MSG_LEN + 
+                   ofs, frag_len, pkt + LWB_FRAG_HEADER_LEN);
+    buf->rcvd  |= (uint32_t)1 << idx;
+    buf->t_last = now;
+    if(pkt[2] & LWB_FRAG_LAST) {
+      buf->n_frags = idx + 1;
+      buf->len     = ofs + frag_len;
+    }
+    lwb_rcv_pkt_consume();
+    
+    if(buf->n_frags && buf->rcvd == FRAG_ALL_RCVD(buf->n_frags)) {
+      /* message complete */
+      FRAG_MEM_READ((uint16_t)(buf - frag_buf) * LWB_CONF_FRAG_MAX_MSG_LEN,
+                    buf->len, out_data);
+      buf->rcvd = 0;
+      if(out_node_id) {
+        *out_node_id = buf->sender;
+      }
+      if(out_stream_id) {
+        *out_stream_id = buf->stream_id;
+      }
+      return buf->len;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* LWB_CONF_FRAG */
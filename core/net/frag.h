@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @addtogroup  lwb
+ * @{
+ *
+ * @defgroup    frag Message fragmentation
+ * @{
+ *
+ * @file 
+ * 
+ * @brief   fragmentation and reassembly of messages that are longer than one 
+ * data packet
+ * 
+ * A message is split into fragments of LWB_FRAG_PAYLOAD_LEN bytes which are 
+ * sent as regular data packets with the stream ID LWB_FRAG_STREAM_ID; each 
+ * fragment starts with a fragment header (stream ID of the message, message
+ * sequence number and fragment index, the MSB marks the last fragment). The 
+ * receiver reassembles the messages in LWB_CONF_FRAG_N_BUFFERS buffers (in the
+ * external memory if LWB_CONF_USE_XMEM is enabled) and drops incomplete
+ * messages after LWB_CONF_FRAG_TIMEOUT seconds. Use a burst stream (see 
+ * LWB_CONF_SCHED_BURST) to send all fragments of a message in one round.
+ */
+
+#ifndef __FRAG_H__
+#define __FRAG_H__
+
+#include "lwb.h"
+
+#define LWB_FRAG_HEADER_LEN             3
+/* payload of a fragment (all fragments except for the last one are full) */
+#define LWB_FRAG_PAYLOAD_LEN            (LWB_CONF_MAX_DATA_PKT_LEN - \
+                                         LWB_CONF_HEADER_LEN - \
+                                         LWB_DATA_PKT_TRAILER_LEN - \
+                                         LWB_FRAG_HEADER_LEN)
+#define LWB_FRAG_MAX_N_FRAGS            ((LWB_CONF_FRAG_MAX_MSG_LEN + \
+                                          LWB_FRAG_PAYLOAD_LEN - 1) / \
+                                         LWB_FRAG_PAYLOAD_LEN)
+#define LWB_FRAG_LAST                   0x80  /* marks the last fragment */
+
+/**
+ * @brief schedule a message for transmission over the LWB, the message is 
+ * split into fragments if it does not fit into one data packet
+ * @param len the length of the message (max. LWB_CONF_FRAG_MAX_MSG_LEN)
+ * @return 1 if successful, 0 otherwise (e.g. queue full)
+ * @note the fragments are sent in the priority class of the stream; the 
+ * message is only queued if there is enough space for all its fragments
+ */
+uint8_t lwb_send_msg(uint16_t recipient,
+                     uint8_t stream_id, 
+                     const uint8_t * const data, 
+                     uint16_t len);
+
+/** 
+ * @brief get the next complete message (reassembled or received in one data
+ * packet) and remove it from the incoming queue
+ * @param out_data a buffer of at least LWB_CONF_FRAG_MAX_MSG_LEN bytes
+ * @param out_node_id the ID of the node that sent the message (optional 
+ * parameter, pass 0 if not interested in this data)
+ * @param out_stream_id the stream ID (optional parameter)
+ * @return the length of the message in bytes or 0 if no complete message is
+ * available
+ * @note the fragments are processed when this function is called, i.e. it
+ * should be called after each round (see lwb_start)
+ */
+uint16_t lwb_rcv_msg(uint8_t* out_data,
+                     uint16_t * const out_node_id, 
+                     uint8_t * const out_stream_id);
+
+
+#endif /* __FRAG_H__ */
+
+/**
+ * @}
+ * @}
+ */
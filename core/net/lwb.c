@@ -40,13 +40,17 @@
  
 #include "contiki.h"
 
-#if LWB_VERSION == 1
+#if LWB_VERSION == 1 || LWB_VERSION == 2
 /*---------------------------------------------------------------------------*/
-#if LWB_CONF_HEADER_LEN != 3
+#if LWB_VERSION == 1 && LWB_CONF_HEADER_LEN != 3
 #error "LWB_CONF_HEADER_LEN must be 3!"
 #endif
+#if LWB_VERSION == 2 && LWB_CONF_HEADER_LEN != 1
+#error "LWB_CONF_HEADER_LEN must be 1 for LWB_VERSION 2!"
+#endif
 #define LWB_DATA_PKT_PAYLOAD_LEN    (LWB_CONF_MAX_DATA_PKT_LEN - \
-                                     LWB_CONF_HEADER_LEN)
+                                     LWB_CONF_HEADER_LEN - \
+                                     LWB_DATA_PKT_TRAILER_LEN)
 #define STREAM_REQ_PKT_SIZE         5
 
 /* indicates when this node is about to send a request */
@@ -95,7 +99,9 @@ typedef enum {
 } sync_event_t; 
 /*---------------------------------------------------------------------------*/
 typedef struct {
+#if LWB_VERSION == 1
   uint16_t recipient;     /* target node ID */
+#endif /* LWB_VERSION */
   uint8_t  stream_id;     /* message type and connection ID (used as stream ID
                              in LWB); first bit is msg type */
   uint8_t  payload[LWB_DATA_PKT_PAYLOAD_LEN];       
@@ -153,9 +159,95 @@ static const uint32_t guard_time[NUM_OF_SYNC_STATES] = {
   #define LWB_TASK_SUSPENDED  
 #endif
 /*---------------------------------------------------------------------------*/
-#define LWB_T_SLOT_START(i)       ((LWB_CONF_T_SCHED + LWB_CONF_T_GAP) + \
-                                   (LWB_CONF_T_DATA + LWB_CONF_T_GAP) * i)
+#if LWB_CONF_SCHED_VAR_SLOTS
+/* length of data slot i of schedule s */
+#define LWB_T_DATA(s, i)          (t_data_class[LWB_SCHED_GET_SLOT_LEN(s, i)])
+#else /* LWB_CONF_SCHED_VAR_SLOTS */
+#define LWB_T_DATA(s, i)          LWB_CONF_T_DATA
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+#if LWB_CONF_SCHED_VAR_SLOTS
+/* max. packet length that fits into data slot i of schedule s */
+#define LWB_SLOT_PKT_LEN(s, i)    LWB_SLOT_CLASS_PKT_LEN( \
+                                    LWB_SCHED_GET_SLOT_LEN(s, i))
+#else /* LWB_CONF_SCHED_VAR_SLOTS */
+#define LWB_SLOT_PKT_LEN(s, i)    LWB_CONF_MAX_DATA_PKT_LEN
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+/* offset of the first slot after the schedule */
+#define LWB_T_SLOT_FIRST          (LWB_CONF_T_SCHED + LWB_CONF_T_GAP)
+#if LWB_CONF_SCHED_PIPELINED
+/* the 2nd schedule follows right after the last slot of schedule s */
+#define LWB_T_SCHED2_START(s)     (LWB_T_SLOT_FIRST + \
+                                   (LWB_SCHED_HAS_DACK_SLOT(s) ? \
+                                    (LWB_CONF_T_DACK + LWB_CONF_T_GAP) : 0) + \
+                                   (LWB_SCHED_HAS_SACK_SLOT(s) ? \
+                                    (LWB_CONF_T_DATA + LWB_CONF_T_GAP) : 0) + \
+                                   lwb_get_t_data_slots(s) + \
+                                   (LWB_SCHED_HAS_CONT_SLOT(s) ? \
+                                    (LWB_CONF_T_CONT + LWB_CONF_T_GAP) : 0) + \
+                                   LWB_CONF_T_SCHED2_GAP)
+#else /* LWB_CONF_SCHED_PIPELINED */
+#define LWB_T_SCHED2_START(s)     LWB_CONF_T_SCHED2_START
+#endif /* LWB_CONF_SCHED_PIPELINED */
 #define LWB_DATA_RCVD             (glossy_get_n_rx() > 0)
+/* no zero-copy reception with the external memory */
+#define LWB_RX_ZERO_COPY          (LWB_CONF_RX_ZERO_COPY && \
+                                   !LWB_CONF_USE_XMEM && !LWB_CONF_RELAY_ONLY)
+/* the standby host mirrors the streams of the host (not on relay nodes) */
+#define LWB_STANDBY_HOST          (LWB_CONF_STANDBY_HOST_ID && \
+                                   !LWB_CONF_RELAY_ONLY)
+#if LWB_CONF_STANDBY_HOST_ID && (LWB_CONF_STANDBY_HOST_ID == HOST_ID)
+#error "LWB_CONF_STANDBY_HOST_ID must not be the HOST_ID"
+#endif
+#if LWB_CONF_STANDBY_HOST_ID && (LWB_VERSION == 2)
+/* the sources tell the broadcasts of the host apart by the sender ID, they
+ * would drop the packets of a standby host that has taken over */
+#error "LWB_CONF_STANDBY_HOST_ID is not supported with LWB_VERSION 2"
+#endif
+/* header fields of the data packet p sent by node 'sender' (byte-wise 
+ * access, p may be unaligned); in the incoming queue, the recipient is 
+ * replaced by the sender */
+#if LWB_VERSION == 2
+/* the header only holds the stream ID, the recipient is implied */
+#define LWB_PKT_RECIPIENT(p, sender) (((sender) == HOST_ID) ? \
+                                      LWB_RECIPIENT_BROADCAST : \
+                                      LWB_RECIPIENT_SINK)
+#define LWB_PKT_STREAM_ID(p)      ((p)[0])
+#define LWB_PKT_SET_HEADER(p, recipient, stream_id) \
+{\
+  (p)[0] = (stream_id);\
+}
+#define LWB_PKT_SET_SENDER(p, id) /* the sender is not stored */
+#else /* LWB_VERSION */
+#define LWB_PKT_RECIPIENT(p, sender) ((uint16_t)(p)[1] << 8 | (p)[0])
+#define LWB_PKT_SENDER(p)         LWB_PKT_RECIPIENT(p, 0)
+#define LWB_PKT_STREAM_ID(p)      ((p)[2])
+#define LWB_PKT_SET_HEADER(p, recipient, stream_id) \
+{\
+  (p)[0] = (uint8_t)(recipient);\
+  (p)[1] = (recipient) >> 8;\
+  (p)[2] = (stream_id);\
+}
+#define LWB_PKT_SET_SENDER(p, id) \
+{\
+  (p)[0] = (uint8_t)(id);\
+  (p)[1] = (id) >> 8;\
+}
+#endif /* LWB_VERSION */
+#if LWB_CONF_FRAG
+/* the stream a data packet is accounted to (a fragment carries the stream ID 
+ * of its message in the fragment header, see frag.h) */
+#define LWB_MSG_STREAM_ID(p)      ((LWB_PKT_STREAM_ID(p) == LWB_FRAG_STREAM_ID)\
+                                   ? (p)[LWB_CONF_HEADER_LEN] : \
+                                   LWB_PKT_STREAM_ID(p))
+#else /* LWB_CONF_FRAG */
+#define LWB_MSG_STREAM_ID(p)      LWB_PKT_STREAM_ID(p)
+#endif /* LWB_CONF_FRAG */
+/* a data packet marked with LWB_BULK_STREAM_ID ends with the stream ID and the
+ * backlog of the sender */
+#define LWB_BULK_TRAILER_LEN      2
+#define LWB_IS_BULK_PKT(p, len)   (LWB_PKT_STREAM_ID(p) == LWB_BULK_STREAM_ID \
+                                   && (len) >= LWB_CONF_HEADER_LEN + \
+                                               LWB_BULK_TRAILER_LEN)
 #define RTIMER_CAPTURE            (t_now = rtimer_now_hf())
 #define RTIMER_ELAPSED            ((rtimer_now_hf() - t_now) * 1000 / 3250)    
 #define GET_EVENT                 (glossy_is_t_ref_updated() ? \
@@ -178,21 +270,21 @@ static const uint32_t guard_time[NUM_OF_SYNC_STATES] = {
   LWB_WAIT_UNTIL(rt->time + LWB_CONF_T_SCHED + t_guard);\
   glossy_stop();\
 }   
-#define LWB_SEND_PACKET() \
+#define LWB_SEND_PACKET(t_data) \
 {\
   glossy_start(node_id, (uint8_t*)&glossy_payload, payload_len, \
                LWB_CONF_TX_CNT_DATA, GLOSSY_WITHOUT_SYNC, \
                GLOSSY_WITHOUT_RF_CAL);\
-  LWB_WAIT_UNTIL(rt->time + LWB_CONF_T_DATA);\
+  LWB_WAIT_UNTIL(rt->time + (t_data));\
   glossy_stop();\
 }
-#define LWB_RCV_PACKET() \
+#define LWB_RCV_PACKET(buf, t_data) \
 {\
-  glossy_start(GLOSSY_UNKNOWN_INITIATOR, (uint8_t*)&glossy_payload, \
+  glossy_start(GLOSSY_UNKNOWN_INITIATOR, (buf), \
                GLOSSY_UNKNOWN_PAYLOAD_LEN, \
                LWB_CONF_TX_CNT_DATA, GLOSSY_WITHOUT_SYNC, \
                GLOSSY_WITHOUT_RF_CAL);\
-  LWB_WAIT_UNTIL(rt->time + LWB_CONF_T_DATA + t_guard);\
+  LWB_WAIT_UNTIL(rt->time + (t_data) + t_guard);\
   glossy_stop();\
 }
 #define LWB_SEND_SRQ() \
@@ -254,19 +346,150 @@ static lwb_statistics_t stats = { 0 };
 static uint8_t          urgent_stream_req = 0;
 /* no buffers needed if this is only a relay node */
 #if !LWB_CONF_RELAY_ONLY
+#if LWB_RX_ZERO_COPY
+/* Glossy receives directly into the incoming queue, therefore each element 
+ * must be able to hold any packet (the length is still stored at offset 
+ * LWB_CONF_MAX_DATA_PKT_LEN) */
+#define LWB_IN_BUFFER_ELEM_SIZE   (LWB_CONF_MAX_PKT_LEN + 1)
+#else /* LWB_RX_ZERO_COPY */
+#define LWB_IN_BUFFER_ELEM_SIZE   (LWB_CONF_MAX_DATA_PKT_LEN + 1)
+#endif /* LWB_RX_ZERO_COPY */
+#define LWB_IN_BUFFER_MEM_SIZE    (LWB_CONF_IN_BUFFER_SIZE * \
+                                   LWB_IN_BUFFER_ELEM_SIZE)
+/* one outgoing queue per priority class */
+#define LWB_OUT_QUEUE_MEM_SIZE    (LWB_CONF_OUT_BUFFER_SIZE * \
+                                   (LWB_CONF_MAX_DATA_PKT_LEN + 1))
+#define LWB_OUT_BUFFER_MEM_SIZE   (LWB_CONF_OUT_N_PRIO * LWB_OUT_QUEUE_MEM_SIZE)
 #if !LWB_CONF_USE_XMEM
 /* allocate memory in the SRAM (+1 to store the message length) */
-static uint8_t          in_buffer_mem[LWB_CONF_IN_BUFFER_SIZE * 
-                                      (LWB_CONF_MAX_DATA_PKT_LEN + 1)];  
-static uint8_t          out_buffer_mem[LWB_CONF_OUT_BUFFER_SIZE * 
-                                       (LWB_CONF_MAX_DATA_PKT_LEN + 1)]; 
+static uint8_t          in_buffer_mem[LWB_IN_BUFFER_MEM_SIZE];  
+static uint8_t          out_buffer_mem[LWB_OUT_BUFFER_MEM_SIZE]; 
+/* the queues deliver offsets into these memory blocks */
+#define LWB_QUEUE_MEM(q)                      q##_mem
+#define LWB_QUEUE_READ(mem, addr, len, buf)   memcpy(buf, (mem) + (addr), len)
+#define LWB_QUEUE_WRITE(mem, addr, len, buf)  memcpy((mem) + (addr), buf, len)
 #else /* LWB_CONF_USE_XMEM */
 static uint8_t          data_buffer[LWB_CONF_MAX_DATA_PKT_LEN + 1];
 static uint32_t         stats_addr = 0;
+#define LWB_QUEUE_MEM(q)                      0
+#define LWB_QUEUE_READ(mem, addr, len, buf)   xmem_read(addr, len, buf)
+#define LWB_QUEUE_WRITE(mem, addr, len, buf)  xmem_write(addr, len, buf)
 #endif /* LWB_CONF_USE_XMEM */
-FIFO(in_buffer, LWB_CONF_MAX_DATA_PKT_LEN + 1, LWB_CONF_IN_BUFFER_SIZE);
-FIFO(out_buffer, LWB_CONF_MAX_DATA_PKT_LEN + 1, LWB_CONF_OUT_BUFFER_SIZE);
+#if LWB_CONF_QUEUE_VAR_LEN
+/* variable-size records (1 length byte followed by the message) */
+#if LWB_IN_BUFFER_MEM_SIZE > 0xffff || LWB_OUT_QUEUE_MEM_SIZE > 0xffff
+#error "LWB queues too big for LWB_CONF_QUEUE_VAR_LEN"
+#endif
+typedef struct rbuf     lwb_queue_t;
+#define LWB_QUEUE_ERROR           RBUF_ERROR
+#define LWB_QUEUE_CNT(q)          RBUF_CNT(q)
+#define LWB_QUEUE_EMPTY(q)        RBUF_EMPTY(q)
+#define LWB_QUEUE_RESET(q)        RBUF_RESET(q)
+#define LWB_QUEUE_INIT(q, addr)   rbuf_init(q, addr)
+#define LWB_OUT_QUEUE_INIT(q, addr) \
+{\
+  (q)->size = LWB_OUT_QUEUE_MEM_SIZE;\
+  rbuf_init(q, addr);\
+}
+RBUF(in_buffer, LWB_IN_BUFFER_MEM_SIZE);
+#else /* LWB_CONF_QUEUE_VAR_LEN */
+/* elements of max. size (the message length is stored in the last byte) */
+typedef struct fifo     lwb_queue_t;
+#define LWB_QUEUE_ERROR           FIFO_ERROR
+#define LWB_QUEUE_CNT(q)          FIFO_CNT(q)
+#define LWB_QUEUE_EMPTY(q)        FIFO_EMPTY(q)
+#define LWB_QUEUE_RESET(q)        FIFO_RESET(q)
+#define LWB_QUEUE_INIT(q, addr)   fifo_init(q, addr)
+#define LWB_OUT_QUEUE_INIT(q, addr) \
+{\
+  (q)->size = LWB_CONF_MAX_DATA_PKT_LEN + 1;\
+  (q)->last = LWB_CONF_OUT_BUFFER_SIZE - 1;\
+  fifo_init(q, addr);\
+}
+FIFO(in_buffer, LWB_IN_BUFFER_ELEM_SIZE, LWB_CONF_IN_BUFFER_SIZE);
+#endif /* LWB_CONF_QUEUE_VAR_LEN */
+/* outgoing queues, index = priority class (0 = highest priority) */
+static lwb_queue_t      out_buffer[LWB_CONF_OUT_N_PRIO];
+static uint8_t          out_prio;   /* class of the last fetched message */
+#if LWB_CONF_DATA_ACK
+/* number of sent messages at the head of each outgoing queue that wait for
+ * an acknowledgement */
+static uint16_t         out_inflight[LWB_CONF_OUT_N_PRIO];
+/* the data slots this node sent messages in during round tx_round */
+typedef struct {
+  uint8_t  slot;          /* index of the data slot */
+  uint8_t  prio;          /* priority class of the sent message(s) */
+  uint16_t n_inflight;    /* out_inflight[prio] after this slot */
+} lwb_tx_slot_t;
+static lwb_tx_slot_t    tx_slots[LWB_CONF_MAX_DATA_SLOTS];
+static uint8_t          n_tx_slots;
+static uint16_t         tx_round;   /* lower 16 bits of the time of the round */
+#endif /* LWB_CONF_DATA_ACK */
 #endif /* LWB_CONF_RELAY_ONLY */
+#if LWB_STANDBY_HOST
+/* stream requests overheard by the standby host, they are passed to the 
+ * scheduler once the host acknowledges them */
+static lwb_stream_req_t standby_srq[LWB_CONF_STANDBY_SRQ_BUFFER_SIZE];
+static uint8_t          standby_srq_idx;
+static uint8_t          standby_active;   /* the standby host has taken over */
+#define LWB_IS_HOST               (node_id == HOST_ID || standby_active)
+#else /* LWB_STANDBY_HOST */
+#define LWB_IS_HOST               (node_id == HOST_ID)
+#endif /* LWB_STANDBY_HOST */
+#if LWB_CONF_SCHED_VAR_SLOTS
+static const rtimer_clock_t t_data_class[LWB_SLOT_N_CLASSES] = {
+  LWB_T_DATA_CLASS(0), LWB_T_DATA_CLASS(1), 
+  LWB_T_DATA_CLASS(2), LWB_T_DATA_CLASS(3)
+};
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+/*---------------------------------------------------------------------------*/
+#if LWB_CONF_SCHED_PIPELINED
+/* duration of the data slots of schedule s incl. the gaps */
+static rtimer_clock_t
+lwb_get_t_data_slots(const lwb_schedule_t * const s)
+{
+#if LWB_CONF_SCHED_VAR_SLOTS
+  rtimer_clock_t t = 0;
+  uint8_t i;
+  for(i = 0; i < LWB_SCHED_N_SLOTS(s); i++) {
+    t += LWB_T_DATA(s, i) + LWB_CONF_T_GAP;
+  }
+  return t;
+#else /* LWB_CONF_SCHED_VAR_SLOTS */
+  return (rtimer_clock_t)LWB_SCHED_N_SLOTS(s) * 
+         (LWB_CONF_T_DATA + LWB_CONF_T_GAP);
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+}
+/*---------------------------------------------------------------------------*/
+#endif /* LWB_CONF_SCHED_PIPELINED */
+#if LWB_CONF_SCHED_VAR_SLOTS
+/* the length classes of the data slots are transmitted right after the 
+ * (compressed) slots: appends them to the schedule packet of length len and
+ * returns the new length */
+static uint8_t
+lwb_sched_put_slot_len(lwb_schedule_t* sched, uint8_t len)
+{
+  uint8_t n = LWB_SCHED_SLOT_LEN_BYTES(LWB_SCHED_N_SLOTS(sched));
+  memmove((uint8_t*)sched + len, sched->slot_len, n);
+  return len + n;
+}
+/*---------------------------------------------------------------------------*/
+/* copies the length classes out of the received schedule packet of length
+ * len (before the slots are uncompressed) */
+static void
+lwb_sched_get_slot_len(lwb_schedule_t* sched, uint8_t len)
+{
+  uint8_t n = LWB_SCHED_SLOT_LEN_BYTES(LWB_SCHED_N_SLOTS(sched));
+  if(len < LWB_SCHED_PKT_HEADER_LEN + n || 
+     LWB_SCHED_N_SLOTS(sched) > LWB_CONF_MAX_DATA_SLOTS) {
+    /* invalid packet: assume the longest slots */
+    memset(sched->slot_len, 0xff, sizeof(sched->slot_len));
+    return;
+  }
+  memmove(sched->slot_len, (uint8_t*)sched + len - n, n);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
 /*---------------------------------------------------------------------------*/
 uint8_t
 lwb_stats_load(void) 
@@ -313,6 +536,110 @@ lwb_stats_reset(void)
 }
 /*---------------------------------------------------------------------------*/
 #if !LWB_CONF_RELAY_ONLY
+/* allocates space for a message of length len in the queue q (memory block
+ * mem) and stores the length, returns the address of the message or 
+ * LWB_QUEUE_ERROR if the queue is full */
+static uint32_t
+lwb_queue_put(lwb_queue_t* q, uint8_t* mem, uint8_t len)
+{
+#if LWB_CONF_QUEUE_VAR_LEN
+  uint32_t addr = rbuf_put(q, len + 1);
+  if(LWB_QUEUE_ERROR != addr) {
+    LWB_QUEUE_WRITE(mem, addr, 1, &len);
+    addr++;
+  }
+#else /* LWB_CONF_QUEUE_VAR_LEN */
+  uint32_t addr = fifo_put(q);
+  if(LWB_QUEUE_ERROR != addr) {
+    /* last byte holds the message length */
+    LWB_QUEUE_WRITE(mem, addr + LWB_CONF_MAX_DATA_PKT_LEN, 1, &len);
+  }
+#endif /* LWB_CONF_QUEUE_VAR_LEN */
+  return addr;
+}
+/*---------------------------------------------------------------------------*/
+/* returns the address and length of the oldest message in the queue q 
+ * without removing it, or LWB_QUEUE_ERROR if the queue is empty */
+static uint32_t
+lwb_queue_peek(lwb_queue_t* q, uint8_t* mem, uint8_t* len)
+{
+#if LWB_CONF_QUEUE_VAR_LEN
+  uint32_t addr = rbuf_peek(q);
+  if(LWB_QUEUE_ERROR == addr) {
+    return addr;
+  }
+  LWB_QUEUE_READ(mem, addr, 1, len);
+  addr++;
+#else /* LWB_CONF_QUEUE_VAR_LEN */
+  if(FIFO_EMPTY(q)) {
+    return LWB_QUEUE_ERROR;
+  }
+  uint32_t addr = FIFO_READ_ADDR(q);
+  LWB_QUEUE_READ(mem, addr + LWB_CONF_MAX_DATA_PKT_LEN, 1, len);
+#endif /* LWB_CONF_QUEUE_VAR_LEN */
+  /* check the length */
+  if(*len > LWB_CONF_MAX_DATA_PKT_LEN) {
+    DEBUG_PRINT_WARNING("invalid message length detected");
+    *len = LWB_CONF_MAX_DATA_PKT_LEN;  /* truncate */
+  }
+  return addr;
+}
+/*---------------------------------------------------------------------------*/
+/* removes the oldest message (of length len) from the queue q */
+static void
+lwb_queue_drop(lwb_queue_t* q, uint8_t len)
+{
+#if LWB_CONF_QUEUE_VAR_LEN
+  rbuf_drop(q, len + 1);
+#else /* LWB_CONF_QUEUE_VAR_LEN */
+  fifo_drop(q, 1);
+#endif /* LWB_CONF_QUEUE_VAR_LEN */
+}
+/*---------------------------------------------------------------------------*/
+#if LWB_CONF_DATA_ACK
+/* returns the address and length of the n-th oldest message in the queue q 
+ * (n = 0 is the oldest) without removing it, or LWB_QUEUE_ERROR if there are
+ * not more than n messages in the queue */
+static uint32_t
+lwb_queue_peek_n(lwb_queue_t* q, uint8_t* mem, uint16_t n, uint8_t* len)
+{
+  if(n >= LWB_QUEUE_CNT(q)) {
+    return LWB_QUEUE_ERROR;
+  }
+#if LWB_CONF_QUEUE_VAR_LEN
+  uint32_t addr = rbuf_peek(q);
+  LWB_QUEUE_READ(mem, addr, 1, len);
+  while(n--) {
+    addr = rbuf_next(q, addr, *len + 1);
+    LWB_QUEUE_READ(mem, addr, 1, len);
+  }
+  addr++;
+#else /* LWB_CONF_QUEUE_VAR_LEN */
+  uint32_t addr = fifo_elem_addr(q, q->read + n);
+  LWB_QUEUE_READ(mem, addr + LWB_CONF_MAX_DATA_PKT_LEN, 1, len);
+#endif /* LWB_CONF_QUEUE_VAR_LEN */
+  /* check the length */
+  if(*len > LWB_CONF_MAX_DATA_PKT_LEN) {
+    DEBUG_PRINT_WARNING("invalid message length detected");
+    *len = LWB_CONF_MAX_DATA_PKT_LEN;  /* truncate */
+  }
+  return addr;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* LWB_CONF_DATA_ACK */
+#if LWB_CONF_DATA_AGGREGATION && !LWB_CONF_DATA_ACK
+/* puts the message removed by the last lwb_queue_drop() back into queue q */
+static void
+lwb_queue_restore(lwb_queue_t* q)
+{
+#if LWB_CONF_QUEUE_VAR_LEN
+  rbuf_restore(q);
+#else /* LWB_CONF_QUEUE_VAR_LEN */
+  fifo_restore(q, 1);
+#endif /* LWB_CONF_QUEUE_VAR_LEN */
+}
+/*---------------------------------------------------------------------------*/
+#endif /* LWB_CONF_DATA_AGGREGATION && !LWB_CONF_DATA_ACK */
 /* store a received message in the incoming queue, returns 1 if successful, 
  * 0 otherwise */
 uint8_t 
@@ -322,19 +649,11 @@ lwb_in_buffer_put(const uint8_t * const data, uint8_t len)
     len = LWB_CONF_MAX_DATA_PKT_LEN;
     DEBUG_PRINT_WARNING("received data packet is too big"); 
   }
-  /* received messages will have the max. length LWB_CONF_MAX_DATA_PKT_LEN */
-  uint32_t pkt_addr = fifo_put(&in_buffer);
-  if(FIFO_ERROR != pkt_addr) {
-#if !LWB_CONF_USE_XMEM
+  uint32_t pkt_addr = lwb_queue_put(&in_buffer, LWB_QUEUE_MEM(in_buffer), 
+                                    len);
+  if(LWB_QUEUE_ERROR != pkt_addr) {
     /* copy the data into the queue */
-    memcpy((uint8_t*)(uint16_t)pkt_addr, data, len);
-    /* last byte holds the payload length */
-    *(uint8_t*)((uint16_t)pkt_addr + LWB_CONF_MAX_DATA_PKT_LEN) = len;    
-#else /* LWB_CONF_USE_XMEM */
-    /* write the data into the queue in the external memory */
-    xmem_write(pkt_addr, len, data);
-    xmem_write(pkt_addr + LWB_CONF_MAX_DATA_PKT_LEN, 1, &len);
-#endif /* LWB_CONF_USE_XMEM */
+    LWB_QUEUE_WRITE(LWB_QUEUE_MEM(in_buffer), pkt_addr, len, data);
     return 1;
   }
   stats.rxbuf_drop++;
@@ -342,48 +661,331 @@ lwb_in_buffer_put(const uint8_t * const data, uint8_t len)
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+#if LWB_RX_ZERO_COPY
+/* address of the next free element of the incoming queue that can hold a
+ * packet of max. length or LWB_QUEUE_ERROR */
+static uint32_t
+lwb_in_buffer_next(void)
+{
+#if LWB_CONF_QUEUE_VAR_LEN
+  uint32_t addr = rbuf_reserve(&in_buffer, LWB_CONF_MAX_PKT_LEN + 1);
+  /* skip the length byte */
+  return (LWB_QUEUE_ERROR != addr) ? (addr + 1) : addr;
+#else /* LWB_CONF_QUEUE_VAR_LEN */
+  return FIFO_FULL(&in_buffer) ? LWB_QUEUE_ERROR : 
+                                 FIFO_WRITE_ADDR(&in_buffer);
+#endif /* LWB_CONF_QUEUE_VAR_LEN */
+}
+/*---------------------------------------------------------------------------*/
+#endif /* LWB_RX_ZERO_COPY */
+/* returns the buffer to receive the next data packet into: the next free
+ * element of the incoming queue (zero-copy) or buf if this is not possible */
+static uint8_t*
+lwb_in_buffer_reserve(uint8_t* buf)
+{
+#if LWB_RX_ZERO_COPY
+  uint32_t addr = lwb_in_buffer_next();
+  if(LWB_QUEUE_ERROR != addr) {
+    return in_buffer_mem + addr;
+  }
+#endif /* LWB_RX_ZERO_COPY */
+  return buf;
+}
+/*---------------------------------------------------------------------------*/
+/* store a received message in the incoming queue; no copy is needed if the
+ * message was received into the element returned by lwb_in_buffer_reserve();
+ * returns 1 if successful, 0 otherwise */
+static uint8_t
+lwb_in_buffer_commit(uint8_t* data, uint8_t len)
+{
+#if LWB_RX_ZERO_COPY
+  uint32_t addr = lwb_in_buffer_next();
+  if(LWB_QUEUE_ERROR != addr && data == in_buffer_mem + addr) {
+    if(len > LWB_CONF_MAX_DATA_PKT_LEN) {
+      len = LWB_CONF_MAX_DATA_PKT_LEN;
+      DEBUG_PRINT_WARNING("received data packet is too big"); 
+    }
+  #if LWB_CONF_QUEUE_VAR_LEN
+    /* the first byte of the record holds the message length */
+    rbuf_commit(&in_buffer, addr - 1, len + 1);
+    *(data - 1) = len;
+  #else /* LWB_CONF_QUEUE_VAR_LEN */
+    /* last byte holds the payload length */
+    *(data + LWB_CONF_MAX_DATA_PKT_LEN) = len;
+    fifo_put(&in_buffer);
+  #endif /* LWB_CONF_QUEUE_VAR_LEN */
+    return 1;
+  }
+#endif /* LWB_RX_ZERO_COPY */
+  return lwb_in_buffer_put(data, len);
+}
+/*---------------------------------------------------------------------------*/
 /* fetch the next 'ready-to-send' message from the outgoing queue
- * returns the message length in bytes */
+ * returns the message length in bytes; with LWB_CONF_DATA_ACK, the message
+ * stays in the queue until it is acknowledged (or dropped by the host, see 
+ * lwb_out_buffer_drop) */
 uint8_t 
 lwb_out_buffer_get(uint8_t* out_data)
 {   
   /* messages have the max. length LWB_CONF_MAX_DATA_PKT_LEN and are already
    * formatted according to glossy_payload_t */
-  uint32_t pkt_addr = fifo_get(&out_buffer);
-  if(FIFO_ERROR != pkt_addr) {
-#if !LWB_CONF_USE_XMEM
-    /* assume pointers are always 16-bit */
-    uint8_t* next_msg = (uint8_t*)(uint16_t)pkt_addr;
-    /* check the length */
-    uint8_t len = *(next_msg + LWB_CONF_MAX_DATA_PKT_LEN);
-    if(len > LWB_CONF_MAX_DATA_PKT_LEN) {
-      DEBUG_PRINT_WARNING("invalid message length detected");
-      len = LWB_CONF_MAX_DATA_PKT_LEN;  /* truncate */
-    }
-    memcpy(out_data, next_msg, len);
-#else /* LWB_CONF_USE_XMEM */
-    xmem_read(pkt_addr, LWB_CONF_MAX_DATA_PKT_LEN + 1, data_buffer);
-    /* check the length */
-    uint8_t len = *(out_data + LWB_CONF_MAX_DATA_PKT_LEN);
-    if(len > LWB_CONF_MAX_DATA_PKT_LEN) {
-      DEBUG_PRINT_WARNING("invalid message length detected");
-      len = LWB_CONF_MAX_DATA_PKT_LEN;  /* truncate */
+  uint8_t len;
+  /* serve the highest priority class first */
+  for(out_prio = 0; out_prio < LWB_CONF_OUT_N_PRIO; out_prio++) {
+#if LWB_CONF_DATA_ACK
+    /* skip the messages that wait for an acknowledgement */
+    uint32_t pkt_addr = lwb_queue_peek_n(&out_buffer[out_prio], 
+                                         LWB_QUEUE_MEM(out_buffer),
+                                         out_inflight[out_prio], &len);
+#else /* LWB_CONF_DATA_ACK */
+    uint32_t pkt_addr = lwb_queue_peek(&out_buffer[out_prio], 
+                                       LWB_QUEUE_MEM(out_buffer), &len);
+#endif /* LWB_CONF_DATA_ACK */
+    if(LWB_QUEUE_ERROR != pkt_addr) {
+      LWB_QUEUE_READ(LWB_QUEUE_MEM(out_buffer), pkt_addr, len, out_data);
+#if LWB_CONF_DATA_ACK
+      out_inflight[out_prio]++;
+#else /* LWB_CONF_DATA_ACK */
+      lwb_queue_drop(&out_buffer[out_prio], len);
+#endif /* LWB_CONF_DATA_ACK */
+      return len;
     }
-    memcpy(out_data, data_buffer, len);
-#endif /* LWB_CONF_USE_XMEM */
-    return len;
   }
   DEBUG_PRINT_VERBOSE("out queue empty");
   return 0;
 }
 /*---------------------------------------------------------------------------*/
-/* puts a message into the outgoing queue, returns 1 if successful, 
- * 0 otherwise */
+/* removes the oldest message of the priority class prio from the outgoing 
+ * queue, returns 0 if the queue is empty */
+static uint8_t
+lwb_out_buffer_drop(uint8_t prio)
+{
+  uint8_t len;
+  if(LWB_QUEUE_ERROR == lwb_queue_peek(&out_buffer[prio], 
+                                       LWB_QUEUE_MEM(out_buffer), &len)) {
+    return 0;
+  }
+  lwb_queue_drop(&out_buffer[prio], len);
+#if LWB_CONF_DATA_ACK
+  if(out_inflight[prio]) {
+    /* the message was waiting for an acknowledgement */
+    uint8_t i;
+    out_inflight[prio]--;
+    for(i = 0; i < n_tx_slots; i++) {
+      if(tx_slots[i].prio == prio && tx_slots[i].n_inflight) {
+        tx_slots[i].n_inflight--;
+      }
+    }
+  }
+#endif /* LWB_CONF_DATA_ACK */
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+#if LWB_CONF_DATA_ACK
+/* the message(s) fetched last were sent in data slot 'slot' of this round, 
+ * keep them until they are acknowledged */
+static void
+lwb_out_buffer_sent(uint8_t slot, uint16_t round)
+{
+  if(n_tx_slots < LWB_CONF_MAX_DATA_SLOTS) {
+    tx_slots[n_tx_slots].slot = slot;
+    tx_slots[n_tx_slots].prio = out_prio;
+    tx_slots[n_tx_slots].n_inflight = out_inflight[out_prio];
+    n_tx_slots++;
+  }
+  tx_round = round;
+}
+/*---------------------------------------------------------------------------*/
+/* processes the D-ACK packet pkt of length len (pkt = 0 if no D-ACK was 
+ * received): removes the acknowledged messages from the outgoing queues, all 
+ * other messages sent in round tx_round are retransmitted in the next slots;
+ * as the messages of a class must be removed in order, a missing ack also
+ * causes the retransmission of the following (acknowledged) messages of the
+ * same class */
+static void
+lwb_out_buffer_proc_dack(const uint8_t* pkt, uint8_t len)
+{
+  uint16_t n_acked[LWB_CONF_OUT_N_PRIO] = { 0 };
+  uint8_t  nack = 0;  /* classes with an unacknowledged slot (bit mask) */
+  uint8_t  i;
+  
+  if(pkt && (len < LWB_DACK_PKT_LEN(0) || 
+             ((uint16_t)pkt[1] << 8 | pkt[0]) != tx_round)) {
+    /* not the acknowledgement of the round we sent in */
+    pkt = 0;
+  }
+  for(i = 0; i < n_tx_slots; i++) {
+    uint8_t slot = tx_slots[i].slot;
+    uint8_t prio = tx_slots[i].prio;
+    if(pkt && (LWB_DACK_PKT_LEN(slot + 1) <= len) &&
+       (pkt[2 + (slot >> 3)] & (1 << (slot & 0x07))) && 
+       !(nack & (1 << prio))) {
+      n_acked[prio] = tx_slots[i].n_inflight;
+    } else {
+      nack |= (1 << prio);
+    }
+  }
+  n_tx_slots = 0;
+  for(i = 0; i < LWB_CONF_OUT_N_PRIO; i++) {
+    while(n_acked[i]--) {
+      lwb_out_buffer_drop(i);
+    }
+    if(out_inflight[i]) {
+      DEBUG_PRINT_VERBOSE("%u messages of class %u not acknowledged", 
+                          out_inflight[i], i);
+      out_inflight[i] = 0;   /* send them again */
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+#endif /* LWB_CONF_DATA_ACK */
+/* total number of messages in the outgoing queues */
+static uint16_t
+lwb_out_buffer_cnt(void)
+{
+  uint16_t cnt = 0;
+  uint8_t i;
+  for(i = 0; i < LWB_CONF_OUT_N_PRIO; i++) {
+    cnt += LWB_QUEUE_CNT(&out_buffer[i]);
+  }
+  return cnt;
+}
+/*---------------------------------------------------------------------------*/
+#if LWB_CONF_DATA_AGGREGATION
+/* puts the message fetched by the last lwb_out_buffer_get() back */
+static void
+lwb_out_buffer_restore(void)
+{
+#if LWB_CONF_DATA_ACK
+  out_inflight[out_prio]--;
+#else /* LWB_CONF_DATA_ACK */
+  lwb_queue_restore(&out_buffer[out_prio]);
+#endif /* LWB_CONF_DATA_ACK */
+}
+/*---------------------------------------------------------------------------*/
+/* packs as many messages of the same stream from the head of the outgoing 
+ * queue into out_data as fit into max_len bytes; an aggregated packet has the
+ * stream ID LWB_AGGR_STREAM_ID and each message inside is prefixed with its
+ * length, a single message is sent as is; returns the packet length */
+static uint8_t
+lwb_out_buffer_get_aggr(uint8_t* out_data, uint8_t max_len)
+{
+  static uint8_t next_msg[LWB_CONF_MAX_DATA_PKT_LEN];
+  uint8_t len = lwb_out_buffer_get(out_data);
+  uint8_t stream_id = LWB_PKT_STREAM_ID(out_data);
+  uint8_t prio = out_prio;
+  uint8_t n_msg = 1;
+  
+  /* the smallest aggregated packet holds 2 messages without payload */
+  while(len && (n_msg > 1 || 
+                (len + 2 * (LWB_CONF_HEADER_LEN + 1) <= max_len)) &&
+        lwb_out_buffer_cnt()) {
+    uint8_t msg_len = lwb_out_buffer_get(next_msg);
+    if(!msg_len) {
+      break;    /* only messages that wait for an acknowledgement left */
+    }
+    uint8_t pkt_len = (n_msg > 1) ? len : (len + LWB_CONF_HEADER_LEN + 1);
+    if(msg_len < LWB_CONF_HEADER_LEN || 
+       LWB_PKT_STREAM_ID(next_msg) != stream_id ||
+       out_prio != prio || (uint16_t)pkt_len + 1 + msg_len > max_len) {
+      /* doesn't fit, leave it in the queue */
+      lwb_out_buffer_restore();
+      break;
+    }
+    if(n_msg == 1) {
+      /* convert the first message into the aggregated format */
+      memmove(out_data + LWB_CONF_HEADER_LEN + 1, out_data, len);
+      LWB_PKT_SET_HEADER(out_data, LWB_RECIPIENT_BROADCAST, 
+                         LWB_AGGR_STREAM_ID);
+      out_data[LWB_CONF_HEADER_LEN] = len;
+    }
+    out_data[pkt_len] = msg_len;
+    memcpy(out_data + pkt_len + 1, next_msg, msg_len);
+    len = pkt_len + 1 + msg_len;
+    n_msg++;
+  }
+  if(n_msg > 1) {
+    DEBUG_PRINT_VERBOSE("%u messages aggregated (%ub)", n_msg, len);
+  }
+  out_prio = prio;  /* all messages are of the same class */
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+/* unpacks the aggregated packet pkt of length len received from node 'sender'
+ * and stores the messages destined for this node in the incoming queue; sinks
+ * also accept messages for LWB_RECIPIENT_SINK; returns the stream ID of the 
+ * first message */
+static uint8_t
+lwb_in_buffer_put_aggr(uint8_t* pkt, uint8_t len, uint16_t sender, 
+                       uint8_t is_sink)
+{
+  uint8_t stream_id = LWB_INVALID_STREAM_ID;
+  uint8_t ofs = LWB_CONF_HEADER_LEN;
+  
+  while(ofs < len) {
+    uint8_t* msg = pkt + ofs + 1;
+    uint8_t  msg_len = pkt[ofs];
+    if(msg_len < LWB_CONF_HEADER_LEN || (uint16_t)ofs + 1 + msg_len > len) {
+      DEBUG_PRINT_WARNING("invalid aggregated packet");
+      break;
+    }
+    uint16_t recipient = LWB_PKT_RECIPIENT(msg, sender);
+    if(LWB_INVALID_STREAM_ID == stream_id) {
+      stream_id = LWB_MSG_STREAM_ID(msg);
+    }
+    if(recipient == node_id || recipient == LWB_RECIPIENT_BROADCAST ||
+       (is_sink && recipient == LWB_RECIPIENT_SINK)) {
+      /* replace target node ID by sender node ID */
+      LWB_PKT_SET_SENDER(msg, sender);
+      lwb_in_buffer_put(msg, msg_len);
+    }
+    ofs += msg_len + 1;
+  }
+  return stream_id;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* LWB_CONF_DATA_AGGREGATION */
+#if LWB_CONF_SCHED_BULK
+/* appends the backlog of this node to the data packet pkt of length len if 
+ * the outgoing queue holds at least LWB_CONF_SCHED_BULK_THRES messages and 
+ * the packet still fits into the data slot (max. max_len bytes); the stream 
+ * ID is moved into the trailer, returns the new packet length */
+static uint8_t
+lwb_bulk_add_backlog(uint8_t* pkt, uint8_t len, uint8_t max_len)
+{
+  uint8_t backlog = lwb_get_send_buffer_state();
+  if(!len || backlog < LWB_CONF_SCHED_BULK_THRES || 
+     (uint16_t)len + LWB_BULK_TRAILER_LEN > max_len ||
+     LWB_AGGR_STREAM_ID == LWB_PKT_STREAM_ID(pkt) ||
+     LWB_INVALID_STREAM_ID == LWB_PKT_STREAM_ID(pkt)) {
+    return len;
+  }
+  pkt[len]     = LWB_PKT_STREAM_ID(pkt);
+  pkt[len + 1] = backlog;
+  LWB_PKT_STREAM_ID(pkt) = LWB_BULK_STREAM_ID;
+  return len + LWB_BULK_TRAILER_LEN;
+}
+/*---------------------------------------------------------------------------*/
+/* removes the trailer from a data packet marked with LWB_BULK_STREAM_ID and
+ * restores its stream ID, returns the backlog of the sender */
+static uint8_t
+lwb_bulk_strip_backlog(uint8_t* pkt, uint8_t* len)
+{
+  *len -= LWB_BULK_TRAILER_LEN;
+  LWB_PKT_STREAM_ID(pkt) = pkt[*len];
+  return pkt[*len + 1];
+}
+/*---------------------------------------------------------------------------*/
+#endif /* LWB_CONF_SCHED_BULK */
+/*---------------------------------------------------------------------------*/
+/* puts a message into the outgoing queue of the priority class prio, 
+ * returns 1 if successful, 0 otherwise */
 uint8_t
-lwb_send_pkt(uint16_t recipient,
-             uint8_t stream_id, 
-             const uint8_t * const data, 
-             uint8_t len)
+lwb_send_pkt_prio(uint16_t recipient,
+                  uint8_t stream_id, 
+                  const uint8_t * const data, 
+                  uint8_t len,
+                  uint8_t prio)
 {
   /* data has the max. length LWB_DATA_PKT_PAYLOAD_LEN, lwb header needs 
    * to be added before the data is inserted into the queue */
@@ -391,25 +993,50 @@ lwb_send_pkt(uint16_t recipient,
     DEBUG_PRINT_ERROR("invalid payload length");
     return 0;
   }
-  uint32_t pkt_addr = fifo_put(&out_buffer);
-  if(FIFO_ERROR != pkt_addr) {
-#if !LWB_CONF_USE_XMEM
-    /* assume pointers are 16-bit */
-    uint8_t* next_msg = (uint8_t*)(uint16_t)pkt_addr;  
-    *(next_msg) = (uint8_t)recipient;   /* recipient L */  
-    *(next_msg + 1) = recipient >> 8;   /* recipient H */  
-    *(next_msg + 2) = stream_id; 
-    *(next_msg + LWB_CONF_MAX_DATA_PKT_LEN) = len + LWB_CONF_HEADER_LEN;
-    memcpy(next_msg + LWB_CONF_HEADER_LEN, data, len);
-#else /* LWB_CONF_USE_XMEM */
-    *(data_buffer) = (uint8_t)recipient;   /* recipient L */  
-    *(data_buffer + 1) = recipient >> 8;   /* recipient H */
-    *(data_buffer + 2) = stream_id;
-    *(data_buffer + LWB_CONF_MAX_DATA_PKT_LEN) = len + LWB_CONF_HEADER_LEN;
-    memcpy(data_buffer + LWB_CONF_HEADER_LEN, data, len);
-    /* always read the max length since we don't know how long the packet is */
-    xmem_write(pkt_addr, LWB_CONF_MAX_DATA_PKT_LEN + 1, data_buffer);
-#endif /* LWB_CONF_USE_XMEM */
+#if LWB_CONF_SCHED_VAR_SLOTS
+  /* the data slots of this node are only long enough for the max. payload
+   * length of its streams */
+  uint8_t max_len = lwb_stream_get_max_len(stream_id);
+  if(max_len && len > max_len) {
+    DEBUG_PRINT_ERROR("payload longer than the max. length of stream %u",
+                      stream_id);
+    return 0;
+  }
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+#if LWB_CONF_DATA_AGGREGATION
+  if(LWB_AGGR_STREAM_ID == stream_id) {
+    DEBUG_PRINT_ERROR("stream ID %u is reserved", stream_id);
+    return 0;
+  }
+#endif /* LWB_CONF_DATA_AGGREGATION */
+#if LWB_CONF_OUT_N_PRIO > 1
+  if(LWB_PRIO_STREAM == prio) {
+    prio = lwb_stream_get_prio(stream_id);
+  }
+#endif /* LWB_CONF_OUT_N_PRIO */
+  if(prio >= LWB_CONF_OUT_N_PRIO) {
+    prio = LWB_PRIO_LOWEST;
+  }
+  lwb_queue_t* q = &out_buffer[prio];
+  uint32_t pkt_addr = lwb_queue_put(q, LWB_QUEUE_MEM(out_buffer),
+                                    len + LWB_CONF_HEADER_LEN);
+  if(LWB_QUEUE_ERROR == pkt_addr && 
+     (LWB_CONF_OUT_PRIO_DROP_OLDEST & (1 << prio))) {
+    /* make room by dropping the oldest message(s) of this class */
+    while(LWB_QUEUE_ERROR == pkt_addr && lwb_out_buffer_drop(prio)) {
+      stats.txbuf_drop++;
+      DEBUG_PRINT_VERBOSE("out queue %u full, oldest message dropped", prio);
+      pkt_addr = lwb_queue_put(q, LWB_QUEUE_MEM(out_buffer),
+                               len + LWB_CONF_HEADER_LEN);
+    }
+  }
+  if(LWB_QUEUE_ERROR != pkt_addr) {
+    uint8_t header[LWB_CONF_HEADER_LEN];
+    LWB_PKT_SET_HEADER(header, recipient, stream_id);
+    LWB_QUEUE_WRITE(LWB_QUEUE_MEM(out_buffer), pkt_addr, 
+                    LWB_CONF_HEADER_LEN, header);
+    LWB_QUEUE_WRITE(LWB_QUEUE_MEM(out_buffer), pkt_addr + LWB_CONF_HEADER_LEN, 
+                    len, data);
     return 1;
   }
   stats.txbuf_drop++;
@@ -417,64 +1044,215 @@ lwb_send_pkt(uint16_t recipient,
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+/* returns 1 if n messages with a payload of len bytes fit into the outgoing
+ * queue of the priority class prio, 0 otherwise */
+uint8_t
+lwb_send_buffer_fits(uint8_t prio, uint16_t n, uint8_t len)
+{
+  if(prio >= LWB_CONF_OUT_N_PRIO) {
+    prio = LWB_PRIO_LOWEST;
+  }
+  /* only the offsets of the queue change, work on a copy */
+  lwb_queue_t q = out_buffer[prio];
+  if(LWB_CONF_OUT_PRIO_DROP_OLDEST & (1 << prio)) {
+    /* older messages are dropped to make room */
+    LWB_QUEUE_RESET(&q);
+  }
+#if LWB_CONF_QUEUE_VAR_LEN
+  while(n && LWB_QUEUE_ERROR != rbuf_put(&q, len + LWB_CONF_HEADER_LEN + 1)) {
+    n--;
+  }
+  return (n == 0);
+#else /* LWB_CONF_QUEUE_VAR_LEN */
+  return (n <= FIFO_FREE_SPACE(&q));
+#endif /* LWB_CONF_QUEUE_VAR_LEN */
+}
+/*---------------------------------------------------------------------------*/
+#if LWB_VERSION == 2
+/* puts a message of the first stream of this node into the outgoing queue,
+ * returns 1 if successful, 0 otherwise */
+uint8_t
+lwb_send_pkt(const uint8_t * const data, uint8_t len)
+{
+  /* the recipient is implied by the sender */
+  return lwb_send_pkt_prio(LWB_RECIPIENT_SINK, lwb_stream_get_first_id(), 
+                           data, len, LWB_PRIO_STREAM);
+}
+#else /* LWB_VERSION */
+/* puts a message into the outgoing queue of the priority class of the stream,
+ * returns 1 if successful, 0 otherwise */
+uint8_t
+lwb_send_pkt(uint16_t recipient,
+             uint8_t stream_id, 
+             const uint8_t * const data, 
+             uint8_t len)
+{
+  return lwb_send_pkt_prio(recipient, stream_id, data, len, LWB_PRIO_STREAM);
+}
+#endif /* LWB_VERSION */
+/*---------------------------------------------------------------------------*/
 /* copies the oldest received message in the queue into out_data and returns 
  * the message size (in bytes) */
+#if LWB_VERSION == 2
+uint8_t
+lwb_rcv_pkt(uint8_t* out_data)
+#else /* LWB_VERSION */
 uint8_t
 lwb_rcv_pkt(uint8_t* out_data,
              uint16_t * const out_node_id, 
              uint8_t * const out_stream_id)
+#endif /* LWB_VERSION */
 { 
   if(!out_data) { return 0; }
   /* messages in the queue have the max. length LWB_CONF_MAX_DATA_PKT_LEN, 
    * lwb header needs to be stripped off; payload has max. length
    * LWB_DATA_PKT_PAYLOAD_LEN */
-  uint32_t pkt_addr = fifo_get(&in_buffer);
-  if(FIFO_ERROR != pkt_addr) {
-#if !LWB_CONF_USE_XMEM
-    /* assume pointers are 16-bit */
-    uint8_t* next_msg = (uint8_t*)(uint16_t)pkt_addr; 
-    uint8_t msg_len = *(next_msg + LWB_CONF_MAX_DATA_PKT_LEN) -
-                      LWB_CONF_HEADER_LEN;
-    if(msg_len > LWB_CONF_MAX_DATA_PKT_LEN) {
-      msg_len = LWB_CONF_MAX_DATA_PKT_LEN;
-    }
-    memcpy(out_data, next_msg + LWB_CONF_HEADER_LEN, msg_len);
-    if(out_node_id) {
-      /* cant just treat next_msg as 16-bit value due to misalignment */
-      *out_node_id = (uint16_t)next_msg[1] << 8 | next_msg[0];
-    }
-    if(out_stream_id) {
-      *out_stream_id = next_msg[2];
-    }
-#else /* LWB_CONF_USE_XMEM */
-    xmem_read(pkt_addr, LWB_CONF_MAX_DATA_PKT_LEN + 1, data_buffer);
-    uint8_t msg_len = *(data_buffer + LWB_CONF_MAX_DATA_PKT_LEN) -
-                      LWB_CONF_HEADER_LEN;
-    memcpy(out_data, data_buffer + LWB_CONF_HEADER_LEN, msg_len);
+  uint8_t msg_len;
+  uint32_t pkt_addr = lwb_queue_peek(&in_buffer, LWB_QUEUE_MEM(in_buffer), 
+                                     &msg_len);
+  if(LWB_QUEUE_ERROR != pkt_addr) {
+    uint8_t payload_len = (msg_len > LWB_CONF_HEADER_LEN) ? 
+                          (msg_len - LWB_CONF_HEADER_LEN) : 0;
+#if LWB_VERSION == 1
+    uint8_t header[LWB_CONF_HEADER_LEN];
+    LWB_QUEUE_READ(LWB_QUEUE_MEM(in_buffer), pkt_addr, LWB_CONF_HEADER_LEN,
+                   header);
     if(out_node_id) {
-      memcpy(out_node_id, data_buffer, 2);
+      /* cant just treat the header as 16-bit value due to misalignment */
+      *out_node_id = LWB_PKT_SENDER(header);
     }
     if(out_stream_id) {
-      *out_stream_id = data_buffer[2];
+      *out_stream_id = LWB_PKT_STREAM_ID(header);
     }
-#endif /* LWB_CONF_USE_XMEM */
-    return msg_len;
+#endif /* LWB_VERSION */
+    LWB_QUEUE_READ(LWB_QUEUE_MEM(in_buffer), pkt_addr + LWB_CONF_HEADER_LEN,
+                   payload_len, out_data);
+    lwb_queue_drop(&in_buffer, msg_len);
+    return payload_len;
   }
   DEBUG_PRINT_VERBOSE("in queue empty");
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+/* returns a pointer to the payload of the oldest received message without
+ * removing it from the queue */
+#if LWB_VERSION == 2
+const uint8_t*
+lwb_rcv_pkt_peek(uint8_t * const out_len)
+#else /* LWB_VERSION */
+const uint8_t*
+lwb_rcv_pkt_peek(uint8_t * const out_len,
+                 uint16_t * const out_node_id, 
+                 uint8_t * const out_stream_id)
+#endif /* LWB_VERSION */
+{
+  uint8_t msg_len;
+  uint32_t pkt_addr = lwb_queue_peek(&in_buffer, LWB_QUEUE_MEM(in_buffer), 
+                                     &msg_len);
+  if(LWB_QUEUE_ERROR == pkt_addr) { 
+    return 0; 
+  }
+#if !LWB_CONF_USE_XMEM
+  uint8_t* next_msg = in_buffer_mem + pkt_addr;
+#else /* LWB_CONF_USE_XMEM */
+  /* the message has to be fetched from the external memory */
+  uint8_t* next_msg = data_buffer;
+  xmem_read(pkt_addr, msg_len, data_buffer);
+#endif /* LWB_CONF_USE_XMEM */
+  if(out_len) {
+    *out_len = (msg_len > LWB_CONF_HEADER_LEN) ? 
+               (msg_len - LWB_CONF_HEADER_LEN) : 0;
+  }
+#if LWB_VERSION == 1
+  if(out_node_id) {
+    *out_node_id = LWB_PKT_SENDER(next_msg);
+  }
+  if(out_stream_id) {
+    *out_stream_id = LWB_PKT_STREAM_ID(next_msg);
+  }
+#endif /* LWB_VERSION */
+  return next_msg + LWB_CONF_HEADER_LEN;
+}
+/*---------------------------------------------------------------------------*/
+void
+lwb_rcv_pkt_consume(void)
+{
+  uint8_t msg_len;
+  if(LWB_QUEUE_ERROR != lwb_queue_peek(&in_buffer, LWB_QUEUE_MEM(in_buffer),
+                                       &msg_len)) {
+    lwb_queue_drop(&in_buffer, msg_len);
+  }
+}
+/*---------------------------------------------------------------------------*/
 uint8_t
 lwb_get_rcv_buffer_state(void)
 {
-  return FIFO_CNT(&in_buffer);
+  /* saturate, the variable-size queues may hold more than 255 messages */
+  return (LWB_QUEUE_CNT(&in_buffer) > 0xff) ? 0xff : 
+                                                  LWB_QUEUE_CNT(&in_buffer);
 }
 /*---------------------------------------------------------------------------*/
 uint8_t
 lwb_get_send_buffer_state(void)
 {
-  return FIFO_CNT(&out_buffer);
+  /* saturate, the variable-size queues may hold more than 255 messages */
+  uint16_t cnt = lwb_out_buffer_cnt();
+  return (cnt > 0xff) ? 0xff : cnt;
 }
+/*---------------------------------------------------------------------------*/
+#if LWB_STANDBY_HOST
+/* keeps a stream request req (may be unaligned) overheard by the standby 
+ * host until the host acknowledges it */
+static void
+lwb_standby_put_srq(const uint8_t* req)
+{
+  uint8_t i;
+  if(node_id != LWB_CONF_STANDBY_HOST_ID) {
+    return;
+  }
+  /* a source repeats its request until it is acknowledged, but the standby 
+   * host may not receive the same request as the host (capture effect)
+   * -> keep the last request of each stream, overwrite the oldest one */
+  for(i = 0; i < LWB_CONF_STANDBY_SRQ_BUFFER_SIZE; i++) {
+    if(memcmp(&standby_srq[i], req, 2) == 0 &&
+       standby_srq[i].stream_id == ((lwb_stream_req_t*)req)->stream_id) {
+      break;
+    }
+  }
+  if(i == LWB_CONF_STANDBY_SRQ_BUFFER_SIZE) {
+    i = standby_srq_idx;
+    standby_srq_idx = (standby_srq_idx + 1) % LWB_CONF_STANDBY_SRQ_BUFFER_SIZE;
+  }
+  memcpy(&standby_srq[i], req, sizeof(lwb_stream_req_t));
+}
+/*---------------------------------------------------------------------------*/
+/* passes the stream requests acknowledged in the S-ACK packet pkt of length 
+ * len to the scheduler of the standby host; pkt is overwritten */
+static void
+lwb_standby_proc_sack(uint8_t* pkt, uint8_t len)
+{
+  uint8_t i, j;
+  if(node_id != LWB_CONF_STANDBY_HOST_ID) {
+    return;
+  }
+  for(i = 0; i <= ((lwb_stream_ack_t*)pkt)->n_extra && 
+              (i + 1) * LWB_SACK_MIN_PKT_LEN <= len; i++) {
+    uint16_t id = (uint16_t)pkt[i * 4 + 1] << 8 | pkt[i * 4];
+    for(j = 0; j < LWB_CONF_STANDBY_SRQ_BUFFER_SIZE; j++) {
+      if(standby_srq[j].id == id && 
+         standby_srq[j].stream_id == pkt[i * 4 + 2]) {
+        lwb_sched_proc_srq(&standby_srq[j]);
+        standby_srq[j].stream_id = LWB_INVALID_STREAM_ID;
+        break;
+      }
+    }
+  }
+  /* the host has already sent these S-ACKs, drop them (otherwise the 
+   * scheduler rejects further requests once its S-ACK buffer is full) */
+  lwb_sched_prepare_sack(pkt);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* LWB_STANDBY_HOST */
 #endif /* LWB_CONF_RELAY_ONLY */
 /*---------------------------------------------------------------------------*/
 const lwb_statistics_t * const
@@ -501,6 +1279,12 @@ lwb_get_state(void)
   return LWB_STATE_CONN_LOST;
 }
 /*---------------------------------------------------------------------------*/
+uint8_t
+lwb_is_host(void)
+{
+  return LWB_IS_HOST;
+}
+/*---------------------------------------------------------------------------*/
 uint32_t 
 lwb_get_time(rtimer_clock_t* reception_time)
 {
@@ -534,18 +1318,26 @@ PT_THREAD(lwb_thread_host(rtimer_t *rt))
   static lwb_schedule_t schedule;
   static rtimer_clock_t t_start; 
   static rtimer_clock_t t_now;
+  static rtimer_clock_t t_sched2;          /* offset of the 2nd schedule */
 #if LWB_CONF_USE_LF_FOR_WAKEUP
   static rtimer_clock_t t_start_lf;
 #endif /* LWB_CONF_USE_LF_FOR_WAKEUP */
   static glossy_payload_t glossy_payload;                   /* packet buffer */
+  static uint8_t* rx_pkt;                   /* buffer for received data pkts */
   /* constant guard time for the host */
   static const uint32_t t_guard = LWB_CONF_T_GUARD; 
-  static uint8_t slot_idx;
+  static rtimer_clock_t t_slot;            /* offset of the next slot */
   static uint8_t streams_to_update[LWB_CONF_MAX_DATA_SLOTS];
   static uint8_t schedule_len, 
                  payload_len;
   static uint8_t rcvd_data_pkts;
   static int8_t  glossy_rssi;
+#if LWB_CONF_DATA_ACK
+  /* data slots received in the last round (1 bit per slot) */
+  static uint8_t  dack_bitmap[(LWB_CONF_MAX_DATA_SLOTS + 7) / 8];
+  static uint8_t  dack_n_slots;
+  static uint16_t dack_round;   /* lower 16 bits of the time of that round */
+#endif /* LWB_CONF_DATA_ACK */
   static const void* callback_func = lwb_thread_host;
 
   /* note: all statements above PT_BEGIN() will be executed each time the 
@@ -556,13 +1348,21 @@ PT_THREAD(lwb_thread_host(rtimer_t *rt))
   memset(&schedule, 0, sizeof(schedule));
   
   /* initialization specific to the host node */
-  schedule_len = lwb_sched_init(&schedule);
   sync_state = SYNCED;  /* the host is always 'synced' */
-  
-  rtimer_reset();
+#if LWB_STANDBY_HOST
+  if(standby_active) {
+    /* continue the schedule of the failed host with the streams mirrored by
+     * the standby host (the timers keep running) */
+    schedule_len = lwb_sched_set_time(&schedule, global_time);
+  } else
+#endif /* LWB_STANDBY_HOST */
+  {
+    schedule_len = lwb_sched_init(&schedule);
+    rtimer_reset();
 #if LWB_CONF_USE_LF_FOR_WAKEUP 
-  rt->time = 0; //rtimer_now_lf();
+    rt->time = 0; //rtimer_now_lf();
 #endif /* LWB_CONF_USE_LF_FOR_WAKEUP */
+  }
   
   while(1) {
 #if LWB_CONF_T_PREPROCESS
@@ -597,7 +1397,7 @@ PT_THREAD(lwb_thread_host(rtimer_t *rt))
 
     glossy_rssi = glossy_get_rssi(0);
     stats.relay_cnt = glossy_get_relay_cnt_first_rx();
-    slot_idx = 0;     /* reset the packet counter */
+    t_slot = LWB_T_SLOT_FIRST;
     
 #if LWB_CONF_USE_XMEM
     /* put the external memory back into active mode (takes ~500us) */
@@ -606,19 +1406,38 @@ PT_THREAD(lwb_thread_host(rtimer_t *rt))
 
     /* uncompress the schedule */
 #if LWB_CONF_SCHED_COMPRESS
-    lwb_sched_uncompress((uint8_t*)schedule.slot, 
-                         LWB_SCHED_N_SLOTS(&schedule));
+    lwb_sched_uncompress(&schedule);
 #endif /* LWB_CONF_SCHED_COMPRESS */
     
+#if LWB_CONF_DATA_ACK
+    /* --- D-ACK SLOT --- */
+    
+    if(LWB_SCHED_HAS_DACK_SLOT(&schedule)) {
+      /* acknowledge the data slots of the last round */
+      glossy_payload.raw_data[0] = (uint8_t)dack_round;
+      glossy_payload.raw_data[1] = dack_round >> 8;
+      memcpy(&glossy_payload.raw_data[2], dack_bitmap, 
+             LWB_DACK_PKT_LEN(dack_n_slots) - 2);
+      payload_len = LWB_DACK_PKT_LEN(dack_n_slots);
+      LWB_WAIT_UNTIL(t_start + t_slot);
+      LWB_SEND_PACKET(LWB_CONF_T_DACK);
+      DEBUG_PRINT_VERBOSE("D-ACK sent (%u slots)", dack_n_slots);
+      t_slot += LWB_CONF_T_DACK + LWB_CONF_T_GAP;
+    }
+    memset(dack_bitmap, 0, sizeof(dack_bitmap));
+    dack_round = schedule.time;
+    dack_n_slots = LWB_SCHED_N_SLOTS(&schedule);
+#endif /* LWB_CONF_DATA_ACK */
+    
     /* --- S-ACK SLOT --- */
     
     if(LWB_SCHED_HAS_SACK_SLOT(&schedule)) {
       payload_len = lwb_sched_prepare_sack(&glossy_payload.sack_pkt); 
       /* wait for the slot to start */
-      LWB_WAIT_UNTIL(t_start + LWB_T_SLOT_START(0));            
-      LWB_SEND_PACKET();   /* transmit s-ack */
+      LWB_WAIT_UNTIL(t_start + t_slot);            
+      LWB_SEND_PACKET(LWB_CONF_T_DATA);   /* transmit s-ack */
       DEBUG_PRINT_VERBOSE("S-ACK sent");
-      slot_idx++;   /* increment the packet counter */
+      t_slot += LWB_CONF_T_DATA + LWB_CONF_T_GAP;
     } else {
       DEBUG_PRINT_VERBOSE("no S-ACK slot");
     }
@@ -628,53 +1447,119 @@ PT_THREAD(lwb_thread_host(rtimer_t *rt))
     rcvd_data_pkts = 0;    /* number of received data packets in this round */
     if(LWB_SCHED_HAS_DATA_SLOT(&schedule)) {
       static uint8_t i = 0;
-      for(i = 0; i < LWB_SCHED_N_SLOTS(&schedule); i++, slot_idx++) {
+      for(i = 0; i < LWB_SCHED_N_SLOTS(&schedule); 
+          t_slot += LWB_T_DATA(&schedule, i) + LWB_CONF_T_GAP, i++) {
         streams_to_update[i] = LWB_INVALID_STREAM_ID;
         /* is this our slot? Note: slots assigned to node ID 0 always belong 
          * to the host */
         if(schedule.slot[i] == 0 || schedule.slot[i] == node_id) {
           /* send a data packet (if there is any) */
+#if LWB_CONF_DATA_AGGREGATION
+          payload_len = lwb_out_buffer_get_aggr(glossy_payload.raw_data,
+                                                LWB_SLOT_PKT_LEN(&schedule, i) -
+                                                LWB_DATA_PKT_TRAILER_LEN);
+#else /* LWB_CONF_DATA_AGGREGATION */
           payload_len = lwb_out_buffer_get(glossy_payload.raw_data);
+#endif /* LWB_CONF_DATA_AGGREGATION */
+#if LWB_CONF_DATA_ACK
+          /* the packets of the host are not acknowledged (out_prio is only
+           * valid if a message was fetched) */
+          if(payload_len) {
+            while(out_inflight[out_prio]) {
+              lwb_out_buffer_drop(out_prio);
+            }
+          }
+#endif /* LWB_CONF_DATA_ACK */
+#if LWB_CONF_DATA_QUEUE_DEPTH
+          if(payload_len) {
+            /* all data packets have the same format */
+            glossy_payload.raw_data[payload_len++] = 
+              lwb_get_send_buffer_state();
+          }
+#endif /* LWB_CONF_DATA_QUEUE_DEPTH */
           if(payload_len) { 
             /* note: stream ID is irrelevant here */
             /* wait until the data slot starts */
-            LWB_WAIT_UNTIL(t_start + LWB_T_SLOT_START(slot_idx));  
-            LWB_SEND_PACKET();
+            LWB_WAIT_UNTIL(t_start + t_slot);  
+            LWB_SEND_PACKET(LWB_T_DATA(&schedule, i));
             DEBUG_PRINT_VERBOSE("data packet sent (%ub)", payload_len);
           }
         } else {        
           /* wait until the data slot starts */
           LWB_DATA_SLOT_STARTS;
-          LWB_WAIT_UNTIL(t_start + LWB_T_SLOT_START(slot_idx) - t_guard); 
-          LWB_RCV_PACKET();  /* receive a data packet */
+          LWB_WAIT_UNTIL(t_start + t_slot - t_guard); 
+          /* receive a data packet, directly into the incoming queue if 
+           * possible */
+          rx_pkt = lwb_in_buffer_reserve(glossy_payload.raw_data);
+          LWB_RCV_PACKET(rx_pkt, LWB_T_DATA(&schedule, i));
           payload_len = glossy_get_payload_len();
           if(LWB_DATA_RCVD && payload_len) {
             /* measure the time it takes to process the received message */
             RTIMER_CAPTURE;   
-            if(glossy_payload.data_pkt.recipient == node_id || 
-               glossy_payload.data_pkt.recipient == LWB_RECIPIENT_SINK ||
-               glossy_payload.data_pkt.recipient == LWB_RECIPIENT_BROADCAST) {
+#if LWB_CONF_DATA_ACK
+            uint16_t rxbuf_drop = stats.rxbuf_drop;
+#endif /* LWB_CONF_DATA_ACK */
+#if LWB_CONF_DATA_QUEUE_DEPTH
+            if(payload_len > LWB_CONF_HEADER_LEN) {
+              /* strip the fill level of the sender's outgoing queue */
+              payload_len--;
+              lwb_sched_proc_queue_depth(schedule.slot[i], rx_pkt[payload_len]);
+            }
+#endif /* LWB_CONF_DATA_QUEUE_DEPTH */
+#if LWB_CONF_SCHED_BULK
+            if(LWB_IS_BULK_PKT(rx_pkt, payload_len)) {
+              uint8_t backlog = lwb_bulk_strip_backlog(rx_pkt, &payload_len);
+              lwb_sched_proc_backlog(schedule.slot[i], 
+                                     LWB_MSG_STREAM_ID(rx_pkt), backlog);
+            }
+#endif /* LWB_CONF_SCHED_BULK */
+            uint16_t recipient = LWB_PKT_RECIPIENT(rx_pkt, schedule.slot[i]);
+            if(recipient == node_id || recipient == LWB_RECIPIENT_SINK ||
+               recipient == LWB_RECIPIENT_BROADCAST) {
               /* is it a stream request? (piggyback on data packet) */
-              if(LWB_INVALID_STREAM_ID == glossy_payload.data_pkt.stream_id) {
+              if(LWB_INVALID_STREAM_ID == LWB_PKT_STREAM_ID(rx_pkt)) {
+                if(rx_pkt != glossy_payload.raw_data) {
+                  memcpy(glossy_payload.raw_data, rx_pkt, payload_len);
+                }
                 DEBUG_PRINT_VERBOSE("piggyback stream request from node %u", 
-                                 glossy_payload.srq_pkt.id);
+                                    schedule.slot[i]);
                 lwb_sched_proc_srq((lwb_stream_req_t*)
-                                   &glossy_payload.raw_data[3]);
+                                   (glossy_payload.raw_data + 
+                                    LWB_CONF_HEADER_LEN));
               } else 
+#if LWB_CONF_DATA_AGGREGATION
+              if(LWB_AGGR_STREAM_ID == LWB_PKT_STREAM_ID(rx_pkt)) {
+                DEBUG_PRINT_VERBOSE("aggregated data received (s=%u l=%u)",
+                                    schedule.slot[i], payload_len);
+                /* the messages are unpacked into the incoming queue */
+                if(rx_pkt != glossy_payload.raw_data) {
+                  memcpy(glossy_payload.raw_data, rx_pkt, payload_len);
+                }
+                streams_to_update[i] = 
+                  lwb_in_buffer_put_aggr(glossy_payload.raw_data, payload_len,
+                                         schedule.slot[i], 1);
+              } else
+#endif /* LWB_CONF_DATA_AGGREGATION */
               {
-                streams_to_update[i] = glossy_payload.data_pkt.stream_id;
+                streams_to_update[i] = LWB_MSG_STREAM_ID(rx_pkt);
                 DEBUG_PRINT_VERBOSE("data received (s=%u.%u l=%u)", 
                                     schedule.slot[i], 
-                                    glossy_payload.data_pkt.stream_id, 
+                                    LWB_PKT_STREAM_ID(rx_pkt), 
                                     payload_len);
                 /* replace target node ID by sender node ID */
-                glossy_payload.data_pkt.recipient = schedule.slot[i];
-                lwb_in_buffer_put(glossy_payload.raw_data, 
-                                  payload_len);
+                LWB_PKT_SET_SENDER(rx_pkt, schedule.slot[i]);
+                lwb_in_buffer_commit(rx_pkt, payload_len);
               }
             } else {
               DEBUG_PRINT_VERBOSE("packet dropped, target_id != node_id");
             }
+#if LWB_CONF_DATA_ACK
+            /* only acknowledge the packet if no message was lost (the source
+             * retransmits it if the incoming queue is full) */
+            if(rxbuf_drop == stats.rxbuf_drop) {
+              dack_bitmap[i >> 3] |= (1 << (i & 0x07));
+            }
+#endif /* LWB_CONF_DATA_ACK */
             /* update statistics */
             stats.rx_total += payload_len;
             stats.pck_cnt++;
@@ -686,6 +1571,10 @@ PT_THREAD(lwb_thread_host(rtimer_t *rt))
                                 schedule.slot[i]);
           }
         }
+#if LWB_CONF_SCHED_PIPELINED
+        /* let the scheduler process this slot in the gap */
+        lwb_sched_proc_slot(&schedule, streams_to_update, i);
+#endif /* LWB_CONF_SCHED_PIPELINED */
       }
     }
     
@@ -693,7 +1582,7 @@ PT_THREAD(lwb_thread_host(rtimer_t *rt))
     
     if(LWB_SCHED_HAS_CONT_SLOT(&schedule)) {
       /* wait until the slot starts, then receive the packet */
-      LWB_WAIT_UNTIL(t_start + LWB_T_SLOT_START(slot_idx) - t_guard);
+      LWB_WAIT_UNTIL(t_start + t_slot - t_guard);
       LWB_RCV_SRQ();
       if(LWB_DATA_RCVD) {
         LWB_REQ_DETECTED;
@@ -707,13 +1596,23 @@ PT_THREAD(lwb_thread_host(rtimer_t *rt))
     }
 
     /* compute the new schedule */
+    t_sched2 = LWB_T_SCHED2_START(&schedule);   /* depends on this round */
     RTIMER_CAPTURE;
     schedule_len = lwb_sched_compute(&schedule, 
                                      streams_to_update, 
                                      lwb_get_send_buffer_state());
     stats.t_sched_max = MAX((uint16_t)RTIMER_ELAPSED, stats.t_sched_max);
+#if LWB_CONF_DATA_ACK
+    if(dack_n_slots) {
+      /* acknowledge the data slots of this round in the next round */
+      LWB_SCHED_SET_DACK_SLOT(&schedule);
+    }
+#endif /* LWB_CONF_DATA_ACK */
+#if LWB_CONF_SCHED_VAR_SLOTS
+    schedule_len = lwb_sched_put_slot_len(&schedule, schedule_len);
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
 
-    LWB_WAIT_UNTIL(t_start + LWB_CONF_T_SCHED2_START);
+    LWB_WAIT_UNTIL(t_start + t_sched2);
     LWB_SEND_SCHED();    /* send the schedule for the next round */
     
     /* --- COMMUNICATION ROUND ENDS --- */
@@ -766,6 +1665,7 @@ PT_THREAD(lwb_thread_src(rtimer_t *rt))
 {  
   /* all variables must be static */
   static glossy_payload_t glossy_payload;                   /* packet buffer */
+  static uint8_t* rx_pkt;                   /* buffer for received data pkts */
   static lwb_schedule_t schedule;
 #if !LWB_CONF_RELAY_ONLY
   static rtimer_clock_t t_now; 
@@ -780,17 +1680,28 @@ PT_THREAD(lwb_thread_src(rtimer_t *rt))
   static uint16_t period_last = LWB_CONF_SCHED_PERIOD_MIN;
 #endif /* LWB_CONF_TIME_SCALE == 1 */
   static uint32_t t_guard;                  /* 32-bit is enough for t_guard! */
-  static uint8_t  slot_idx;
+  static rtimer_clock_t t_slot;            /* offset of the next slot */
   static uint8_t  relay_cnt_first_rx;
 #if !LWB_CONF_RELAY_ONLY
   static uint8_t  payload_len;
   static uint8_t  rounds_to_wait;
 #endif /* LWB_CONF_RELAY_ONLY */
   static int8_t   glossy_snr = 0;
+#if LWB_STANDBY_HOST
+  static rtimer_clock_t standby_t_last;   /* t_ref of the last schedule */
+  static uint16_t       standby_period;   /* 0 = no schedule received yet */
+#endif /* LWB_STANDBY_HOST */
   static const void* callback_func = lwb_thread_src;
   
   PT_BEGIN(&lwb_pt);   /* declare variables before this statement! */
   
+#if LWB_STANDBY_HOST
+  if(node_id == LWB_CONF_STANDBY_HOST_ID) {
+    /* the scheduler mirrors the streams of the host */
+    lwb_sched_init(&schedule);
+    standby_period = 0;
+  }
+#endif /* LWB_STANDBY_HOST */
   memset(&schedule, 0, sizeof(schedule)); 
   
   /* initialization specific to the source node */
@@ -827,13 +1738,27 @@ BOOTSTRAP_MODE:
       /* synchronize first! wait for the first schedule... */
       do {
         LWB_RCV_SCHED();
+#if LWB_STANDBY_HOST
+        if(standby_period && (rtimer_now_hf() - standby_t_last) > 
+           (rtimer_clock_t)LWB_CONF_STANDBY_MAX_MISSED * standby_period *
+           RTIMER_SECOND_HF / LWB_CONF_TIME_SCALE) {
+          /* the host is silent: take over and continue its global time */
+          DEBUG_PRINT_MSG_NOW("no schedule for %u rounds, taking over as host",
+                              LWB_CONF_STANDBY_MAX_MISSED);
+          global_time += (rtimer_now_hf() - standby_t_last) * 
+                         LWB_CONF_TIME_SCALE / RTIMER_SECOND_HF + 1;
+          standby_active = 1;
+          lwb_resume();     /* start the host thread */
+          PT_EXIT(&lwb_pt);
+        }
+#endif /* LWB_STANDBY_HOST */
         if((rtimer_now_hf() - t_ref) > LWB_CONF_T_SILENT) {
           DEBUG_PRINT_MSG_NOW("communication timeout, going to sleep...");
           stats.sleep_cnt++;
           LWB_BEFORE_DEEPSLEEP();
           LWB_LF_WAIT_UNTIL(rtimer_now_lf() + LWB_CONF_T_DEEPSLEEP);
           t_ref = rtimer_now_hf();
-          /* alternative: implement a host failover policy */
+          /* see LWB_CONF_STANDBY_HOST_ID for a host failover policy */
         }
       } while(!glossy_is_t_ref_updated() || !LWB_SCHED_IS_1ST(&schedule));
       /* schedule received! */
@@ -841,6 +1766,11 @@ BOOTSTRAP_MODE:
       LWB_RCV_SCHED();  
     }
     glossy_snr = glossy_get_snr();
+#if LWB_CONF_SCHED_VAR_SLOTS
+    if(LWB_DATA_RCVD) {
+      lwb_sched_get_slot_len(&schedule, glossy_get_payload_len());
+    }
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
 
 #if LWB_CONF_USE_XMEM
     /* put the external memory back into active mode (takes ~500us) */
@@ -866,6 +1796,14 @@ BOOTSTRAP_MODE:
   #endif /* LWB_CONF_USE_LF_FOR_WAKEUP */
       global_time = schedule.time;
       rx_timestamp = t_ref;
+#if LWB_STANDBY_HOST
+      if(node_id == LWB_CONF_STANDBY_HOST_ID) {
+        /* follow the global time of the host */
+        lwb_sched_set_time(0, schedule.time);
+        standby_t_last = t_ref;
+        standby_period = schedule.period;
+      }
+#endif /* LWB_STANDBY_HOST */
     } else {
       DEBUG_PRINT_WARNING("schedule missed");
       /* we can only estimate t_ref and t_ref_lf */
@@ -887,19 +1825,45 @@ BOOTSTRAP_MODE:
     if(sync_state == SYNCED || sync_state == UNSYNCED) {
         
       static uint8_t i;  /* must be static */      
-      slot_idx = 0;   /* reset the packet counter */
+      t_slot = LWB_T_SLOT_FIRST;
       relay_cnt_first_rx = glossy_get_relay_cnt_first_rx();
 #if LWB_CONF_SCHED_COMPRESS
-      lwb_sched_uncompress((uint8_t*)schedule.slot, 
-                           LWB_SCHED_N_SLOTS(&schedule));
+      if(!lwb_sched_uncompress(&schedule)) {
+        /* e.g. a diff to a missed schedule: the slots are unknown (0), just
+         * relay the packets until the next full schedule */
+        DEBUG_PRINT_WARNING("failed to uncompress the schedule");
+      }
 #endif /* LWB_CONF_SCHED_COMPRESS */
       
+#if LWB_CONF_DATA_ACK
+      /* --- D-ACK SLOT --- */
+      
+      if(LWB_SCHED_HAS_DACK_SLOT(&schedule)) {
+        LWB_WAIT_UNTIL(t_ref + t_slot - t_guard);
+        LWB_RCV_PACKET(glossy_payload.raw_data, LWB_CONF_T_DACK);
+  #if !LWB_CONF_RELAY_ONLY
+        if(n_tx_slots) {
+          lwb_out_buffer_proc_dack(LWB_DATA_RCVD ? glossy_payload.raw_data : 0,
+                                   glossy_get_payload_len());
+        }
+  #endif /* LWB_CONF_RELAY_ONLY */
+        t_slot += LWB_CONF_T_DACK + LWB_CONF_T_GAP;
+      }
+  #if !LWB_CONF_RELAY_ONLY
+      else if(n_tx_slots) {
+        /* no acknowledgements, send the messages again */
+        lwb_out_buffer_proc_dack(0, 0);
+      }
+  #endif /* LWB_CONF_RELAY_ONLY */
+#endif /* LWB_CONF_DATA_ACK */
+      
       /* --- S-ACK SLOT --- */
 
       if(LWB_SCHED_HAS_SACK_SLOT(&schedule)) {   
         /* wait for the slot to start */
-        LWB_WAIT_UNTIL(t_ref + LWB_T_SLOT_START(0) - t_guard);     
-        LWB_RCV_PACKET();                 /* receive s-ack */
+        LWB_WAIT_UNTIL(t_ref + t_slot - t_guard);     
+        /* receive s-ack */
+        LWB_RCV_PACKET(glossy_payload.raw_data, LWB_CONF_T_DATA);
   #if !LWB_CONF_RELAY_ONLY
         if(LWB_DATA_RCVD) {
           static uint8_t i; /* must be static */
@@ -924,17 +1888,22 @@ BOOTSTRAP_MODE:
             } 
             i++;
           } while(i <= glossy_payload.sack_pkt.n_extra);
+    #if LWB_STANDBY_HOST
+          lwb_standby_proc_sack(glossy_payload.raw_data, 
+                                glossy_get_payload_len());
+    #endif /* LWB_STANDBY_HOST */
         } else {
           DEBUG_PRINT_VERBOSE("no data received in SACK SLOT");
         }
   #endif /* LWB_CONF_RELAY_ONLY */
-        slot_idx++;   /* increment the packet counter */
+        t_slot += LWB_CONF_T_DATA + LWB_CONF_T_GAP;
       }
       
       /* --- DATA SLOTS --- */
 
       if(LWB_SCHED_HAS_DATA_SLOT(&schedule)) {
-        for(i = 0; i < LWB_SCHED_N_SLOTS(&schedule); i++, slot_idx++) {
+        for(i = 0; i < LWB_SCHED_N_SLOTS(&schedule); 
+            t_slot += LWB_T_DATA(&schedule, i) + LWB_CONF_T_GAP, i++) {
   #if !LWB_CONF_RELAY_ONLY
           if(schedule.slot[i] == node_id) {
             stats.t_slot_last = schedule.time;
@@ -943,22 +1912,74 @@ BOOTSTRAP_MODE:
             /* is there an 'urgent' stream request? -> if so, piggyback it 
              * onto the data packet */
             if(urgent_stream_req) {
-              glossy_payload.data_pkt.recipient = LWB_RECIPIENT_SINK;
-              glossy_payload.data_pkt.stream_id = LWB_INVALID_STREAM_ID;
+              LWB_PKT_SET_HEADER(glossy_payload.raw_data, LWB_RECIPIENT_SINK,
+                                 LWB_INVALID_STREAM_ID);
               if(lwb_stream_prepare_req((lwb_stream_req_t*)
-                                        &glossy_payload.raw_data[3], 
+                                        (glossy_payload.raw_data + 
+                                         LWB_CONF_HEADER_LEN), 
                                         urgent_stream_req)) {
-                payload_len = sizeof(lwb_stream_req_t) + 3;
+                payload_len = sizeof(lwb_stream_req_t) + LWB_CONF_HEADER_LEN;
               }
               DEBUG_PRINT_VERBOSE("piggyback stream request prepared");
             } else {
               /* fetch the next 'ready-to-send' packet */
+  #if LWB_CONF_DATA_AGGREGATION
+              payload_len = lwb_out_buffer_get_aggr(glossy_payload.raw_data,
+                                                LWB_SLOT_PKT_LEN(&schedule, i) -
+                                                LWB_DATA_PKT_TRAILER_LEN);
+  #else /* LWB_CONF_DATA_AGGREGATION */
               payload_len = lwb_out_buffer_get(glossy_payload.raw_data);
+  #endif /* LWB_CONF_DATA_AGGREGATION */
+  #if LWB_CONF_SCHED_VAR_SLOTS
+              if(payload_len + LWB_DATA_PKT_TRAILER_LEN > 
+                 LWB_SLOT_PKT_LEN(&schedule, i)) {
+                /* e.g. the host has not yet processed the stream request with
+                 * a larger max. payload length (an aggregated packet always 
+                 * fits, i.e. this is a single message) */
+                DEBUG_PRINT_WARNING("packet too long for the data slot");
+    #if LWB_CONF_DATA_ACK
+                /* keep the message, it is sent again in one of the next 
+                 * data slots */
+                out_inflight[out_prio]--;
+    #else /* LWB_CONF_DATA_ACK */
+                stats.txbuf_drop++;   /* already removed from the queue */
+    #endif /* LWB_CONF_DATA_ACK */
+                payload_len = 0;
+              }
+  #endif /* LWB_CONF_SCHED_VAR_SLOTS */
+  #if LWB_CONF_DATA_ACK
+              if(payload_len) {
+                lwb_out_buffer_sent(i, schedule.time);
+              }
+  #endif /* LWB_CONF_DATA_ACK */
+  #if LWB_CONF_SCHED_BULK
+              /* advertise the backlog to get bulk slots */
+              payload_len = lwb_bulk_add_backlog(glossy_payload.raw_data, 
+                                                 payload_len,
+                                                 LWB_SLOT_PKT_LEN(&schedule, 
+                                                                  i) -
+                                                 LWB_DATA_PKT_TRAILER_LEN);
+  #endif /* LWB_CONF_SCHED_BULK */
+            }
+  #if LWB_CONF_DATA_QUEUE_DEPTH
+            if(payload_len) {
+              /* report the fill level of the outgoing queue to the host */
+              glossy_payload.raw_data[payload_len++] = 
+                lwb_get_send_buffer_state();
+            }
+  #endif /* LWB_CONF_DATA_QUEUE_DEPTH */
+  #if LWB_CONF_SCHED_VAR_SLOTS
+            if(payload_len > LWB_SLOT_PKT_LEN(&schedule, i)) {
+              /* a piggybacked stream request that doesn't fit into a short 
+               * data slot, it is sent again in the next data slot */
+              DEBUG_PRINT_WARNING("packet too long for the data slot");
+              payload_len = 0;
             }
+  #endif /* LWB_CONF_SCHED_VAR_SLOTS */
             if(payload_len) {
               LWB_DATA_IND;
-              LWB_WAIT_UNTIL(t_ref + LWB_T_SLOT_START(slot_idx));
-              LWB_SEND_PACKET();
+              LWB_WAIT_UNTIL(t_ref + t_slot);
+              LWB_SEND_PACKET(LWB_T_DATA(&schedule, i));
               DEBUG_PRINT_INFO("data packet sent (%ub)", payload_len);
             } else {              
               DEBUG_PRINT_VERBOSE("no message to send (data slot ignored)");
@@ -967,23 +1988,54 @@ BOOTSTRAP_MODE:
   #endif /* LWB_CONF_RELAY_ONLY */
           {
             /* receive a data packet */
-            LWB_WAIT_UNTIL(t_ref + LWB_T_SLOT_START(slot_idx) - 
-                           t_guard);
-            LWB_RCV_PACKET();
+            LWB_WAIT_UNTIL(t_ref + t_slot - t_guard);
+  #if !LWB_CONF_RELAY_ONLY
+            rx_pkt = lwb_in_buffer_reserve(glossy_payload.raw_data);
+  #else /* LWB_CONF_RELAY_ONLY */
+            rx_pkt = glossy_payload.raw_data;
+  #endif /* LWB_CONF_RELAY_ONLY */
+            LWB_RCV_PACKET(rx_pkt, LWB_T_DATA(&schedule, i));
             payload_len = glossy_get_payload_len();
   #if !LWB_CONF_RELAY_ONLY
             /* process the received data */
             if(LWB_DATA_RCVD && payload_len) {
               /* measure the time it takes to process the received data */
               RTIMER_CAPTURE;     
+  #if LWB_CONF_DATA_QUEUE_DEPTH
+              if(payload_len > LWB_CONF_HEADER_LEN) {
+                payload_len--;      /* fill level of the sender's queue */
+              }
+  #endif /* LWB_CONF_DATA_QUEUE_DEPTH */
+  #if LWB_CONF_SCHED_BULK
+              if(LWB_IS_BULK_PKT(rx_pkt, payload_len)) {
+                lwb_bulk_strip_backlog(rx_pkt, &payload_len);
+              }
+  #endif /* LWB_CONF_SCHED_BULK */
+  #if LWB_STANDBY_HOST
+              if(LWB_INVALID_STREAM_ID == LWB_PKT_STREAM_ID(rx_pkt)) {
+                /* piggybacked stream request */
+                lwb_standby_put_srq(rx_pkt + LWB_CONF_HEADER_LEN);
+              }
+  #endif /* LWB_STANDBY_HOST */
+  #if LWB_CONF_DATA_AGGREGATION
+              if(LWB_AGGR_STREAM_ID == LWB_PKT_STREAM_ID(rx_pkt)) {
+                DEBUG_PRINT_VERBOSE("aggregated data received");
+                /* the messages are unpacked into the incoming queue */
+                if(rx_pkt != glossy_payload.raw_data) {
+                  memcpy(glossy_payload.raw_data, rx_pkt, payload_len);
+                }
+                lwb_in_buffer_put_aggr(glossy_payload.raw_data, payload_len,
+                                       schedule.slot[i], 0);
+              } else
+  #endif /* LWB_CONF_DATA_AGGREGATION */
               /* only forward packets that are destined for this node */
-              if(glossy_payload.data_pkt.recipient == node_id || 
-                glossy_payload.data_pkt.recipient == LWB_RECIPIENT_BROADCAST) {
+              if(LWB_PKT_RECIPIENT(rx_pkt, schedule.slot[i]) == node_id || 
+                LWB_PKT_RECIPIENT(rx_pkt, schedule.slot[i]) == 
+                LWB_RECIPIENT_BROADCAST) {
                 DEBUG_PRINT_VERBOSE("data received");
                 /* replace target node ID by sender node ID */
-                glossy_payload.data_pkt.recipient = schedule.slot[i];
-                lwb_in_buffer_put(glossy_payload.raw_data, 
-                                  payload_len);
+                LWB_PKT_SET_SENDER(rx_pkt, schedule.slot[i]);
+                lwb_in_buffer_commit(rx_pkt, payload_len);
               } else {
                 DEBUG_PRINT_VERBOSE("received packet dropped");      
               }
@@ -1017,7 +2069,7 @@ BOOTSTRAP_MODE:
               payload_len = sizeof(lwb_stream_req_t);
               /* wait until the contention slot starts */
               LWB_REQ_IND;
-              LWB_WAIT_UNTIL(t_ref + LWB_T_SLOT_START(slot_idx));
+              LWB_WAIT_UNTIL(t_ref + t_slot);
               LWB_SEND_SRQ();  
               DEBUG_PRINT_INFO("request for stream %u sent", 
                                glossy_payload.srq_pkt.stream_id);
@@ -1029,16 +2081,26 @@ BOOTSTRAP_MODE:
             /* keep waiting and just relay incoming packets */
             rounds_to_wait--;       /* decrease the number of rounds to wait */
             /* wait until the contention slot starts */
-            LWB_WAIT_UNTIL(t_ref + LWB_T_SLOT_START(slot_idx) - t_guard);  
+            LWB_WAIT_UNTIL(t_ref + t_slot - t_guard);  
             LWB_RCV_SRQ();
+      #if LWB_STANDBY_HOST
+            if(LWB_DATA_RCVD) {
+              lwb_standby_put_srq(glossy_payload.raw_data);
+            }
+      #endif /* LWB_STANDBY_HOST */
           }
           DEBUG_PRINT_VERBOSE("pending stream requests: 0x%x", 
                               LWB_STREAM_REQ_PENDING);
         } else {
   #endif /* LWB_CONF_RELAY_ONLY */
           /* no request pending -> just receive / relay packets */
-          LWB_WAIT_UNTIL(t_ref + LWB_T_SLOT_START(slot_idx) - t_guard);
+          LWB_WAIT_UNTIL(t_ref + t_slot - t_guard);
           LWB_RCV_SRQ();
+  #if LWB_STANDBY_HOST
+          if(LWB_DATA_RCVD) {
+            lwb_standby_put_srq(glossy_payload.raw_data);
+          }
+  #endif /* LWB_STANDBY_HOST */
                   
   #if !LWB_CONF_RELAY_ONLY
         }
@@ -1048,8 +2110,13 @@ BOOTSTRAP_MODE:
     
     /* --- 2ND SCHEDULE --- */
 
-    LWB_WAIT_UNTIL(t_ref + LWB_CONF_T_SCHED2_START - t_guard);
+    LWB_WAIT_UNTIL(t_ref + LWB_T_SCHED2_START(&schedule) - t_guard);
     LWB_RCV_SCHED();
+#if LWB_CONF_SCHED_VAR_SLOTS
+    if(LWB_DATA_RCVD) {
+      lwb_sched_get_slot_len(&schedule, glossy_get_payload_len());
+    }
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
   
     /* update the state machine and the guard time */
     LWB_UPDATE_SYNC_STATE;
@@ -1167,7 +2234,7 @@ lwb_resume(void)
   rtimer_id_t timer_id = LWB_CONF_RTIMER_ID;
 #endif /* LWB_CONF_USE_LF_FOR_WAKEUP */
     
-  if(node_id == HOST_ID) {
+  if(LWB_IS_HOST) {
     /* note: must add at least some clock ticks! */
     rtimer_schedule(timer_id, start_time, 0, lwb_thread_host);
   } else {
@@ -1189,15 +2256,20 @@ PROCESS_THREAD(lwb_process, ev, data)
   
 #if !LWB_CONF_RELAY_ONLY
  #if !LWB_CONF_USE_XMEM
-  /* pass the start addresses of the memory blocks holding the queues */
-  fifo_init(&in_buffer, (uint16_t)in_buffer_mem);
-  fifo_init(&out_buffer, (uint16_t)out_buffer_mem); 
+  /* the queues in the SRAM deliver offsets into the memory blocks (rather 
+   * than absolute addresses, which may not fit into 32 bits on a host) */
+  LWB_QUEUE_INIT(&in_buffer, 0);
+  for(out_prio = 0; out_prio < LWB_CONF_OUT_N_PRIO; out_prio++) {
+    LWB_OUT_QUEUE_INIT(&out_buffer[out_prio], 
+                       out_prio * LWB_OUT_QUEUE_MEM_SIZE);
+  }
  #else  /* LWB_CONF_USE_XMEM */
   /* allocate memory for the message buffering (in ext. memory) */
-  fifo_init(&in_buffer, xmem_alloc(LWB_CONF_IN_BUFFER_SIZE * 
-                                   (LWB_CONF_MAX_DATA_PKT_LEN + 1)));
-  fifo_init(&out_buffer, xmem_alloc(LWB_CONF_OUT_BUFFER_SIZE * 
-                                    (LWB_CONF_MAX_DATA_PKT_LEN + 1)));   
+  LWB_QUEUE_INIT(&in_buffer, xmem_alloc(LWB_IN_BUFFER_MEM_SIZE));
+  for(out_prio = 0; out_prio < LWB_CONF_OUT_N_PRIO; out_prio++) {
+    LWB_OUT_QUEUE_INIT(&out_buffer[out_prio], 
+                       xmem_alloc(LWB_OUT_QUEUE_MEM_SIZE));
+  }
  #endif /* LWB_CONF_USE_XMEM */
 #endif /* LWB_CONF_RELAY_ONLY */
   
@@ -1234,9 +2306,11 @@ lwb_start(void (*pre_lwb_func)(void), void *post_lwb_proc)
   if((LWB_CONF_T_SCHED2_START > RTIMER_SECOND_HF / LWB_CONF_TIME_SCALE)) {
     printf("WARNING: LWB_CONF_T_SCHED2_START > 1s\r\n");
   }
+#if !LWB_CONF_SCHED_PIPELINED
   if(LWB_CONF_T_SCHED2_START < LWB_T_ROUND_MAX) {
     printf("WARNING: LWB_CONF_T_SCHED2_START < LWB_T_ROUND_MAX!");
   }
+#endif /* LWB_CONF_SCHED_PIPELINED */
   process_start(&lwb_process, NULL);
 }
 /*---------------------------------------------------------------------------*/
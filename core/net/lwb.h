@@ -56,6 +56,10 @@
 #define HOST_ID                         0
 #endif
 
+/* version 2 uses a compact data packet header (stream ID only) and a 
+ * simplified API: the sender of a message is the owner of the data slot, the
+ * messages of the host are for all nodes and all other messages for the host 
+ * and the sinks; a source node sends all messages on its first stream */
 #ifndef LWB_VERSION
 #define LWB_VERSION     1       /* default version */
 #endif /* LWB_VERSION */
@@ -67,7 +71,8 @@
  * determines T_Slot (LWB_CONF_T_DATA) and influences the power dissipation, 
  * choose as small as possible; must be <= (LWB_CONF_MAX_PKT_LEN - 5) 
  * NOTE: LWB_CONF_MAX_DATA_PKT_LEN must not exceed LWB_CONF_MAX_PKT_LEN
- * and the max. data payload length is LWB_CONF_MAX_DATA_PKT_LEN - 3 */
+ * and the max. data payload length is LWB_CONF_MAX_DATA_PKT_LEN - 
+ * LWB_CONF_HEADER_LEN */
 #define LWB_CONF_MAX_DATA_PKT_LEN       LWB_CONF_MAX_PKT_LEN
 #endif /* LWB_CONF_MAX_DATA_PKT_LEN */
 
@@ -83,7 +88,11 @@
 #endif /* LWB_CONF_MAX_DATA_SLOTS */
 
 #ifndef LWB_CONF_HEADER_LEN
+#if LWB_VERSION == 2
+#define LWB_CONF_HEADER_LEN             1       /* stream ID */
+#else /* LWB_VERSION */
 #define LWB_CONF_HEADER_LEN             3       /* default header size */
+#endif /* LWB_VERSION */
 #endif /* LWB_CONF_HEADER_LEN */
 
 /* set to 1 to skip the state QUASI_SYNCED and jump directly to SYNCED after 
@@ -145,6 +154,46 @@
 #define LWB_CONF_T_DATA               LWB_T_SLOT_MIN(LWB_CONF_MAX_DATA_PKT_LEN)
 #endif /* LWB_CONF_T_DATA */
 
+#ifndef LWB_CONF_SCHED_VAR_SLOTS
+/* variable-length data slots: each stream request declares the max. payload
+ * length of the stream (max_len in lwb_stream_req_t), the host assigns one of
+ * LWB_SLOT_N_CLASSES length classes to each data slot (see 
+ * LWB_SLOT_CLASS_PKT_LEN) and the slots are only as long as needed for the
+ * largest packet of the node; must be the same on all nodes */
+#define LWB_CONF_SCHED_VAR_SLOTS        0
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+
+#ifndef LWB_CONF_DATA_AGGREGATION
+/* packet aggregation: pack as many queued messages of the same stream as fit
+ * into one data slot (each message keeps its own recipient/stream header);
+ * the stream ID LWB_AGGR_STREAM_ID is reserved to mark aggregated packets;
+ * must be the same on all nodes */
+#define LWB_CONF_DATA_AGGREGATION       0
+#endif /* LWB_CONF_DATA_AGGREGATION */
+
+#ifndef LWB_CONF_RX_ZERO_COPY
+/* receive data packets directly into the next free element of the incoming
+ * queue (saves one copy per packet); each element is then 
+ * LWB_CONF_MAX_PKT_LEN + 1 bytes long; has no effect if LWB_CONF_USE_XMEM is
+ * enabled */
+#define LWB_CONF_RX_ZERO_COPY           0
+#endif /* LWB_CONF_RX_ZERO_COPY */
+
+#ifndef LWB_CONF_QUEUE_VAR_LEN
+/* store the messages in the incoming and outgoing queue as variable-size 
+ * records (see rbuf.h) instead of elements of the max. message size: the
+ * queues take the same amount of memory (LWB_CONF_IN_BUFFER_SIZE and 
+ * LWB_CONF_OUT_BUFFER_SIZE messages of max. size), but can hold many more
+ * short messages */
+#define LWB_CONF_QUEUE_VAR_LEN          0
+#endif /* LWB_CONF_QUEUE_VAR_LEN */
+
+#ifndef LWB_CONF_T_DACK
+/* length of the D-ACK slot (if LWB_CONF_DATA_ACK is enabled) */
+#define LWB_CONF_T_DACK                 LWB_T_SLOT_MIN(LWB_DACK_PKT_LEN( \
+                                                     LWB_CONF_MAX_DATA_SLOTS))
+#endif /* LWB_CONF_T_DACK */
+
 #ifndef LWB_CONF_T_CONT
 /* length of a contention slot */
 #define LWB_CONF_T_CONT                 (RTIMER_SECOND_HF / 125)
@@ -186,6 +235,24 @@
 #define LWB_CONF_OUT_BUFFER_SIZE        3
 #endif /* LWB_CONF_IN_BUFFER_SIZE */
 
+#ifndef LWB_CONF_OUT_N_PRIO
+/* number of priority classes of the outgoing messages (max. 8), each class
+ * has its own queue of LWB_CONF_OUT_BUFFER_SIZE elements and the messages
+ * of the highest class (0) are sent first */
+#define LWB_CONF_OUT_N_PRIO             1
+#endif /* LWB_CONF_OUT_N_PRIO */
+
+#ifndef LWB_CONF_OUT_PRIO_DROP_OLDEST
+/* drop policy per priority class (bit i = class i): if the bit is set, the 
+ * oldest message in the queue is dropped to make room for a new message,
+ * otherwise the new message is rejected */
+#define LWB_CONF_OUT_PRIO_DROP_OLDEST   0
+#endif /* LWB_CONF_OUT_PRIO_DROP_OLDEST */
+
+#if !LWB_CONF_OUT_N_PRIO || LWB_CONF_OUT_N_PRIO > 8
+#error "invalid value for LWB_CONF_OUT_N_PRIO"
+#endif
+
 /* ensure that the buffer can at least hold one data packet */
 #if !LWB_CONF_IN_BUFFER_SIZE || !LWB_CONF_OUT_BUFFER_SIZE
 #error "invalid LWB buffer size configuration!"
@@ -243,6 +310,22 @@
 #define LWB_CONF_T_SCHED2_START         LWB_T_ROUND_MAX
 #endif /* LWB_CONF_T_SCHED2_START */
 
+#ifndef LWB_CONF_SCHED_PIPELINED
+/* process the data slots incrementally on the host (in the gap after each 
+ * slot, see lwb_sched_proc_slot) and send the 2nd schedule right after the
+ * contention slot instead of at LWB_CONF_T_SCHED2_START; rounds with fewer
+ * than LWB_CONF_MAX_DATA_SLOTS slots end earlier; must be the same on all 
+ * nodes */
+#define LWB_CONF_SCHED_PIPELINED        0
+#endif /* LWB_CONF_SCHED_PIPELINED */
+
+#ifndef LWB_CONF_T_SCHED2_GAP
+/* additional time for lwb_sched_compute between the end of the last slot and
+ * the 2nd schedule if LWB_CONF_SCHED_PIPELINED is enabled (in addition to
+ * LWB_CONF_T_GAP) */
+#define LWB_CONF_T_SCHED2_GAP           0
+#endif /* LWB_CONF_T_SCHED2_GAP */
+
 #ifndef LWB_CONF_T_PREPROCESS
 /* in milliseconds, set this to 0 to disable preprocessing before a LWB round*/
 #define LWB_CONF_T_PREPROCESS           0
@@ -285,9 +368,72 @@
 #endif /* LWB_CONF_MAX_CONT_BACKOFF */
 
 #ifndef LWB_CONF_DATA_ACK
+/* data acknowledgements: the host floods a bitmap of the data slots it 
+ * received in the D-ACK slot at the beginning of the next round, sources 
+ * keep the sent messages in the outgoing queue until they are acknowledged 
+ * and retransmit the others in their next data slot; must be the same on all
+ * nodes */
 #define LWB_CONF_DATA_ACK               0
 #endif /* LWB_CONF_DATA_ACK */
 
+#ifndef LWB_CONF_STANDBY_HOST_ID
+/* node ID of the standby host (0 = no standby host): this source node feeds
+ * the stream requests acknowledged by the host into its own scheduler and 
+ * follows the global time of the schedules; if it does not receive a schedule
+ * for LWB_CONF_STANDBY_MAX_MISSED rounds, it takes over the role of the host;
+ * not supported with LWB_VERSION 2 */
+#define LWB_CONF_STANDBY_HOST_ID        0
+#endif /* LWB_CONF_STANDBY_HOST_ID */
+
+#ifndef LWB_CONF_STANDBY_MAX_MISSED
+/* number of rounds without a schedule after which the standby host takes 
+ * over; the check is done in bootstrap mode, i.e. after 2 rounds at the 
+ * earliest, and must be shorter than LWB_CONF_T_SILENT */
+#define LWB_CONF_STANDBY_MAX_MISSED     3
+#endif /* LWB_CONF_STANDBY_MAX_MISSED */
+
+#ifndef LWB_CONF_STANDBY_SRQ_BUFFER_SIZE
+/* number of overheard stream requests the standby host keeps until they are
+ * acknowledged by the host */
+#define LWB_CONF_STANDBY_SRQ_BUFFER_SIZE  8
+#endif /* LWB_CONF_STANDBY_SRQ_BUFFER_SIZE */
+
+#ifndef LWB_CONF_FRAG
+/* enables lwb_send_msg() and lwb_rcv_msg() for messages that are longer than
+ * one data packet (see frag.h), requires LWB_VERSION 1 */
+#define LWB_CONF_FRAG                   0
+#endif /* LWB_CONF_FRAG */
+
+#ifndef LWB_CONF_FRAG_MAX_MSG_LEN
+/* max. length of a fragmented message in bytes (max. 32 fragments) */
+#define LWB_CONF_FRAG_MAX_MSG_LEN       512
+#endif /* LWB_CONF_FRAG_MAX_MSG_LEN */
+
+#ifndef LWB_CONF_FRAG_N_BUFFERS
+/* number of messages that can be reassembled at the same time; memory usage:
+ * LWB_CONF_FRAG_MAX_MSG_LEN bytes per buffer (in the external memory if 
+ * LWB_CONF_USE_XMEM is enabled) */
+#define LWB_CONF_FRAG_N_BUFFERS         2
+#endif /* LWB_CONF_FRAG_N_BUFFERS */
+
+#ifndef LWB_CONF_FRAG_TIMEOUT
+/* an incomplete message is dropped if none of its fragments was received for
+ * this number of seconds */
+#define LWB_CONF_FRAG_TIMEOUT           60
+#endif /* LWB_CONF_FRAG_TIMEOUT */
+
+#ifndef LWB_CONF_DATA_QUEUE_DEPTH
+/* append the number of messages in the outgoing queue of the sender to each
+ * data packet (1 byte); the host passes it to the scheduler, which assigns 
+ * additional data slots to the nodes whose queue is filling up (see 
+ * LWB_CONF_SCHED_QUEUE_DEPTH_THRES) */
+#define LWB_CONF_DATA_QUEUE_DEPTH       0
+#endif /* LWB_CONF_DATA_QUEUE_DEPTH */
+
+/* number of bytes appended to each data packet in the data slot (not stored
+ * in the queues), reduces the max. payload length */
+#define LWB_DATA_PKT_TRAILER_LEN        (LWB_CONF_DATA_QUEUE_DEPTH ? 1 : 0)
+
 /*---------------------------------------------------------------------------*/
 
 #ifndef RF_CONF_TX_POWER                /* set the radio antenna gain */
@@ -319,12 +465,17 @@
 
 /* important values, do not modify */
 
-#define LWB_T_ROUND_MAX             ((LWB_CONF_MAX_DATA_SLOTS + 1 + \
-                                      LWB_CONF_DATA_ACK) * \
+#define LWB_T_ROUND_MAX             ((LWB_CONF_MAX_DATA_SLOTS + 1) * \
                                      (LWB_CONF_T_DATA + LWB_CONF_T_GAP) + \
+                                     LWB_CONF_DATA_ACK * \
+                                     (LWB_CONF_T_DACK + LWB_CONF_T_GAP) + \
                                      (LWB_CONF_T_SCHED + LWB_CONF_T_GAP) + \
                                      (LWB_CONF_T_CONT + LWB_CONF_T_GAP))
 
+/* length of a D-ACK packet: the lower 16 bits of the time of the acknowledged
+ * round followed by one bit per data slot of that round */
+#define LWB_DACK_PKT_LEN(n_slots)   (2 + ((n_slots) + 7) / 8)
+
 /* min. duration of 1 packet transmission with glossy (approx. values, taken 
  * from TelosB platform measurements) -> for 127b packets ~4.5ms, for 50b 
  * packets just over 2ms */
@@ -338,6 +489,19 @@
 #define LWB_T_SLOT_MIN(len)         ((LWB_CONF_MAX_HOPS + \
                                      (2 * LWB_CONF_TX_CNT_DATA) - 2) * \
                                      LWB_T_HOP(len))
+
+/* length classes of the data slots if LWB_CONF_SCHED_VAR_SLOTS is enabled:
+ * a slot of class c holds packets of up to LWB_SLOT_CLASS_PKT_LEN(c) bytes 
+ * (at least a piggybacked stream request), a slot of the last class is a 
+ * regular data slot of length LWB_CONF_T_DATA */
+#define LWB_SLOT_N_CLASSES          4
+#define LWB_SLOT_CLASS_PKT_LEN(c)   MAX(LWB_CONF_MAX_DATA_PKT_LEN >> \
+                                        (LWB_SLOT_N_CLASSES - 1 - (c)), \
+                                        LWB_CONF_HEADER_LEN + \
+                                        sizeof(lwb_stream_req_t))
+#define LWB_T_DATA_CLASS(c)         (((c) == LWB_SLOT_N_CLASSES - 1) ? \
+                                     LWB_CONF_T_DATA : \
+                                     LWB_T_SLOT_MIN(LWB_SLOT_CLASS_PKT_LEN(c)))
                                                                          
 #define LWB_RECIPIENT_SINK          0x0000  /* to all sinks and the host */
 #define LWB_RECIPIENT_BROADCAST     0xffff  /* to all nodes / sinks */
@@ -345,6 +509,11 @@
 #define LWB_RECIPIENT_GROUP_MASK    0xf000  /* group ID mask */
 #define LWB_RECIPIENT_NODE_MASK     0x0fff  /* node ID mask */
 
+/* priority classes of the outgoing messages, see lwb_send_pkt_prio() */
+#define LWB_PRIO_HIGHEST            0
+#define LWB_PRIO_LOWEST             (LWB_CONF_OUT_N_PRIO - 1)
+#define LWB_PRIO_STREAM             0xff    /* use the class of the stream */
+
 /*---------------------------------------------------------------------------*/
 
 #define MAX(x, y)                   ((x) > (y) ? (x) : (y))
@@ -389,6 +558,7 @@ typedef enum {
 
 #include "scheduler.h"
 #include "stream.h"
+#include "frag.h"
 
 
 /**
@@ -420,6 +590,13 @@ void lwb_resume(void);
  */
 lwb_conn_state_t lwb_get_state(void);
 
+/**
+ * @brief check whether this node acts as the host
+ * @return 1 if this node is the host or a standby host that has taken over
+ * (see LWB_CONF_STANDBY_HOST_ID), 0 otherwise
+ */
+uint8_t lwb_is_host(void);
+
 /**
  * @brief schedule a packet for transmission over the LWB
  * @param data a pointer to the data packet to send
@@ -435,6 +612,31 @@ uint8_t lwb_send_pkt(uint16_t recipient,
                      uint8_t stream_id, 
                      const uint8_t * const data, 
                      uint8_t len);
+
+/**
+ * @brief schedule a packet for transmission with a specific priority
+ * @param prio the priority class (0 = highest, LWB_PRIO_LOWEST) or 
+ * LWB_PRIO_STREAM to use the class of the stream (see lwb_stream_set_prio),
+ * lwb_send_pkt() uses LWB_PRIO_STREAM
+ * @return 1 if successful, 0 otherwise (queue full)
+ * @note the packets are sent in the order of their priority class, i.e. the
+ * order of packets from different classes may change
+ */
+uint8_t lwb_send_pkt_prio(uint16_t recipient,
+                          uint8_t stream_id, 
+                          const uint8_t * const data, 
+                          uint8_t len,
+                          uint8_t prio);
+
+/**
+ * @brief check whether several packets fit into the send buffer
+ * @param prio the priority class (0 = highest, LWB_PRIO_LOWEST)
+ * @param n the number of packets
+ * @param len the payload length of each packet
+ * @return 1 if all n packets can be scheduled with lwb_send_pkt_prio() 
+ * without removing one of them again, 0 otherwise
+ */
+uint8_t lwb_send_buffer_fits(uint8_t prio, uint16_t n, uint8_t len);
 #endif
 
 /** 
@@ -448,7 +650,7 @@ uint8_t lwb_send_pkt(uint16_t recipient,
  * interested in this data)
  * @return the length of the data packet in bytes or 0 if the queue is empty
  * @note once a data packet was requested, it will be removed from the internal
- * buffer
+ * buffer; with LWB_VERSION 2, the sender and the stream ID are not available
  */
 #if LWB_VERSION == 2
 uint8_t lwb_rcv_pkt(uint8_t* out_data);
@@ -458,6 +660,33 @@ uint8_t lwb_rcv_pkt(uint8_t* out_data,
                      uint8_t * const out_stream_id);
 #endif
 
+/**
+ * @brief get the oldest received message without copying it or removing it
+ * from the queue
+ * @param out_len the payload length in bytes (optional parameter, pass 0 if
+ * not interested in this data)
+ * @param out_node_id the ID of the node that sent the message (optional 
+ * parameter)
+ * @param out_stream_id the stream ID (optional parameter)
+ * @return a pointer to the payload or 0 if the queue is empty
+ * @note the pointer is valid until lwb_rcv_pkt_consume() is called; with
+ * LWB_CONF_USE_XMEM, the message is fetched into an internal buffer that is
+ * also used by the other queue functions
+ */
+#if LWB_VERSION == 2
+const uint8_t* lwb_rcv_pkt_peek(uint8_t * const out_len);
+#else
+const uint8_t* lwb_rcv_pkt_peek(uint8_t * const out_len,
+                                uint16_t * const out_node_id, 
+                                uint8_t * const out_stream_id);
+#endif
+
+/**
+ * @brief remove the oldest received message from the queue (call this after
+ * lwb_rcv_pkt_peek() once the message has been processed)
+ */
+void lwb_rcv_pkt_consume(void);
+
 /**
  * @brief check the status of the receive buffer (incoming messages)
  * @return the number of packets in the queue
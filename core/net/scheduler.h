@@ -61,6 +61,31 @@
 #define LWB_CONF_SCHED_COMPRESS              1
 #endif /* LWB_CONF_SCHED_COMPRESS */
 
+#ifndef LWB_CONF_SCHED_COMPRESS_ENC
+/* bit mask of the encodings the host may choose from to compress the 
+ * schedule (bit i = encoding LWB_SCHED_ENC_x with value i, the raw encoding is
+ * always available); the sources must support the same encodings */
+#define LWB_CONF_SCHED_COMPRESS_ENC          0x0f
+#endif /* LWB_CONF_SCHED_COMPRESS_ENC */
+
+#ifndef LWB_CONF_SCHED_DIFF
+/* send only the insertions and removals of slots w.r.t. the schedule of the
+ * last round if this is shorter than the compressed schedule; a node that 
+ * missed the last schedule waits for the next full schedule (keyframe); 
+ * must be the same on all nodes */
+#define LWB_CONF_SCHED_DIFF                  0
+#endif /* LWB_CONF_SCHED_DIFF */
+
+#ifndef LWB_CONF_SCHED_KEYFRAME_INTERVAL
+/* a full schedule (keyframe) is sent after at most this many differential 
+ * schedules */
+#define LWB_CONF_SCHED_KEYFRAME_INTERVAL     8
+#endif /* LWB_CONF_SCHED_KEYFRAME_INTERVAL */
+
+#if LWB_CONF_SCHED_DIFF && !LWB_CONF_SCHED_COMPRESS
+#error "LWB_CONF_SCHED_DIFF requires LWB_CONF_SCHED_COMPRESS"
+#endif
+
 /* --- defines for the HOST --- */
 
 #ifndef LWB_CONF_SCHED_SACK_BUFFER_SIZE
@@ -75,6 +100,44 @@
 #define LWB_CONF_SCHED_USE_XMEM              0       
 #endif /* LWB_CONF_SCHED_USE_XMEM */
 
+#ifndef LWB_CONF_SCHED_XMEM_CACHE_SIZE
+/* number of stream info structures kept in a write-back cache in SRAM if 
+ * LWB_CONF_SCHED_USE_XMEM is enabled (the changes are written back to the 
+ * external memory once per round); the external memory is not accessed at 
+ * all if the cache is at least as big as the number of streams; must be a 
+ * power of 2, 0 disables the cache; memory usage: approx. 20 bytes per 
+ * entry */
+#define LWB_CONF_SCHED_XMEM_CACHE_SIZE       16
+#endif /* LWB_CONF_SCHED_XMEM_CACHE_SIZE */
+
+#if LWB_CONF_SCHED_XMEM_CACHE_SIZE & (LWB_CONF_SCHED_XMEM_CACHE_SIZE - 1)
+#error "LWB_CONF_SCHED_XMEM_CACHE_SIZE must be a power of 2"
+#endif
+
+#ifndef LWB_CONF_SCHED_HASH_INDEX
+/* keep a hash index of the streams (key: node ID and stream ID) on the host
+ * to find a stream in constant time, e.g. when processing a stream request;
+ * recommended for a large LWB_CONF_MAX_N_STREAMS; memory usage: 6 bytes per
+ * entry, the index has at least 2x LWB_CONF_MAX_N_STREAMS entries */
+#define LWB_CONF_SCHED_HASH_INDEX            0
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+
+#ifndef LWB_CONF_SCHED_STREAM_ARRAYS
+/* store the stream information in parallel arrays sorted by node ID instead
+ * of a linked list (faster iteration, binary search for stream requests);
+ * only supported if the stream information is kept in SRAM */
+#define LWB_CONF_SCHED_STREAM_ARRAYS         0
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
+
+#if LWB_CONF_SCHED_STREAM_ARRAYS && LWB_CONF_SCHED_USE_XMEM
+#error "LWB_CONF_SCHED_STREAM_ARRAYS requires LWB_CONF_SCHED_USE_XMEM = 0"
+#endif
+#if LWB_CONF_SCHED_STREAM_ARRAYS && LWB_CONF_SCHED_HASH_INDEX
+/* the stream arrays are searched with a binary search, the hash index would
+ * have to be updated each time the arrays are shifted */
+#error "LWB_CONF_SCHED_HASH_INDEX not supported with stream arrays"
+#endif
+
 /* SCHEDULER */
 
 #ifndef LWB_CONF_SCHED_PERIOD_MAX
@@ -98,9 +161,55 @@
 #define LWB_CONF_SCHED_STREAM_REMOVAL_THRES  10      
 #endif /* LWB_CONF_SCHED_STREAM_REMOVAL_THRES */
 
+#ifndef LWB_CONF_SCHED_BURST
+/* burst streams: a stream request may ask for several consecutive data slots
+ * per IPI (see LWB_STREAM_REQ_SET_BURST), e.g. to transfer all fragments of a
+ * message in one round (see lwb_send_msg); static scheduler only */
+#define LWB_CONF_SCHED_BURST                 0
+#endif /* LWB_CONF_SCHED_BURST */
+
+#if LWB_CONF_SCHED_BURST && !defined(LWB_SCHED_STATIC)
+#error "LWB_CONF_SCHED_BURST is only supported by the static scheduler"
+#endif
+
+#ifndef LWB_CONF_SCHED_BULK
+/* bulk transfers: the sources piggyback their backlog (number of queued 
+ * messages) on the data packets and the host temporarily assigns the spare
+ * data slots of a round in proportion to the backlog until it is drained;
+ * static scheduler only */
+#define LWB_CONF_SCHED_BULK                  0
+#endif /* LWB_CONF_SCHED_BULK */
+
+#ifndef LWB_CONF_SCHED_BULK_THRES
+/* a source advertises its backlog if its outgoing queue holds at least this
+ * number of messages */
+#define LWB_CONF_SCHED_BULK_THRES            2
+#endif /* LWB_CONF_SCHED_BULK_THRES */
+
+#if LWB_CONF_SCHED_BULK && !defined(LWB_SCHED_STATIC)
+#error "LWB_CONF_SCHED_BULK is only supported by the static scheduler"
+#endif
+
+#ifndef LWB_CONF_SCHED_QUEUE_DEPTH_THRES
+/* a node gets additional data slots if it reports at least this number of
+ * messages in its outgoing queue (see LWB_CONF_DATA_QUEUE_DEPTH) */
+#define LWB_CONF_SCHED_QUEUE_DEPTH_THRES     ((LWB_CONF_OUT_BUFFER_SIZE + 1) / 2)
+#endif /* LWB_CONF_SCHED_QUEUE_DEPTH_THRES */
+
+#ifndef LWB_CONF_SCHED_QUEUE_DEPTH_N_NODES
+/* max. number of nodes with a filling queue the host keeps track of */
+#define LWB_CONF_SCHED_QUEUE_DEPTH_N_NODES   8
+#endif /* LWB_CONF_SCHED_QUEUE_DEPTH_N_NODES */
+
 /* define the stream extra data length based on the selected scheduler */
 #ifdef LWB_SCHED_MIN_ENERGY
 #define LWB_CONF_STREAM_EXTRA_DATA_LEN       1
+#elif defined(LWB_SCHED_EDF)
+/* the deadline of the stream (see LWB_STREAM_REQ_SET_DEADLINE) */
+#define LWB_CONF_STREAM_EXTRA_DATA_LEN       2
+#elif LWB_CONF_SCHED_BURST
+/* the burst length of the stream (see LWB_STREAM_REQ_SET_BURST) */
+#define LWB_CONF_STREAM_EXTRA_DATA_LEN       1
 #else
 #define LWB_CONF_STREAM_EXTRA_DATA_LEN       0
 #endif
@@ -116,6 +225,8 @@
  * @brief the structure of a schedule packet
  */
 #define LWB_SCHED_PKT_HEADER_LEN    8
+/* number of bytes needed for the length classes of n data slots */
+#define LWB_SCHED_SLOT_LEN_BYTES(n) (((n) + 3) / 4)
 typedef struct {    
     uint32_t time;
     uint16_t period;
@@ -123,6 +234,12 @@ typedef struct {
       * a contention or an s-ack slot in this round */
     uint16_t n_slots;
     uint16_t slot[LWB_CONF_MAX_DATA_SLOTS];
+#if LWB_CONF_SCHED_VAR_SLOTS
+    /* length class of each data slot (2 bits per slot, see 
+     * LWB_SCHED_GET_SLOT_LEN), transmitted right after the (compressed) 
+     * slots */
+    uint8_t  slot_len[LWB_SCHED_SLOT_LEN_BYTES(LWB_CONF_MAX_DATA_SLOTS)];
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
 } lwb_schedule_t;
 
 /**
@@ -135,8 +252,9 @@ typedef struct {
                                     LWB_CONF_STREAM_EXTRA_DATA_LEN)
 typedef struct {
     uint16_t id;            /* ID of this node */
-    uint8_t  reserved;      /* padding for alignment to 16-bit
-                             * or use #pragma pack(1) [...] #pragma pack() */
+    uint8_t  max_len;       /* max. payload length of the stream in bytes, 
+                             * 0 = LWB_DATA_PKT_PAYLOAD_LEN (only used with
+                             * LWB_CONF_SCHED_VAR_SLOTS) */
     uint8_t  stream_id;     /* stream ID (chosen by the source node) */
     uint16_t ipi;
 #if LWB_CONF_STREAM_EXTRA_DATA_LEN
@@ -144,6 +262,25 @@ typedef struct {
 #endif /* LWB_CONF_STREAM_EXTRA_DATA_LEN */
 } lwb_stream_req_t;
 
+#ifdef LWB_SCHED_EDF
+/* the deadline of a stream for the EDF scheduler: max. time in seconds from 
+ * the generation of a packet until its delivery, 0 = no deadline (stored in 
+ * little-endian byte order in the extra data) */
+#define LWB_STREAM_REQ_SET_DEADLINE(req, d) \
+  { (req)->extra_data[0] = (uint8_t)(d); \
+    (req)->extra_data[1] = (uint8_t)((uint16_t)(d) >> 8); }
+#define LWB_STREAM_REQ_GET_DEADLINE(req) \
+  ((uint16_t)(req)->extra_data[0] | ((uint16_t)(req)->extra_data[1] << 8))
+#endif /* LWB_SCHED_EDF */
+
+#if LWB_CONF_SCHED_BURST
+/* the number of consecutive data slots a stream gets per IPI (stored in the 
+ * extra data, 0 is treated as 1) */
+#define LWB_STREAM_REQ_SET_BURST(req, n)  ((req)->extra_data[0] = (uint8_t)(n))
+#define LWB_STREAM_REQ_GET_BURST(req)     ((req)->extra_data[0] ? \
+                                           (req)->extra_data[0] : 1)
+#endif /* LWB_CONF_SCHED_BURST */
+
 #define LWB_SACK_MIN_PKT_LEN       4
 typedef struct {                    
     uint16_t id;              
@@ -159,6 +296,11 @@ typedef struct {
     LWB_CONF_MAX_DATA_SLOTS > 63
 #error "LWB_CONF_MAX_DATA_SLOTS is invalid"
 #endif
+#if LWB_CONF_SCHED_VAR_SLOTS && (LWB_SCHED_PKT_HEADER_LEN + \
+    LWB_CONF_MAX_DATA_SLOTS * 2 + \
+    LWB_SCHED_SLOT_LEN_BYTES(LWB_CONF_MAX_DATA_SLOTS)) > LWB_CONF_MAX_PKT_LEN
+#error "LWB_CONF_MAX_DATA_SLOTS too big for LWB_CONF_SCHED_VAR_SLOTS"
+#endif
 
 
 /**
@@ -180,11 +322,11 @@ typedef struct {
 /**
  * @brief returns the number of data slots from schedule
  */
-#define LWB_SCHED_N_SLOTS(s)          ((s)->n_slots & 0x1fff)
+#define LWB_SCHED_N_SLOTS(s)          ((s)->n_slots & 0x003f)
 /**
  * @brief checks whether schedule has data slots
  */
-#define LWB_SCHED_HAS_DATA_SLOT(s)    (((s)->n_slots & 0x3fff) > 0)
+#define LWB_SCHED_HAS_DATA_SLOT(s)    (((s)->n_slots & 0x203f) > 0)
 /**
  * @brief checks whether schedule has a contention slot
  */
@@ -197,6 +339,47 @@ typedef struct {
  * @brief checks whether schedule has a D-ACK slot
  */
 #define LWB_SCHED_HAS_DACK_SLOT(s)    (((s)->n_slots & 0x2000) > 0)
+/**
+ * @brief returns the encoding of the slots in schedule s (LWB_SCHED_ENC_x)
+ */
+#define LWB_SCHED_GET_ENC(s)          (((s)->n_slots >> 11) & 0x03)
+/**
+ * @brief sets the encoding of the slots in schedule s
+ */
+#define LWB_SCHED_SET_ENC(s, e)       ((s)->n_slots = ((s)->n_slots & ~0x1800)\
+                                       | ((uint16_t)(e) << 11))
+/**
+ * @brief checks whether schedule s only contains the changes w.r.t. the 
+ * schedule of the last round
+ */
+#define LWB_SCHED_IS_DIFF(s)          (((s)->n_slots & 0x0400) > 0)
+/**
+ * @brief marks schedule s as differential (d = 1) or full schedule (d = 0)
+ */
+#define LWB_SCHED_SET_DIFF(s, d)      ((s)->n_slots = ((s)->n_slots & ~0x0400)\
+                                       | ((d) ? 0x0400 : 0))
+/**
+ * @brief returns the 4-bit sequence number of schedule s
+ */
+#define LWB_SCHED_GET_SEQ(s)          (((s)->n_slots >> 6) & 0x0f)
+/**
+ * @brief sets the sequence number of schedule s
+ */
+#define LWB_SCHED_SET_SEQ(s, q)       ((s)->n_slots = ((s)->n_slots & ~0x03c0)\
+                                       | (((uint16_t)(q) & 0x0f) << 6))
+/**
+ * @brief returns the length class of data slot i of schedule s (0 to 
+ * LWB_SLOT_N_CLASSES - 1)
+ */
+#define LWB_SCHED_GET_SLOT_LEN(s, i)  (((s)->slot_len[(i) >> 2] >> \
+                                        (((i) & 0x03) << 1)) & 0x03)
+/**
+ * @brief sets the length class of data slot i of schedule s (the class must
+ * be cleared before)
+ */
+#define LWB_SCHED_SET_SLOT_LEN(s, i, c) ((s)->slot_len[(i) >> 2] |= \
+                                         (uint8_t)((c) << \
+                                                   (((i) & 0x03) << 1)))
 /**
  * @brief marks schedule to have a contention slot
  */
@@ -226,6 +409,18 @@ uint8_t lwb_sched_prepare_sack(void *payload);
  */
 void lwb_sched_proc_srq(const lwb_stream_req_t* req);
 
+#if LWB_CONF_SCHED_BULK
+/**
+ * @brief processes the backlog advertised by a source (see 
+ * LWB_CONF_SCHED_BULK)
+ * @param[in] id the node ID of the source
+ * @param[in] stream_id the stream of the packet that carried the backlog
+ * @param[in] backlog the number of messages in the outgoing queue of the 
+ * source
+ */
+void lwb_sched_proc_backlog(uint16_t id, uint8_t stream_id, uint8_t backlog);
+#endif /* LWB_CONF_SCHED_BULK */
+
 /**
  * @brief initializes the schedule
  * resets all the data structures and sets the initial values
@@ -234,6 +429,22 @@ void lwb_sched_proc_srq(const lwb_stream_req_t* req);
  */
 uint16_t lwb_sched_init(lwb_schedule_t* sched);
 
+/**
+ * @brief sets the global time of the scheduler without touching the streams
+ * used by the standby host to follow the rounds of the host and to continue
+ * its schedule after a failover (see LWB_CONF_STANDBY_HOST_ID)
+ * @param[out] sched output buffer for an empty schedule of round t (can be 0)
+ * @param[in] t the global time of the current round
+ * @return the size of the (empty) schedule
+ */
+uint16_t lwb_sched_set_time(lwb_schedule_t* sched, uint32_t t);
+
+/**
+ * @brief get the number of streams currently registered with the scheduler
+ * @return the number of streams (incl. the streams of the host)
+ */
+uint16_t lwb_sched_get_n_streams(void);
+
 /**
  * @brief compute (and compress) the new schedule
  * @param[in,out] sched the old schedule and the output buffer for the new 
@@ -247,9 +458,205 @@ uint16_t lwb_sched_compute(lwb_schedule_t * const sched,
                            const uint8_t * const streams_to_update, 
                            uint8_t n_slot_host);
 
+/**
+ * @brief processes the data slots of the current round up to slot_idx
+ * (first part of the schedule computation)
+ * updates the streams of all nodes whose data slots are known, i.e. the
+ * streams of the nodes with an ID smaller than the node in the next slot;
+ * lwb_sched_compute() then only processes the remaining streams
+ * @param[in] sched the (uncompressed) schedule of the current round
+ * @param[in] streams_to_update the stream IDs of the packets received in the
+ * data slots 0 to slot_idx
+ * @param[in] slot_idx index of the last data slot
+ * @remark optional, can be called in the gap after each data slot
+ */
+void lwb_sched_proc_slot(const lwb_schedule_t * const sched,
+                         const uint8_t * const streams_to_update,
+                         uint8_t slot_idx);
 
-uint8_t lwb_sched_uncompress(uint8_t* compressed_data, 
-                             uint8_t n_slots);
+/**
+ * @brief the largest node ID whose data slots are all known after data slot 
+ * slot_idx (0 if none, 0xffff after the last slot); the slots of the host
+ * come first, all other slots are sorted by node ID
+ */
+#define LWB_SCHED_LAST_KNOWN_ID(s, slot_idx) \
+  (((slot_idx) + 1 >= LWB_SCHED_N_SLOTS(s)) ? 0xffff : \
+   (((s)->slot[(slot_idx) + 1] == 0 || (s)->slot[(slot_idx) + 1] == node_id) ?\
+    0 : ((s)->slot[(slot_idx) + 1] - 1)))
+
+/**
+ * @brief encodings of the slots in the schedule (stored in bits 11 and 12 of
+ * n_slots, see compress.c); not used for differential schedules
+ */
+#define LWB_SCHED_ENC_RAW           0   /* uncompressed */
+#define LWB_SCHED_ENC_DELTA_RLE     1   /* run-length coded deltas */
+#define LWB_SCHED_ENC_BITMAP        2   /* presence bitmap of the node IDs */
+#define LWB_SCHED_ENC_RICE          3   /* Golomb-Rice coded deltas */
+#define LWB_SCHED_N_ENC             4
+
+/**
+ * @brief compresses the slots of the schedule with the encoding that yields
+ * the shortest schedule and stores this encoding in the schedule header
+ * (with LWB_CONF_SCHED_DIFF, only the changes w.r.t. the last uncompressed 
+ * schedule are sent if this is shorter)
+ * @param[in,out] sched the schedule, n_slots must already be set
+ * @return the size of the compressed slots in bytes
+ */
+uint16_t lwb_sched_compress(lwb_schedule_t* sched);
+
+/**
+ * @brief uncompresses the slots of the schedule (in place)
+ * @param[in,out] sched the received schedule
+ * @return 1 if successful, 0 otherwise (with LWB_CONF_SCHED_DIFF, all slots 
+ * are set to 0 if a differential schedule cannot be applied because the 
+ * last schedule was missed)
+ */
+uint8_t lwb_sched_uncompress(lwb_schedule_t* sched);
+
+#if LWB_CONF_DATA_QUEUE_DEPTH
+/**
+ * @brief forgets all reported queue depths
+ */
+void lwb_sched_queue_depth_init(void);
+
+/**
+ * @brief processes the fill level of the outgoing queue reported by a node
+ * on its data packet (see LWB_CONF_DATA_QUEUE_DEPTH)
+ * @param[in] id the node ID
+ * @param[in] depth the number of messages in the outgoing queue of the node
+ */
+void lwb_sched_proc_queue_depth(uint16_t id, uint8_t depth);
+
+/**
+ * @brief adds data slots for the nodes whose outgoing queue is filling up, 
+ * each such node gets enough slots to bring its queue below 
+ * LWB_CONF_SCHED_QUEUE_DEPTH_THRES (the fullest queues first, as long as 
+ * there are free slots); each report is only used once
+ * @param[in,out] sched the new schedule (the slots of the host come first, all
+ * other slots are sorted by node ID)
+ * @param[in] n_slots the number of slots assigned so far
+ * @return the new number of slots
+ */
+uint8_t lwb_sched_add_queue_depth_slots(lwb_schedule_t* sched, 
+                                        uint8_t n_slots);
+#endif /* LWB_CONF_DATA_QUEUE_DEPTH */
+
+#if LWB_CONF_SCHED_VAR_SLOTS
+/**
+ * @brief clears the length classes of all streams
+ */
+void lwb_sched_slot_len_init(void);
+
+/**
+ * @brief stores the length class of a stream according to the max. payload
+ * length in the (accepted) stream request, removes the stream if its IPI is 0
+ * @param[in] req the stream request
+ */
+void lwb_sched_slot_len_update(const lwb_stream_req_t* req);
+
+/**
+ * @brief removes a stream, call this when the scheduler drops a stream
+ */
+void lwb_sched_slot_len_remove(uint16_t id, uint8_t stream_id);
+
+/**
+ * @brief sets the length class of each data slot of the schedule to the
+ * largest class of all streams of the node in that slot (the largest class if
+ * the node has no known stream, e.g. the host)
+ * @param[in,out] sched the schedule, the slots must not be compressed yet
+ */
+void lwb_sched_set_slot_len(lwb_schedule_t* sched);
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+
+#if LWB_CONF_SCHED_HASH_INDEX
+/**
+ * @brief marks an invalid / unknown position in the stream index
+ */
+#define LWB_SCHED_INDEX_INVALID     0xffff
+
+/**
+ * @brief clears the stream index
+ */
+void lwb_sched_index_init(void);
+
+/**
+ * @brief adds a stream to the index
+ * @param[in] id node ID
+ * @param[in] stream_id stream ID
+ * @param[in] pos position of the stream info in the memory block of the 
+ * scheduler (index of the element in the MEMB or MEMBX)
+ * @return one if successful, zero if the index is full
+ */
+uint8_t lwb_sched_index_add(uint16_t id, uint8_t stream_id, uint16_t pos);
+
+/**
+ * @brief looks up a stream in the index
+ * @return the position of the stream info as passed to lwb_sched_index_add()
+ * or LWB_SCHED_INDEX_INVALID if the stream is not in the index
+ */
+uint16_t lwb_sched_index_get(uint16_t id, uint8_t stream_id);
+
+/**
+ * @brief removes a stream from the index
+ */
+void lwb_sched_index_remove(uint16_t id, uint8_t stream_id);
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+/**
+ * @brief marks an invalid position in the stream arrays
+ */
+#define LWB_SCHED_STREAMS_INVALID   0xffff
+
+/**
+ * @brief stream information on the host, stored in parallel arrays which are
+ * sorted by node ID (the number of streams is kept by the scheduler)
+ */
+typedef struct {
+  uint16_t id[LWB_CONF_MAX_N_STREAMS];
+  uint16_t ipi[LWB_CONF_MAX_N_STREAMS];
+  uint32_t last_assigned[LWB_CONF_MAX_N_STREAMS];
+  uint8_t  stream_id[LWB_CONF_MAX_N_STREAMS];
+  uint8_t  n_cons_missed[LWB_CONF_MAX_N_STREAMS];
+#if LWB_CONF_SCHED_BURST
+  uint8_t  burst[LWB_CONF_MAX_N_STREAMS];
+#endif /* LWB_CONF_SCHED_BURST */
+#if LWB_CONF_SCHED_BULK
+  uint8_t  backlog[LWB_CONF_MAX_N_STREAMS];
+#endif /* LWB_CONF_SCHED_BULK */
+} lwb_sched_streams_t;
+
+/**
+ * @brief searches a stream in the stream arrays (binary search)
+ * @param[in] s the stream arrays
+ * @param[in] n_streams the number of streams in s
+ * @param[in] id node ID
+ * @param[in] stream_id stream ID
+ * @return the position of the stream or LWB_SCHED_STREAMS_INVALID
+ */
+uint16_t lwb_sched_streams_find(const lwb_sched_streams_t* s, 
+                                uint16_t n_streams,
+                                uint16_t id, 
+                                uint8_t stream_id);
+
+/**
+ * @brief inserts a new stream into the stream arrays (after all streams with
+ * the same node ID), the remaining fields of the stream are cleared
+ * @return the position of the new stream or LWB_SCHED_STREAMS_INVALID if the
+ * arrays are full
+ */
+uint16_t lwb_sched_streams_insert(lwb_sched_streams_t* s, 
+                                  uint16_t n_streams,
+                                  uint16_t id, 
+                                  uint8_t stream_id);
+
+/**
+ * @brief removes the stream at position pos from the stream arrays
+ */
+void lwb_sched_streams_remove(lwb_sched_streams_t* s, 
+                              uint16_t n_streams,
+                              uint16_t pos);
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
 
 
 #endif /* __SCHEDULER_H__ */
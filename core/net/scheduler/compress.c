@@ -43,25 +43,65 @@
  * @file 
  * @brief compress / uncompress routines for the schedule
  *
+ * The host tries all encodings enabled in LWB_CONF_SCHED_COMPRESS_ENC and 
+ * picks the one that yields the shortest schedule; the chosen encoding is 
+ * stored in the schedule header (see LWB_SCHED_GET_ENC). The encodings are:
+ * - raw: the slots as they are (2 bytes per slot)
+ * - delta-RLE: the first node ID followed by runs of constant deltas 
+ *   (number of bits for delta and length in the third byte)
+ * - bitmap: the first node ID followed by one bit for each node ID up to the
+ *   last node ID in the schedule
+ * - Golomb-Rice: the first node ID, the Rice parameter k (4 bits) and the 
+ *   zigzag coded deltas (quotient unary, remainder in k bits)
+ *
+ * With LWB_CONF_SCHED_DIFF, the last uncompressed schedule serves as 
+ * reference and the host sends only the removed and inserted slots if this is
+ * shorter (differential schedule, see LWB_SCHED_IS_DIFF). The diff consists 
+ * of the number of removals (6 bits), the number of insertions (6 bits), the
+ * number of bits per node ID minus one (4 bits), the indices of the removed
+ * slots in the reference (6 bits each) and the new index (6 bits) and node ID
+ * of each inserted slot. Each schedule carries a 4-bit sequence number; a diff
+ * is only applied to the schedule with the preceding sequence number, 
+ * otherwise the node waits for the next full schedule (keyframe), which is 
+ * sent at least every LWB_CONF_SCHED_KEYFRAME_INTERVAL rounds.
+ *
  * @remarks
  * - each slot must be a uint16 variable
- * - the node IDs must be sorted in increasing order, otherwise this algorithm
- *   will not work
+ * - delta-RLE requires the node IDs to be sorted in increasing order, the
+ *   bitmap requires them to be strictly increasing; the raw and the 
+ *   Golomb-Rice encoding work for any order
+ * - the bits are packed LSB first
  * - the number of slots must not be higher than 255
  */
  
 #include "lwb.h"
 
- /*---------------------------------------------------------------------------*/
-/* the number of bits for depth and length are stored in the thirds slot;
+/*---------------------------------------------------------------------------*/
+/* the number of bits for depth and length are stored in the thirds byte;
  * 5 bits are reserved to store the number of bits needed for the depth 
- * (i.e. 0 to 31 bits) */
-#define GET_D_BITS()       (compressed_data[2] >> 3)
-/* 3 bits are reserved to store the number of bits needed for the length
- * (i.e. 0 to 7 bits) */
-#define GET_L_BITS()       (compressed_data[2] & 0x07)  
-#define SET_D_L_BITS(d, l) (compressed_data[2] = ((d) << 3) | ((l) & 0x07))
-#define COMPR_SLOT(a)      (compressed_data[3 + (a)])
+ * (i.e. 0 to 31 bits) and 3 bits for the length (i.e. 0 to 7 bits) */
+#define GET_D_BITS(b)       ((b) >> 3)
+#define GET_L_BITS(b)       ((b) & 0x07)  
+#define D_L_BITS(d, l)      (((d) << 3) | ((l) & 0x07))
+/* offset of the encoded data in bits (after the first node ID) */
+#define HDR_BITS            16
+#define RICE_K_BITS         4
+#define DIFF_IDX_BITS       6
+#define NOT_APPLICABLE      0xffff
+
+#ifndef MIN
+#define MIN(x, y)           ((x) < (y) ? (x) : (y))
+#endif /* MIN */
+/*---------------------------------------------------------------------------*/
+typedef struct {
+  /* returns the size in bytes or NOT_APPLICABLE */
+  uint16_t (*get_size)(const uint16_t* slots, uint8_t n_slots);
+  /* writes the encoded slots to out */
+  void     (*encode)(const uint16_t* slots, uint8_t n_slots, uint8_t* out);
+  /* decodes n_slots slots of max. len bytes, returns 0 on error */
+  uint8_t  (*decode)(const uint8_t* in, uint16_t len, uint8_t n_slots, 
+                     uint16_t* slots);
+} lwb_sched_enc_t;
 /*---------------------------------------------------------------------------*/
 static inline uint8_t 
 get_min_bits(uint16_t a) 
@@ -75,144 +115,655 @@ get_min_bits(uint16_t a)
   return i + 1;
 }
 /*---------------------------------------------------------------------------*/
-/**
- * @brief compress the schedule
- * @param [in,out] compressed_data the uncompressed schedule will be read from
- * and the compressed schedule will be written to this i/o buffer
- * @param [in] n_slots the number of slots of this schedule
- * @return the size of the compressed schedule
- */
-uint16_t 
-lwb_sched_compress(uint8_t* compressed_data, uint8_t n_slots) 
-{  
-  uint16_t slots_buffer[LWB_CONF_MAX_DATA_SLOTS];
+/* the bits are collected in a 32-bit accumulator (LSB first) and only
+ * complete bytes are written to the buffer */
+typedef struct {
+  uint8_t* buf;
+  uint16_t pos;             /* index of the next byte */
+  uint32_t acc;
+  uint8_t  n_bits;          /* number of bits in the accumulator */
+} bit_writer_t;
 
-  if(n_slots > LWB_CONF_MAX_DATA_SLOTS) {
+/* reads the buffer byte by byte into a 32-bit accumulator, never beyond 
+ * len bytes */
+typedef struct {
+  const uint8_t* buf;
+  uint16_t pos;             /* index of the next byte */
+  uint16_t len;
+  uint32_t acc;
+  uint8_t  n_bits;          /* number of bits in the accumulator */
+} bit_reader_t;
+/*---------------------------------------------------------------------------*/
+static inline void
+bw_init(bit_writer_t* w, uint8_t* buf)
+{
+  w->buf    = buf;
+  w->pos    = 0;
+  w->acc    = 0;
+  w->n_bits = 0;
+}
+/*---------------------------------------------------------------------------*/
+/* appends the n (max. 16) lower bits of val */
+static inline void
+bw_put(bit_writer_t* w, uint16_t val, uint8_t n)
+{
+  w->acc |= ((uint32_t)val & (((uint32_t)1 << n) - 1)) << w->n_bits;
+  w->n_bits += n;
+  while(w->n_bits >= 8) {
+    w->buf[w->pos++] = (uint8_t)w->acc;
+    w->acc >>= 8;
+    w->n_bits -= 8;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* appends n zeros */
+static inline void
+bw_put_zeros(bit_writer_t* w, uint16_t n)
+{
+  while(n > 16) {
+    bw_put(w, 0, 16);
+    n -= 16;
+  }
+  bw_put(w, 0, n);
+}
+/*---------------------------------------------------------------------------*/
+static inline void
+bw_flush(bit_writer_t* w)
+{
+  if(w->n_bits) {
+    w->buf[w->pos++] = (uint8_t)w->acc;
+    w->acc    = 0;
+    w->n_bits = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* makes sure at least n (max. 24) bits are in the accumulator, returns 0 if
+ * the end of the buffer is reached */
+static inline uint8_t
+br_fill(bit_reader_t* r, uint8_t n)
+{
+  while(r->n_bits < n) {
+    if(r->pos >= r->len) {
+      return 0;
+    }
+    r->acc |= (uint32_t)r->buf[r->pos++] << r->n_bits;
+    r->n_bits += 8;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* removes n bits from the accumulator (call br_fill first) */
+static inline uint16_t
+br_get(bit_reader_t* r, uint8_t n)
+{
+  uint16_t val = (uint16_t)(r->acc & (((uint32_t)1 << n) - 1));
+  r->acc >>= n;
+  r->n_bits -= n;
+  return val;
+}
+/*---------------------------------------------------------------------------*/
+/* starts reading at bit offset pos */
+static inline void
+br_init(bit_reader_t* r, const uint8_t* buf, uint16_t len, uint16_t pos)
+{
+  r->buf    = buf;
+  r->pos    = pos >> 3;
+  r->len    = len;
+  r->acc    = 0;
+  r->n_bits = 0;
+  if(br_fill(r, pos & 7)) {
+    br_get(r, pos & 7);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+raw_get_size(const uint16_t* slots, uint8_t n_slots)
+{
+  return (uint16_t)n_slots * 2;
+}
+/*---------------------------------------------------------------------------*/
+static void
+raw_encode(const uint16_t* slots, uint8_t n_slots, uint8_t* out)
+{
+  memcpy(out, slots, n_slots * 2);
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+raw_decode(const uint8_t* in, uint16_t len, uint8_t n_slots, uint16_t* slots)
+{
+  memcpy(slots, in, n_slots * 2);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* scans the runs of constant deltas, returns 0 if the IDs are not sorted */
+static uint8_t
+drle_scan(const uint16_t* slots, uint8_t n_slots, 
+          uint8_t* n_runs, uint8_t* d_bits, uint8_t* l_bits)
+{
+  uint16_t d = slots[1] - slots[0], d_max = 0;
+  uint8_t  l = 0, l_max = 0, idx;
+  
+  if(slots[1] < slots[0]) {
     return 0;
-  }  
-  if(n_slots < 2) {  /* don't do anything in case there is only 0 or 1 slot */
-    return n_slots * 2;
   }
-  /* copy the input data into a buffer */
-  memcpy(slots_buffer, compressed_data, n_slots * 2);
-  /* clear the output data buffer (except for the first slot!) */
-  memset(compressed_data + 2, 0, LWB_CONF_MAX_DATA_SLOTS * 2 - 2);
+  *n_runs = 0;
+  for(idx = 1; idx < n_slots; idx++) {
+    if(idx == n_slots - 1 || (slots[idx + 1] - slots[idx]) != d) {
+      /* the current run ends here */
+      d_max = MAX(d, d_max);
+      l_max = MAX(l, l_max);
+      (*n_runs)++;
+      if(idx < n_slots - 1) {
+        /* make sure the node IDs are in increasing order */
+        if(slots[idx + 1] < slots[idx]) {
+          return 0; /* node IDs are not sorted! */
+        }
+        d = slots[idx + 1] - slots[idx];
+        l = 0;
+      }
+    } else {
+      l++;
+    }
+  }
+  *d_bits = get_min_bits(d_max);
+  *l_bits = get_min_bits(l_max);
+  /* the number of bits for the length must fit into 3 bits */
+  return (*l_bits < 8);
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+drle_get_size(const uint16_t* slots, uint8_t n_slots)
+{
+  uint8_t n_runs, d_bits, l_bits;
+  if(!drle_scan(slots, n_slots, &n_runs, &d_bits, &l_bits)) {
+    return NOT_APPLICABLE;
+  }
+  return 3 + ((((uint16_t)n_runs * (d_bits + l_bits)) + 7) >> 3);
+}
+/*---------------------------------------------------------------------------*/
+static void
+drle_encode(const uint16_t* slots, uint8_t n_slots, uint8_t* out)
+{
+  bit_writer_t w;
+  uint8_t      n_runs, d_bits, l_bits, l = 0, idx;
+  
+  drle_scan(slots, n_slots, &n_runs, &d_bits, &l_bits);
+  bw_init(&w, out);
+  bw_put(&w, slots[0], 16);
+  bw_put(&w, D_L_BITS(d_bits, l_bits), 8);  /* the number of bits for d & l */
+  for(idx = 1; idx < n_slots; idx++) {
+    uint16_t d = slots[idx] - slots[idx - 1];
+    if(idx == n_slots - 1 || (slots[idx + 1] - slots[idx]) != d) {
+      /* end of this run: store the length followed by the delta */
+      bw_put(&w, l, l_bits);
+      bw_put(&w, d, d_bits);
+      l = 0;
+    } else {
+      l++;
+    }
+  }
+  bw_flush(&w);
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+drle_decode(const uint8_t* in, uint16_t len, uint8_t n_slots, uint16_t* slots)
+{
+  bit_reader_t r;
+  uint8_t      d_bits, l_bits, slot_idx = 1;
+
+  br_init(&r, in, len, 0);
+  if(!br_fill(&r, 24)) {
+    return 0;
+  }
+  slots[0] = br_get(&r, 16);
+  l_bits   = br_get(&r, 8);
+  d_bits   = GET_D_BITS(l_bits);
+  l_bits   = GET_L_BITS(l_bits);
+  /* check whether the values make sense */
+  if(d_bits == 0 || d_bits > 16 || l_bits == 0) {
+    return 0; /* invalid d or l bits */
+  }
+  while(slot_idx < n_slots) {
+    /* extract d and l of this run (max. 23 bits) */
+    if(!br_fill(&r, d_bits + l_bits)) {
+      return 0;
+    }
+    uint16_t l = br_get(&r, l_bits);
+    uint16_t d = br_get(&r, d_bits);
+    if(slot_idx + l >= n_slots) {
+      return 0;   /* run exceeds the number of slots */
+    }
+    /* generate the slots */
+    do {
+      /* add the offset to the previous slot */
+      slots[slot_idx] = slots[slot_idx - 1] + d;
+      slot_idx++;
+    } while(l--);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+bitmap_get_size(const uint16_t* slots, uint8_t n_slots)
+{
+  uint8_t idx;
+  for(idx = 1; idx < n_slots; idx++) {
+    if(slots[idx] <= slots[idx - 1]) {
+      return NOT_APPLICABLE;    /* IDs not strictly increasing */
+    }
+  }
+  return 2 + (((uint32_t)slots[n_slots - 1] - slots[0] + 7) >> 3);
+}
+/*---------------------------------------------------------------------------*/
+static void
+bitmap_encode(const uint16_t* slots, uint8_t n_slots, uint8_t* out)
+{
+  bit_writer_t w;
+  uint8_t      idx;
+  
+  bw_init(&w, out);
+  bw_put(&w, slots[0], 16);
+  for(idx = 1; idx < n_slots; idx++) {
+    /* bit i stands for node ID slots[0] + 1 + i */
+    bw_put_zeros(&w, slots[idx] - slots[idx - 1] - 1);
+    bw_put(&w, 1, 1);
+  }
+  bw_flush(&w);
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+bitmap_decode(const uint8_t* in, uint16_t len, uint8_t n_slots, 
+              uint16_t* slots)
+{
+  uint16_t idx, id;
+  uint8_t  slot_idx = 1;
   
-  /* Note: the first slot holds the first node ID */
+  if(len < 2) {
+    return 0;
+  }
+  slots[0] = (uint16_t)in[1] << 8 | in[0];
+  id = slots[0] + 1;
+  for(idx = 2; idx < len && slot_idx < n_slots; idx++, id += 8) {
+    uint8_t  b = in[idx];
+    uint16_t i = id;
+    /* empty bytes are skipped at once */
+    while(b && slot_idx < n_slots) {
+      if(b & 1) {
+        slots[slot_idx++] = i;
+      }
+      b >>= 1;
+      i++;
+    }
+  }
+  return (slot_idx == n_slots);
+}
+/*---------------------------------------------------------------------------*/
+/* maps the signed delta between two slots to an unsigned value */
+static inline uint16_t
+rice_zigzag(uint16_t prev, uint16_t curr)
+{
+  uint16_t d = curr - prev;
+  return (d << 1) ^ ((d & 0x8000) ? 0xffff : 0);
+}
+/*---------------------------------------------------------------------------*/
+/* selects the Rice parameter k based on the mean of the deltas and returns 
+ * the size in bits */
+static uint32_t
+rice_select_k(const uint16_t* slots, uint8_t n_slots, uint8_t* k)
+{
+  uint32_t sum = 0, n_bits, best = 0xffffffff;
+  uint32_t q_sum[3] = { 0 };
+  uint8_t  idx, k_min;
+  for(idx = 1; idx < n_slots; idx++) {
+    sum += rice_zigzag(slots[idx - 1], slots[idx]);
+  }
+  /* the optimum is within +-1 of the estimate based on the mean */
+  k_min = get_min_bits(sum / (n_slots - 1)) - 1;
+  k_min = (k_min > 13) ? 13 : (k_min ? k_min - 1 : 0);
+  /* sum up the quotients for k_min, k_min + 1 and k_min + 2 in one pass */
+  for(idx = 1; idx < n_slots; idx++) {
+    uint16_t z = rice_zigzag(slots[idx - 1], slots[idx]) >> k_min;
+    q_sum[0] += z;
+    q_sum[1] += z >> 1;
+    q_sum[2] += z >> 2;
+  }
+  for(idx = 0; idx < 3; idx++) {
+    n_bits = HDR_BITS + RICE_K_BITS + q_sum[idx] + 
+             (uint32_t)(n_slots - 1) * (1 + k_min + idx);
+    if(n_bits < best) {
+      best = n_bits;
+      *k = k_min + idx;
+    }
+  }
+  return best;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+rice_get_size(const uint16_t* slots, uint8_t n_slots)
+{
+  uint8_t  k;
+  uint32_t n_bits = rice_select_k(slots, n_slots, &k);
+  if(n_bits > (uint32_t)n_slots * 16) {
+    return NOT_APPLICABLE;
+  }
+  return (n_bits + 7) >> 3;
+}
+/*---------------------------------------------------------------------------*/
+static void
+rice_encode(const uint16_t* slots, uint8_t n_slots, uint8_t* out)
+{
+  bit_writer_t w;
+  uint8_t      k, idx;
   
-  uint8_t  n_runs = 0;    /* how many times the delta has changed */
-  uint16_t d[n_slots - 1];
-  d[n_runs] = slots_buffer[1] - slots_buffer[0];  /* delta (step size) */
-  uint16_t d_max = d[n_runs];
-  /* length (how many consecutive slots with step size d) */
-  uint16_t l[n_slots - 1];
-  l[n_runs] = 0;
-  uint8_t  l_max = l[n_runs];
-  uint8_t  idx;
+  rice_select_k(slots, n_slots, &k);
+  bw_init(&w, out);
+  bw_put(&w, slots[0], 16);
+  bw_put(&w, k, RICE_K_BITS);
+  for(idx = 1; idx < n_slots; idx++) {
+    uint16_t z = rice_zigzag(slots[idx - 1], slots[idx]);
+    uint16_t q = z >> k;
+    /* quotient in unary (q ones and a zero), then the remainder */
+    while(q >= 16) {
+      bw_put(&w, 0xffff, 16);
+      q -= 16;
+    }
+    bw_put(&w, (1 << q) - 1, q + 1);
+    bw_put(&w, z, k);
+  }
+  bw_flush(&w);
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+rice_decode(const uint8_t* in, uint16_t len, uint8_t n_slots, uint16_t* slots)
+{
+  bit_reader_t r;
+  uint8_t      k, idx;
 
-  for(idx = 1; idx < n_slots - 1; idx++) {
-    if((slots_buffer[idx + 1] - slots_buffer[idx]) == d[n_runs]) {
-      l[n_runs]++;
+  br_init(&r, in, len, 0);
+  if(!br_fill(&r, HDR_BITS + RICE_K_BITS)) {
+    return 0;
+  }
+  slots[0] = br_get(&r, HDR_BITS);
+  k = br_get(&r, RICE_K_BITS);
+  for(idx = 1; idx < n_slots; idx++) {
+    uint16_t q = 0, z;
+    /* count the ones, a whole byte at a time if possible */
+    for(;;) {
+      if(!br_fill(&r, 8) && !br_fill(&r, 1)) {
+        return 0;
+      }
+      if(r.n_bits >= 8 && (r.acc & 0xff) == 0xff) {
+        q += 8;
+        br_get(&r, 8);
+      } else if(r.acc & 1) {
+        q++;
+        br_get(&r, 1);
+      } else {
+        br_get(&r, 1);  /* the terminating zero */
+        break;
+      }
+    }
+    if(!br_fill(&r, k)) {
+      return 0;
+    }
+    z = (q << k) | br_get(&r, k);
+    /* undo the zigzag mapping */
+    slots[idx] = slots[idx - 1] + (uint16_t)((z >> 1) ^ -(z & 1));
+  }
+  return 1;
+}
+#if LWB_CONF_SCHED_DIFF
+/*---------------------------------------------------------------------------*/
+typedef struct {
+  uint8_t  n_rem;       /* number of removed slots */
+  uint8_t  n_ins;       /* number of inserted slots */
+  uint16_t id_max;      /* largest inserted node ID */
+} lwb_sched_diff_t;
+/*---------------------------------------------------------------------------*/
+static uint16_t ref_slots[LWB_CONF_MAX_DATA_SLOTS];  /* last schedule */
+static uint8_t  ref_n_slots;
+static uint8_t  ref_seq;
+static uint8_t  ref_valid = 0;
+static uint8_t  n_diffs = 0;               /* # diffs since the last keyframe */
+/*---------------------------------------------------------------------------*/
+/* merges the reference with the new slots (both are usually sorted, but any
+ * order yields a valid diff); counts the removals and insertions if w is 
+ * NULL, writes either the removals or the insertions to w otherwise */
+static void
+diff_walk(const uint16_t* slots, uint8_t n_slots, bit_writer_t* w, 
+          uint8_t insertions, lwb_sched_diff_t* d)
+{
+  uint8_t i = 0, j = 0, n_rem = 0, n_ins = 0;
+  uint8_t id_bits = get_min_bits(d->id_max);
+  
+  while(i < ref_n_slots || j < n_slots) {
+    if(i < ref_n_slots && j < n_slots && ref_slots[i] == slots[j]) {
+      i++;
+      j++;
+    } else if(j >= n_slots || (i < ref_n_slots && ref_slots[i] < slots[j])) {
+      /* slot i of the reference has been removed */
+      if(w && !insertions) {
+        bw_put(w, i, DIFF_IDX_BITS);
+      }
+      n_rem++;
+      i++;
     } else {
-      if(l[n_runs] > l_max) {
-        /* keep track of the max. num. of conseq. slots with const. delta */
-        l_max = l[n_runs]; 
+      /* slot j has been inserted */
+      if(!w) {
+        d->id_max = MAX(d->id_max, slots[j]);
+      } else if(insertions) {
+        bw_put(w, j, DIFF_IDX_BITS);
+        bw_put(w, slots[j], id_bits);
       }
-      n_runs++; 
-      /* calculate the new delta */
-      d[n_runs] = slots_buffer[idx + 1] - slots_buffer[idx]; 
-      /* make sure the node IDs are in increasing order */
-      if(slots_buffer[idx + 1] < slots_buffer[idx]) {
-        return 0; /* node IDs are not sorted! */
+      n_ins++;
+      j++;
+    }
+  }
+  d->n_rem = n_rem;
+  d->n_ins = n_ins;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+diff_get_size(const uint16_t* slots, uint8_t n_slots, lwb_sched_diff_t* d)
+{
+  d->id_max = 0;
+  diff_walk(slots, n_slots, 0, 0, d);
+  return 2 + ((uint16_t)d->n_rem * DIFF_IDX_BITS + (uint16_t)d->n_ins * 
+              (DIFF_IDX_BITS + get_min_bits(d->id_max)) + 7) / 8;
+}
+/*---------------------------------------------------------------------------*/
+static void
+diff_encode(const uint16_t* slots, uint8_t n_slots, uint8_t* out, 
+            lwb_sched_diff_t* d)
+{
+  bit_writer_t w;
+  
+  bw_init(&w, out);
+  bw_put(&w, d->n_rem, DIFF_IDX_BITS);
+  bw_put(&w, d->n_ins, DIFF_IDX_BITS);
+  bw_put(&w, get_min_bits(d->id_max) - 1, 4);
+  /* all removals first, then all insertions */
+  diff_walk(slots, n_slots, &w, 0, d);
+  diff_walk(slots, n_slots, &w, 1, d);
+  bw_flush(&w);
+}
+/*---------------------------------------------------------------------------*/
+/* applies the diff to the reference */
+static uint8_t
+diff_decode(const uint8_t* in, uint16_t len, uint8_t n_slots, uint16_t* slots)
+{
+  bit_reader_t rem, ins;
+  uint8_t      n_rem, n_ins, id_bits, i = 0, j, next_rem, next_ins;
+
+  br_init(&rem, in, len, 0);
+  if(!br_fill(&rem, HDR_BITS)) {
+    return 0;
+  }
+  n_rem   = br_get(&rem, DIFF_IDX_BITS);
+  n_ins   = br_get(&rem, DIFF_IDX_BITS);
+  id_bits = br_get(&rem, 4) + 1;
+  if((HDR_BITS + (uint16_t)n_rem * DIFF_IDX_BITS + 
+      (uint16_t)n_ins * (DIFF_IDX_BITS + id_bits)) > len * 8 ||
+     ((uint16_t)ref_n_slots + n_ins) != ((uint16_t)n_slots + n_rem)) {
+    return 0;
+  }
+  /* the insertions follow the removals; the reads below can't fail anymore
+   * since the length has been checked */
+  br_init(&ins, in, len, HDR_BITS + (uint16_t)n_rem * DIFF_IDX_BITS);
+  next_rem = 0xff;
+  if(n_rem) {
+    br_fill(&rem, DIFF_IDX_BITS);
+    next_rem = br_get(&rem, DIFF_IDX_BITS);
+  }
+  next_ins = 0xff;
+  if(n_ins) {
+    br_fill(&ins, DIFF_IDX_BITS);
+    next_ins = br_get(&ins, DIFF_IDX_BITS);
+  }
+  for(j = 0; j < n_slots; j++) {
+    if(j == next_ins) {
+      br_fill(&ins, id_bits);
+      slots[j] = br_get(&ins, id_bits);
+      next_ins = 0xff;
+      if(--n_ins) {
+        br_fill(&ins, DIFF_IDX_BITS);
+        next_ins = br_get(&ins, DIFF_IDX_BITS);
+      }
+    } else {
+      /* skip the removed slots of the reference */
+      while(i == next_rem) {
+        i++;
+        next_rem = 0xff;
+        if(--n_rem) {
+          br_fill(&rem, DIFF_IDX_BITS);
+          next_rem = br_get(&rem, DIFF_IDX_BITS);
+        }
       }
-      if(d[n_runs] > d_max) {
-        d_max = d[n_runs];  /* keep track of the max. delta */
+      if(i >= ref_n_slots) {
+        return 0;
       }
-      l[n_runs] = 0;
+      slots[j] = ref_slots[i++];
     }
   }
-  if(l[n_runs] > l_max) {
-    l_max = l[n_runs];
+  return (n_ins == 0);
+}
+/*---------------------------------------------------------------------------*/
+static void
+diff_set_ref(const lwb_schedule_t* sched)
+{
+  ref_n_slots = LWB_SCHED_N_SLOTS(sched);
+  ref_seq     = LWB_SCHED_GET_SEQ(sched);
+  ref_valid   = 1;
+  memcpy(ref_slots, sched->slot, ref_n_slots * 2);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* LWB_CONF_SCHED_DIFF */
+/*---------------------------------------------------------------------------*/
+static const lwb_sched_enc_t encodings[LWB_SCHED_N_ENC] = {
+  { raw_get_size,    raw_encode,    raw_decode },   /* LWB_SCHED_ENC_RAW */
+  { drle_get_size,   drle_encode,   drle_decode },  /* LWB_SCHED_ENC_DELTA_RLE*/
+  { bitmap_get_size, bitmap_encode, bitmap_decode },/* LWB_SCHED_ENC_BITMAP */
+  { rice_get_size,   rice_encode,   rice_decode },  /* LWB_SCHED_ENC_RICE */
+};
+/*---------------------------------------------------------------------------*/
+uint16_t 
+lwb_sched_compress(lwb_schedule_t* sched) 
+{  
+  uint16_t slots_buffer[LWB_CONF_MAX_DATA_SLOTS];
+  uint8_t  n_slots = LWB_SCHED_N_SLOTS(sched);
+  uint8_t  enc, best_enc = LWB_SCHED_ENC_RAW;
+  uint16_t size, best_size = (uint16_t)n_slots * 2;
+
+  if(n_slots > LWB_CONF_MAX_DATA_SLOTS) {
+    return 0;
   }
-  n_runs++;
-  
-  uint8_t d_bits = get_min_bits(d_max);
-  uint8_t l_bits = get_min_bits(l_max);
-  /* required bits for each delta + length */
-  uint16_t run_bits = d_bits + l_bits; 
+  /* copy the input data into a buffer */
+  memcpy(slots_buffer, sched->slot, n_slots * 2);
+  /* don't do anything in case there is only 0 or 1 slot */
+  if(n_slots >= 2) {
+    for(enc = LWB_SCHED_ENC_RAW + 1; enc < LWB_SCHED_N_ENC; enc++) {
+      if(!(LWB_CONF_SCHED_COMPRESS_ENC & (1 << enc))) {
+        continue;
+      }
+      size = encodings[enc].get_size(slots_buffer, n_slots);
+      if(size < best_size) {
+        best_size = size;
+        best_enc  = enc;
+      }
+    }
+  }
+  LWB_SCHED_SET_ENC(sched, best_enc);
   
-  for(idx = 0; idx < n_runs; idx++) {    
-      //DEBUG_PRINT_INFO("dbits: %u lbits: %u delta: %u len: %u", d_bits, l_bits, d[idx], l[idx]);
-    uint16_t offset_bits = run_bits * idx;
-    /* store the current and the following 3 bytes in a 32-bit variable */
-    uint32_t tmp = (uint32_t)COMPR_SLOT(offset_bits / 8) | 
-                   ((uint32_t)COMPR_SLOT(offset_bits / 8 + 1) << 8)  |
-                   ((uint32_t)COMPR_SLOT(offset_bits / 8 + 2) << 16) |
-                   ((uint32_t)COMPR_SLOT(offset_bits / 8 + 3) << 24);
-    /* append the new data (d and l) */
-    tmp |= ( ( ((uint32_t)d[idx] << l_bits) | l[idx] ) << (offset_bits % 8) );  
-    COMPR_SLOT(offset_bits / 8)   = (uint8_t)tmp;
-    COMPR_SLOT(offset_bits / 8 + 1) = (uint8_t)(tmp >> 8);
-    COMPR_SLOT(offset_bits / 8 + 2) = (uint8_t)(tmp >> 16);
-    COMPR_SLOT(offset_bits / 8 + 3) = (uint8_t)(tmp >> 24);
-  }
-  SET_D_L_BITS(d_bits, l_bits);   /* store the number of bits for d and l */
+#if LWB_CONF_SCHED_DIFF
+  /* the diff refers to the last uncompressed schedule */
+  LWB_SCHED_SET_SEQ(sched, ref_seq + 1);
+  LWB_SCHED_SET_DIFF(sched, 0);
+  if(ref_valid && n_diffs < LWB_CONF_SCHED_KEYFRAME_INTERVAL) {
+    lwb_sched_diff_t d;
+    size = diff_get_size(slots_buffer, n_slots, &d);
+    if(size < best_size) {
+      diff_encode(slots_buffer, n_slots, (uint8_t*)sched->slot, &d);
+      LWB_SCHED_SET_ENC(sched, LWB_SCHED_ENC_RAW);
+      LWB_SCHED_SET_DIFF(sched, 1);
+      n_diffs++;
+      return size;
+    }
+  }
+  n_diffs = 0;                                    /* this is a keyframe */
+#endif /* LWB_CONF_SCHED_DIFF */
+
+  if(best_enc != LWB_SCHED_ENC_RAW) {
+    /* encode the slots */
+    encodings[best_enc].encode(slots_buffer, n_slots, (uint8_t*)sched->slot);
+  }
   
   /* return the size of the compressed schedule */
-  return 3 + ((((uint16_t)n_runs * run_bits) + 7) >> 3);
+  return best_size;
 }
 /*---------------------------------------------------------------------------*/
-/**
- * @brief uncompress the schedule
- * @param [in,out] compressed_data the compressed schedule will be read from 
- * and the uncompressed schedule will be written to this i/o buffer
- * @param [in] n_slots the number of slots of this schedule
- * @return 1 if successful, 0 otherwise
- */
 uint8_t
-lwb_sched_uncompress(uint8_t* compressed_data, uint8_t n_slots) 
+lwb_sched_uncompress(lwb_schedule_t* sched) 
 {
   uint16_t slots_buffer[LWB_CONF_MAX_DATA_SLOTS];
+  uint8_t  n_slots = LWB_SCHED_N_SLOTS(sched);
+  uint8_t  enc = LWB_SCHED_GET_ENC(sched);
   
   if(n_slots > LWB_CONF_MAX_DATA_SLOTS) {
     return 0;
   }  
-  if(n_slots < 2) {  /* don't do anything in case there is only 0 or 1 slot */
+#if LWB_CONF_SCHED_DIFF
+  if(LWB_SCHED_IS_DIFF(sched)) {
+    /* the diff can only be applied to the preceding schedule */
+    if(!ref_valid || 
+       LWB_SCHED_GET_SEQ(sched) != ((ref_seq + 1) & 0x0f) ||
+       !diff_decode((uint8_t*)sched->slot, (uint16_t)n_slots * 2, n_slots, 
+                    slots_buffer)) {
+      /* slots unknown until the next keyframe */
+      ref_valid = 0;
+      memset(sched->slot, 0, n_slots * 2);
+      return 0;
+    }
+    memcpy(sched->slot, slots_buffer, n_slots * 2);
+    LWB_SCHED_SET_DIFF(sched, 0);
+    diff_set_ref(sched);
     return 1;
   }
-  
-  slots_buffer[0] = (uint16_t)compressed_data[1] << 8 | compressed_data[0];
-
-  uint8_t d_bits = GET_D_BITS();
-  uint8_t l_bits = GET_L_BITS();
-  uint16_t run_bits = d_bits + l_bits;
-  
-  /* check whether the values make sense */
-  if(d_bits == 0 || d_bits > 16 || l_bits == 0) {
-    return 0; /* invalid d or l bits */
-  }
-  
-  uint8_t slot_idx = 1, idx;
-  uint32_t mask = (((uint32_t)1 << run_bits) - 1);
-  for(idx = 0; slot_idx < n_slots; idx++) {
-    /* extract d and l of this run */
-    uint16_t offset_bits = run_bits * idx;
-    uint32_t tmp = (uint32_t)COMPR_SLOT(offset_bits / 8) |
-                   ((uint32_t)COMPR_SLOT(offset_bits / 8 + 1) << 8)  |
-                   ((uint32_t)COMPR_SLOT(offset_bits / 8 + 2) << 16) | 
-                   ((uint32_t)COMPR_SLOT(offset_bits / 8 + 3) << 24);
-    uint32_t run_info = ((tmp >> (offset_bits % 8)) & mask);
-    uint16_t d = run_info >> l_bits;
-    uint16_t l = run_info & ((1 << l_bits) - 1);
-    uint8_t i;
-    /* generate the slots */
-    for(i = 0; i < l + 1; i++) {
-      /* add the offset to the previous slot */
-      slots_buffer[slot_idx] = slots_buffer[slot_idx - 1] + d;
-      slot_idx++;
+#endif /* LWB_CONF_SCHED_DIFF */
+  if(enc != LWB_SCHED_ENC_RAW) {
+    if(n_slots < 2 || !(LWB_CONF_SCHED_COMPRESS_ENC & (1 << enc))) {
+      return 0;   /* invalid or unsupported encoding */
     }
-  }  
-  memcpy(compressed_data, slots_buffer, n_slots * 2);
+    /* the encoded slots are never longer than the raw slots */
+    if(!encodings[enc].decode((uint8_t*)sched->slot, (uint16_t)n_slots * 2, 
+                              n_slots, slots_buffer)) {
+      return 0;
+    }
+    memcpy(sched->slot, slots_buffer, n_slots * 2);
+    LWB_SCHED_SET_ENC(sched, LWB_SCHED_ENC_RAW);
+  }
+#if LWB_CONF_SCHED_DIFF
+  diff_set_ref(sched);
+#endif /* LWB_CONF_SCHED_DIFF */
   
   return 1;
 }
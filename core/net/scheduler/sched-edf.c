@@ -0,0 +1,720 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @addtogroup  lwb-scheduler
+ * @{
+ *
+ * @defgroup    edf-sched Earliest-deadline-first scheduler
+ * @{
+ *
+ * @file 
+ * @brief
+ * a scheduler for streams with a latency bound (deadline)
+ * 
+ * Each stream request carries the deadline of the stream in the extra data
+ * (see LWB_STREAM_REQ_SET_DEADLINE), i.e. the max. time in seconds from the 
+ * generation of a packet until its delivery to the host.
+ * A packet generated right after a round is sent at the latest in the next 
+ * round, i.e. its delay is bounded by the round period plus the duration of 
+ * a round if the stream gets enough slots in every round. The scheduler 
+ * therefore uses the longest round period T (min. energy) which satisfies
+ * - T <= deadline - duration of a round for each stream with a deadline,
+ * - the sum of ceil(T / IPI) over all streams fits into the data slots of 
+ *   a round (one slot is kept for the host).
+ * A stream request is rejected (no S-ACK) if no such period exists. 
+ * The period is computed from the number of streams per IPI and per 
+ * deadline, i.e. in constant time w.r.t. the number of streams.
+ * 
+ * Streams whose deadline is shorter than IPI + T + duration of a round 
+ * can't wait until the host expects their next packet: they get
+ * ceil(T / IPI) slots in every round. All other streams get slots at their
+ * IPI as with the min-delay scheduler. If there are not enough slots (e.g.
+ * after packets have been lost), the slots are given to the streams in the 
+ * order of their earliest (absolute) deadline. The slots in the schedule are
+ * sorted by node ID.
+ * There is always one contention slot per round.
+ */
+ 
+#include "lwb.h"
+
+#ifdef LWB_SCHED_EDF
+
+#if !defined(LWB_CONF_STREAM_EXTRA_DATA_LEN) || \
+    (LWB_CONF_STREAM_EXTRA_DATA_LEN != 2)
+#error "LWB_CONF_STREAM_EXTRA_DATA_LEN not set to 2!"
+#endif
+#if LWB_CONF_SCHED_STREAM_ARRAYS || LWB_CONF_SCHED_USE_XMEM
+#error "the EDF scheduler only supports a stream list in SRAM"
+#endif
+
+/* max. number of data slots per round for the streams (1 slot is kept for 
+ * the host) */
+#define SLOTS_AVAILABLE     (LWB_CONF_MAX_DATA_SLOTS - 1)
+/* max. duration of a round in seconds (rounded up) */
+#define T_ROUND_SEC         (((uint32_t)LWB_T_ROUND_MAX + RTIMER_SECOND_HF - 1) \
+                             / RTIMER_SECOND_HF)
+
+#ifndef MIN
+#define MIN(x, y)           ((x) < (y) ? (x) : (y))
+#endif /* MIN */
+#ifndef MAX
+#define MAX(x, y)           ((x) > (y) ? (x) : (y))
+#endif /* MAX */
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief struct to store information about active streams on the host
+ */
+typedef struct stream_info {
+  struct stream_info *next;
+  uint16_t id;
+  uint16_t ipi;
+  uint16_t deadline;                         /* in seconds, 0 = no deadline */
+  uint32_t last_assigned;
+  uint8_t  stream_id;
+  uint8_t  n_cons_missed;
+  uint8_t  n_due;          /* # packets due in this round according to IPI */
+  uint8_t  n_slots;                 /* # slots requested/assigned this round */
+} lwb_stream_list_t;
+/*---------------------------------------------------------------------------*/
+static uint16_t           period;
+static uint16_t           max_period;      /* longest period for all streams */
+static uint32_t           time;                               /* global time */
+static uint16_t           n_streams;                            /* # streams */
+static uint8_t            n_slots_assigned;              /* # slots assigned */
+static uint16_t           used_slots;   /* # slots per round for max_period */
+static volatile uint8_t   n_pending_sack = 0;
+/* factor of 4 because of the memory alignment and faster index calculation! */
+static uint8_t            pending_sack[4 * LWB_CONF_SCHED_SACK_BUFFER_SIZE]; 
+/* number of streams per IPI, the last element counts the streams with an 
+ * IPI of LWB_CONF_SCHED_PERIOD_MAX or more */
+static uint16_t           n_per_ipi[LWB_CONF_SCHED_PERIOD_MAX + 1];
+/* number of streams per upper bound on the period (deadline - duration of a 
+ * round), the last element counts the streams without a (binding) deadline */
+static uint16_t           n_per_bound[LWB_CONF_SCHED_PERIOD_MAX + 1];
+LIST(streams_list);                    /* -> lists only work for data in RAM */
+/* data structures to hold the stream info */
+MEMB(streams_memb, lwb_stream_list_t, LWB_CONF_MAX_N_STREAMS);
+/* the streams are updated incrementally while the data slots of a round are
+ * processed (see lwb_sched_proc_slot) */
+static uint8_t            update_started;
+static uint8_t            update_slot_pos; /* current position in schedule */
+static lwb_stream_list_t* update_pos;            /* next stream to update */
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief add or remove a stream to/from the number of streams per IPI and
+ * per period bound
+ * @param[in] ipi the IPI of the stream
+ * @param[in] deadline the deadline of the stream
+ * @param[in] add 1 to add the stream, 0 to remove it
+ */
+static inline void
+lwb_sched_count_stream(uint16_t ipi, uint16_t deadline, uint8_t add)
+{
+  uint16_t bound = LWB_CONF_SCHED_PERIOD_MAX;
+  if(deadline) {
+    bound = (deadline > T_ROUND_SEC) ? (deadline - T_ROUND_SEC) : 0;
+  }
+  ipi   = MIN(ipi, LWB_CONF_SCHED_PERIOD_MAX);
+  bound = MIN(bound, LWB_CONF_SCHED_PERIOD_MAX);
+  if(add) {
+    n_per_ipi[ipi]++;
+    n_per_bound[bound]++;
+  } else {
+    n_per_ipi[ipi]--;
+    n_per_bound[bound]--;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief the number of slots per round required by all streams for a 
+ * certain round period
+ * @param[in] t the round period in seconds (max. LWB_CONF_SCHED_PERIOD_MAX)
+ * @return the sum of ceil(t / IPI) over all streams
+ */
+static uint16_t
+lwb_sched_get_demand(uint16_t t)
+{
+  /* for t <= LWB_CONF_SCHED_PERIOD_MAX, ceil(t / IPI) is 1 for all streams 
+   * in the last element */
+  uint32_t demand = n_per_ipi[LWB_CONF_SCHED_PERIOD_MAX];
+  uint16_t ipi;
+  for(ipi = 1; ipi < LWB_CONF_SCHED_PERIOD_MAX; ipi++) {
+    if(n_per_ipi[ipi]) {
+      demand += (uint32_t)n_per_ipi[ipi] * ((t + ipi - 1) / ipi);
+    }
+  }
+  return (demand > 0xffff) ? 0xffff : demand;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief computes the longest round period for which all streams meet their
+ * deadline
+ * @return the period in seconds or 0 if the streams are not schedulable
+ */
+static uint16_t
+lwb_sched_get_max_period(void)
+{
+  uint16_t lo = LWB_CONF_SCHED_PERIOD_MIN;
+  uint16_t hi = LWB_CONF_SCHED_PERIOD_MAX;
+  uint16_t i;
+  /* the shortest deadline limits the period */
+  for(i = 0; i < LWB_CONF_SCHED_PERIOD_MAX; i++) {
+    if(n_per_bound[i]) {
+      hi = i;
+      break;
+    }
+  }
+  if(hi < lo || lwb_sched_get_demand(lo) > SLOTS_AVAILABLE) {
+    return 0;
+  }
+  /* the demand increases with the period: binary search */
+  while(lo < hi) {
+    i = (lo + hi + 1) / 2;
+    if(lwb_sched_get_demand(i) <= SLOTS_AVAILABLE) {
+      lo = i;
+    } else {
+      hi = i - 1;
+    }
+  }
+  return lo;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief checks whether the packets of a stream can't wait until they are 
+ * due according to the IPI, i.e. whether the stream needs slots in every 
+ * round
+ */
+static inline uint8_t
+lwb_sched_is_tight(const lwb_stream_list_t* stream)
+{
+  return stream->deadline && 
+         (stream->deadline < (uint32_t)stream->ipi + period + T_ROUND_SEC);
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief the absolute deadline of the oldest packet of a stream which has 
+ * not been assigned a slot yet (streams without deadline come last, in the
+ * order of their oldest packet)
+ */
+static inline uint32_t
+lwb_sched_get_abs_deadline(const lwb_stream_list_t* stream)
+{
+  if(!stream->deadline) {
+    return stream->last_assigned + stream->ipi + 0xffff;
+  }
+  if(lwb_sched_is_tight(stream)) {
+    /* the packet may have been generated right after the last round */
+    return time - period + stream->deadline;
+  }
+  return stream->last_assigned + stream->ipi + stream->deadline;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief   look up a stream in the stream list on the host
+ * @param[in] id node ID
+ * @param[in] stream_id stream ID
+ * @return the stream info or 0 if the stream does not exist
+ */
+static inline lwb_stream_list_t*
+lwb_sched_get_stream(uint16_t id, uint8_t stream_id)
+{
+#if LWB_CONF_SCHED_HASH_INDEX
+  uint16_t pos = lwb_sched_index_get(id, stream_id);
+  if(pos == LWB_SCHED_INDEX_INVALID) {
+    return 0;
+  }
+  return (lwb_stream_list_t*)streams_memb.mem + pos;
+#else /* LWB_CONF_SCHED_HASH_INDEX */
+  lwb_stream_list_t *s;
+  for(s = list_head(streams_list); s != 0; s = s->next) {
+    if(id == s->id && stream_id == s->stream_id) {
+      break;
+    }
+  }
+  return s;
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief   remove a stream from the stream list on the host
+ * @param[in] the stream to remove
+ */
+static inline void 
+lwb_sched_del_stream(lwb_stream_list_t* stream) 
+{
+  if(0 == stream) {    
+    return;  /* entry not found, don't do anything */
+  }
+  uint16_t node   = stream->id;
+  uint8_t  stream_id = stream->stream_id;
+  lwb_sched_count_stream(stream->ipi, stream->deadline, 0);
+#if LWB_CONF_SCHED_HASH_INDEX
+  lwb_sched_index_remove(node, stream_id);
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+  if(stream == update_pos) {
+    update_pos = stream->next;
+  }
+  list_remove(streams_list, stream);
+  memb_free(&streams_memb, stream);
+  n_streams--;
+  /* the remaining streams are always schedulable */
+  max_period = n_streams ? lwb_sched_get_max_period() : 
+                           LWB_CONF_SCHED_PERIOD_IDLE;
+  used_slots = lwb_sched_get_demand(max_period);
+#if LWB_CONF_SCHED_VAR_SLOTS
+  lwb_sched_slot_len_remove(node, stream_id);
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+  DEBUG_PRINT_INFO("stream %u.%u removed", node, stream_id);
+}
+/*---------------------------------------------------------------------------*/
+uint8_t 
+lwb_sched_prepare_sack(void *payload) 
+{
+  if(n_pending_sack) {
+    DEBUG_PRINT_VERBOSE("%u S-ACKs pending", n_pending_sack);
+    memcpy(payload, pending_sack, n_pending_sack * 4);
+    ((lwb_stream_ack_t*)payload)->n_extra = n_pending_sack - 1;
+    n_pending_sack = 0;
+    return (((lwb_stream_ack_t*)payload)->n_extra + 1) * 4;
+  }
+  return 0;         /* return the length of the packet */
+}
+/*---------------------------------------------------------------------------*/
+void 
+lwb_sched_proc_srq(const lwb_stream_req_t* req) 
+{
+  lwb_stream_list_t *s = 0;
+  uint16_t deadline;
+  uint16_t t;
+  
+  if(LWB_INVALID_STREAM_ID == req->stream_id) { 
+    DEBUG_PRINT_WARNING("invalid stream request");
+    return; 
+  }  
+  if(n_pending_sack >= LWB_CONF_SCHED_SACK_BUFFER_SIZE) {
+    DEBUG_PRINT_WARNING("max. number of pending sack's reached, stream request"
+                        " dropped");
+    return;
+  }
+  
+  /* add and remove requests are implicitly given by the ipi
+   * an ipi of 0 implies 'remove' */
+  if(req->ipi > 0) { 
+    deadline = LWB_STREAM_REQ_GET_DEADLINE(req);
+    /* check if stream already exists */
+    s = lwb_sched_get_stream(req->id, req->stream_id);
+    if(s) {
+      /* admission test with the new parameters */
+      lwb_sched_count_stream(s->ipi, s->deadline, 0);
+      lwb_sched_count_stream(req->ipi, deadline, 1);
+      t = lwb_sched_get_max_period();
+      if(!t) {
+        /* keep the stream with the old parameters */
+        lwb_sched_count_stream(req->ipi, deadline, 0);
+        lwb_sched_count_stream(s->ipi, s->deadline, 1);
+        DEBUG_PRINT_WARNING("stream request %u.%u dropped, not schedulable", 
+                            req->id, req->stream_id);
+        return;
+      }
+      /* already exists -> update the IPI and deadline... */
+      s->ipi = req->ipi;
+      s->deadline = deadline;
+      s->last_assigned = time;
+      s->n_cons_missed = 0;         /* reset this counter */
+      max_period = t;
+      used_slots = lwb_sched_get_demand(t);
+      DEBUG_PRINT_INFO("stream %u.%u updated (IPI %u, deadline %u)", 
+                       req->id, req->stream_id, req->ipi, deadline);
+      goto add_sack;
+    }
+    
+    /* does not exist: add the new stream */
+    if(n_streams >= LWB_CONF_MAX_N_STREAMS) {
+      DEBUG_PRINT_WARNING("stream request %u.%u dropped, max #streams reached", 
+                          req->id, req->stream_id);
+      return;
+    }
+    /* admission test: is there a period for which all streams (including 
+     * the new one) meet their deadlines? */
+    lwb_sched_count_stream(req->ipi, deadline, 1);
+    t = lwb_sched_get_max_period();
+    if(!t) {
+      lwb_sched_count_stream(req->ipi, deadline, 0);
+      DEBUG_PRINT_WARNING("stream request %u.%u dropped, not schedulable", 
+                          req->id, req->stream_id);
+      return;
+    }
+    s = memb_alloc(&streams_memb);
+    if(s == 0) {
+      lwb_sched_count_stream(req->ipi, deadline, 0);
+      DEBUG_PRINT_ERROR("out of memory: stream request dropped");
+      return;
+    }
+    s->id            = req->id;
+    s->ipi           = req->ipi;
+    s->deadline      = deadline;
+    s->last_assigned = time;
+    s->stream_id     = req->stream_id;
+    s->n_cons_missed = 0;
+    s->n_due         = 0;
+    s->n_slots       = 0;
+#if LWB_CONF_SCHED_HASH_INDEX
+    lwb_sched_index_add(req->id, req->stream_id, 
+                        s - (lwb_stream_list_t*)streams_memb.mem);
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+    /* insert the stream into the list, ordered by node id */
+    lwb_stream_list_t *prev;
+    for(prev = list_head(streams_list); prev != NULL; prev = prev->next) {
+      if((req->id >= prev->id) && ((prev->next == NULL) || 
+         (req->id < prev->next->id))) {
+        break;
+      }
+    }
+    list_insert(streams_list, prev, s);   
+    n_streams++;
+    max_period = t;
+    used_slots = lwb_sched_get_demand(t);
+    DEBUG_PRINT_INFO("stream %u.%u added (IPI %u, deadline %u)", req->id, 
+                     req->stream_id, req->ipi, deadline);         
+  } else {
+    /* remove this stream */
+    lwb_sched_del_stream(lwb_sched_get_stream(req->id, req->stream_id));
+  }
+  
+add_sack:
+#if LWB_CONF_SCHED_VAR_SLOTS
+  lwb_sched_slot_len_update(req);
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+  /* insert into the list of pending S-ACKs */
+  /* use memcpy to avoid pointer misalignment errors */
+  memcpy(pending_sack + n_pending_sack * 4, &req->id, 2);  
+  pending_sack[n_pending_sack * 4 + 2] = req->stream_id;
+  n_pending_sack++;   
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief checks whether a packet of the stream id/stream_id has been received
+ * in the last round (merge-join of the stream list and the schedule)
+ * @param[in] id the node ID to search for
+ * @param[in] stream_id the stream ID to search for
+ * @param[in] node_list the node IDs of the data slots of the last round
+ * @param[in] stream_list the stream IDs of the packets received in these 
+ * slots (LWB_INVALID_STREAM_ID if no packet was received)
+ * @param[in] list_len the number of entries in the node and stream list
+ * @param[in,out] pos the current position in the node and stream list, must
+ * be set to zero before the first call
+ * @return one if the id/stream_id exists in the list, zero otherwise
+ * @remark the function must be called for the streams in increasing order 
+ * of their node IDs (see sched-min-delay.c)
+ */
+static inline uint8_t 
+lwb_sched_stream_in_list(uint16_t id, 
+                         uint8_t stream_id, 
+                         const uint16_t* node_list, 
+                         const uint8_t* stream_list, 
+                         uint8_t list_len,
+                         uint8_t* pos) 
+{
+  uint8_t i = *pos;
+  /* skip the slots of nodes with a smaller ID and the slots without a 
+   * received packet */
+  while(i < list_len && 
+        (node_list[i] < id || stream_list[i] == LWB_INVALID_STREAM_ID)) {
+    i++;
+  }
+  *pos = i;
+  /* a node may have several streams: check all slots of this node */
+  while(i < list_len && node_list[i] == id) {
+    if(stream_list[i] == stream_id) {
+      return 1;
+    }
+    i++;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief updates the streams of the nodes up to last_id according to the 
+ * packets received in the current round and removes the streams with too
+ * many consecutive misses (first part of the schedule computation)
+ * @param[in] sched the schedule of the current round
+ * @param[in] streams_to_update the stream IDs of the received packets
+ * @param[in] n_slots the number of data slots processed so far
+ * @param[in] last_id the largest node ID whose data slots are all known
+ */
+static void
+lwb_sched_update_streams(const lwb_schedule_t * const sched, 
+                         const uint8_t * const streams_to_update, 
+                         uint8_t n_slots,
+                         uint16_t last_id)
+{
+  lwb_stream_list_t *curr_stream;
+  if(!update_started) {
+    update_started = 1;
+    update_slot_pos = 0;
+    update_pos = list_head(streams_list);
+  }
+  while(update_pos != NULL && update_pos->id <= last_id) {
+    curr_stream = update_pos;
+    update_pos = curr_stream->next;
+    if(lwb_sched_stream_in_list(curr_stream->id, curr_stream->stream_id, 
+        sched->slot, streams_to_update, n_slots, &update_slot_pos)) {
+      curr_stream->n_cons_missed = 0;
+    } else if(curr_stream->n_cons_missed & 0x80) {
+      /* no packet received from this stream */
+      curr_stream->n_cons_missed &= 0x7f; /* clear the last bit */
+      curr_stream->n_cons_missed++;
+    }
+    if(curr_stream->n_cons_missed > LWB_CONF_SCHED_STREAM_REMOVAL_THRES) {
+      /* too many consecutive slots without reception: delete this stream */
+      lwb_sched_del_stream(curr_stream);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void 
+lwb_sched_proc_slot(const lwb_schedule_t * const sched,
+                    const uint8_t * const streams_to_update,
+                    uint8_t slot_idx)
+{
+  uint16_t last_id = LWB_SCHED_LAST_KNOWN_ID(sched, slot_idx);
+  if(last_id) {
+    lwb_sched_update_streams(sched, streams_to_update, slot_idx + 1, last_id);
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint16_t 
+lwb_sched_compute(lwb_schedule_t * const sched, 
+                  const uint8_t * const streams_to_update, 
+                  uint8_t reserve_slot_host) 
+{
+  uint16_t n_requested = 0;
+  uint8_t  n_free;
+  lwb_stream_list_t *curr_stream;
+  
+  n_slots_assigned = 0;
+  
+  /* update the remaining streams (all streams if lwb_sched_proc_slot() has
+   * not been called in this round) */
+  lwb_sched_update_streams(sched, streams_to_update, 
+                           LWB_SCHED_N_SLOTS(sched), 0xffff);
+  update_started = 0;
+  /* clear the content of the schedule (do NOT move this line further above!)*/
+  memset(sched->slot, 0, sizeof(sched->slot));  
+  
+  /* assign slots to the host */
+  if(reserve_slot_host) {
+    DEBUG_PRINT_INFO("assigning a slot to the host");
+    sched->slot[0] = node_id;
+    n_slots_assigned++;
+  }
+  
+  /* the longest period for which all streams meet their deadline */
+  period = max_period; 
+  time += period;   /* increment time by the current period */
+
+  if(n_streams == 0) {
+    /* no streams to process */
+    goto set_schedule;
+  }
+
+  /* the number of slots each stream requests in this round */
+  for(curr_stream = list_head(streams_list); curr_stream != NULL; 
+      curr_stream = curr_stream->next) {
+    uint32_t n = 0;
+    if(time >= (curr_stream->ipi + curr_stream->last_assigned)) {
+      n = (time - curr_stream->last_assigned) / curr_stream->ipi;
+      n = MIN(n, LWB_CONF_MAX_DATA_SLOTS);
+    }
+    curr_stream->n_due = n;
+    if(lwb_sched_is_tight(curr_stream)) {
+      /* the packets can't wait until they are due: reserve slots in every 
+       * round */
+      n = MAX(n, ((uint32_t)period + curr_stream->ipi - 1) / 
+                 curr_stream->ipi);
+    }
+    curr_stream->n_slots = n;
+    n_requested += n;
+  }
+  
+  n_free = LWB_CONF_MAX_DATA_SLOTS - n_slots_assigned;
+  if(n_requested > n_free) {
+    /* not enough slots: assign them in the order of the earliest deadline,
+     * the last bit of n_slots marks the streams already processed */
+    DEBUG_PRINT_VERBOSE("%u slots requested, %u available", n_requested, 
+                        n_free);
+    while(n_free) {
+      lwb_stream_list_t *next_stream = NULL;
+      uint32_t min_deadline = 0;
+      for(curr_stream = list_head(streams_list); curr_stream != NULL; 
+          curr_stream = curr_stream->next) {
+        if(curr_stream->n_slots && !(curr_stream->n_slots & 0x80)) {
+          uint32_t d = lwb_sched_get_abs_deadline(curr_stream);
+          if(next_stream == NULL || d < min_deadline) {
+            next_stream = curr_stream;
+            min_deadline = d;
+          }
+        }
+      }
+      if(next_stream == NULL) {
+        break;
+      }
+      next_stream->n_slots = MIN(next_stream->n_slots, n_free);
+      n_free -= next_stream->n_slots;
+      next_stream->n_slots |= 0x80;
+    }
+    for(curr_stream = list_head(streams_list); curr_stream != NULL; 
+        curr_stream = curr_stream->next) {
+      curr_stream->n_slots = (curr_stream->n_slots & 0x80) ? 
+                             (curr_stream->n_slots & 0x7f) : 0;
+    }
+  }
+  
+  /* assign the slots, the streams are sorted by node ID */
+  for(curr_stream = list_head(streams_list); curr_stream != NULL; 
+      curr_stream = curr_stream->next) {
+    uint8_t n;
+    for(n = 0; n < curr_stream->n_slots; n++, n_slots_assigned++) {
+      sched->slot[n_slots_assigned] = curr_stream->id;
+    }
+    n = MIN(curr_stream->n_slots, curr_stream->n_due);
+    if(n) {
+      curr_stream->last_assigned += (uint32_t)n * curr_stream->ipi;
+      /* set the last bit, we are expecting a packet from this stream in 
+       * the next round */
+      curr_stream->n_cons_missed |= 0x80; 
+    }
+  }
+  
+set_schedule:
+#if LWB_CONF_DATA_QUEUE_DEPTH
+  n_slots_assigned = lwb_sched_add_queue_depth_slots(sched, n_slots_assigned);
+#endif /* LWB_CONF_DATA_QUEUE_DEPTH */
+  sched->n_slots = n_slots_assigned;
+  if(n_pending_sack) {
+    LWB_SCHED_SET_SACK_SLOT(sched);
+  }  
+  /* always schedule a contention slot! */
+  LWB_SCHED_SET_CONT_SLOT(sched);
+  
+  uint8_t compressed_size;
+#if LWB_CONF_SCHED_VAR_SLOTS
+  lwb_sched_set_slot_len(sched);   /* before the slots are compressed */
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+#if LWB_CONF_SCHED_COMPRESS
+  compressed_size = lwb_sched_compress(sched);
+  if((compressed_size + LWB_SCHED_PKT_HEADER_LEN) > LWB_CONF_MAX_PKT_LEN) {
+    DEBUG_PRINT_ERROR("compressed schedule is too big!");
+  }
+#else
+  compressed_size = n_slots_assigned * 2;
+#endif /* LWB_CONF_SCHED_COMPRESS */
+
+  /* this schedule is sent at the end of a round: do not communicate 
+   * (i.e. do not set the first bit of period) */
+  sched->period = period;   /* no need to clear the last bit */
+  sched->time   = time;
+    
+  /* log the parameters of the new schedule */
+  DEBUG_PRINT_INFO("schedule updated (s=%u T=%u n=%u|%u len=%u load=%u%%)", 
+                   n_streams, sched->period, n_slots_assigned, 
+                   sched->n_slots >> 14, compressed_size,
+                   (uint16_t)(used_slots * 100 / SLOTS_AVAILABLE));
+  
+  return compressed_size + LWB_SCHED_PKT_HEADER_LEN;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t 
+lwb_sched_init(lwb_schedule_t* sched) 
+{
+  /* initialize streams member and list */
+  memb_init(&streams_memb);
+  list_init(streams_list);
+#if LWB_CONF_SCHED_HASH_INDEX
+  lwb_sched_index_init();
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+#if LWB_CONF_SCHED_VAR_SLOTS
+  lwb_sched_slot_len_init();
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+#if LWB_CONF_DATA_QUEUE_DEPTH
+  lwb_sched_queue_depth_init();
+#endif /* LWB_CONF_DATA_QUEUE_DEPTH */
+  memset(n_per_ipi, 0, sizeof(n_per_ipi));
+  memset(n_per_bound, 0, sizeof(n_per_bound));
+  n_streams = 0;
+  n_slots_assigned = 0;
+  n_pending_sack = 0;
+  used_slots = 0;
+  update_started = 0;
+  time = 0;                             /* global time starts now */
+  period = LWB_CONF_SCHED_PERIOD_IDLE; 
+  max_period = LWB_CONF_SCHED_PERIOD_IDLE;
+  sched->n_slots = 0;
+  LWB_SCHED_SET_CONT_SLOT(sched);       /* include a contention slot */
+  sched->time = time;
+  sched->period = period;
+  /* mark as the first schedule (beginning of a round) */
+  LWB_SCHED_SET_AS_1ST(sched); 
+  
+  DEBUG_PRINT_INFO("EDF scheduler initialized (max streams: %u)", 
+                   LWB_CONF_MAX_N_STREAMS);
+  
+  return LWB_SCHED_PKT_HEADER_LEN; /* empty schedule, no slots allocated yet */
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+lwb_sched_set_time(lwb_schedule_t* sched, uint32_t t)
+{
+  time = t;     /* the streams are kept */
+  if(sched) {
+    sched->n_slots = 0;
+    LWB_SCHED_SET_CONT_SLOT(sched);     /* include a contention slot */
+    sched->time = time;
+    sched->period = period;
+    LWB_SCHED_SET_AS_1ST(sched); 
+  }
+  return LWB_SCHED_PKT_HEADER_LEN;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+lwb_sched_get_n_streams(void)
+{
+  return n_streams;
+}
+/*---------------------------------------------------------------------------*/
+
+#endif /* LWB_SCHED_EDF */
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @addtogroup  lwb-scheduler
+ * @{
+ *
+ * @defgroup    sched-index Stream index
+ * @{
+ *
+ * @file 
+ * @brief hash index for the stream info on the host
+ *
+ * Maps a stream (node ID and stream ID) to the position of its stream info
+ * in the memory block of the scheduler. The table uses open addressing with
+ * linear probing; entries are removed by shifting the following entries of 
+ * the same cluster back (no tombstones), i.e. the lookup time does not 
+ * degrade over time.
+ * The ordered stream list of the scheduler is not affected by this index.
+ */
+ 
+#include "lwb.h"
+
+#if LWB_CONF_SCHED_HASH_INDEX
+
+/* the table size must be a power of 2 and at least 2x the max. number of 
+ * streams to keep the load factor below 0.5 */
+#if LWB_CONF_MAX_N_STREAMS <= 8
+#define SCHED_INDEX_BITS        4
+#elif LWB_CONF_MAX_N_STREAMS <= 16
+#define SCHED_INDEX_BITS        5
+#elif LWB_CONF_MAX_N_STREAMS <= 32
+#define SCHED_INDEX_BITS        6
+#elif LWB_CONF_MAX_N_STREAMS <= 64
+#define SCHED_INDEX_BITS        7
+#elif LWB_CONF_MAX_N_STREAMS <= 128
+#define SCHED_INDEX_BITS        8
+#elif LWB_CONF_MAX_N_STREAMS <= 256
+#define SCHED_INDEX_BITS        9
+#elif LWB_CONF_MAX_N_STREAMS <= 512
+#define SCHED_INDEX_BITS        10
+#else
+#error "LWB_CONF_MAX_N_STREAMS too big for the stream index"
+#endif
+#define SCHED_INDEX_SIZE        (1 << SCHED_INDEX_BITS)
+#define SCHED_INDEX_MASK        (SCHED_INDEX_SIZE - 1)
+
+/* multiplicative (Fibonacci) hashing, the upper bits of the product are 
+ * used as the index */
+#define SCHED_INDEX_HASH(id, stream_id) \
+  ((uint16_t)((uint16_t)((id) ^ ((uint16_t)(stream_id) << 8)) * 40503U) >> \
+   (16 - SCHED_INDEX_BITS))
+/*---------------------------------------------------------------------------*/
+typedef struct {
+  uint16_t id;
+  uint16_t pos;           /* LWB_SCHED_INDEX_INVALID marks an empty entry */
+  uint8_t  stream_id;
+} sched_index_entry_t;
+/*---------------------------------------------------------------------------*/
+static sched_index_entry_t index_table[SCHED_INDEX_SIZE];
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief returns the table position of a stream or of the empty entry where
+ * the stream would be inserted
+ */
+static inline uint16_t
+lwb_sched_index_find(uint16_t id, uint8_t stream_id)
+{
+  uint16_t i = SCHED_INDEX_HASH(id, stream_id);
+  /* terminates since the table is never full */
+  while(index_table[i].pos != LWB_SCHED_INDEX_INVALID) {
+    if(index_table[i].id == id && index_table[i].stream_id == stream_id) {
+      break;
+    }
+    i = (i + 1) & SCHED_INDEX_MASK;
+  }
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+void
+lwb_sched_index_init(void)
+{
+  uint16_t i;
+  for(i = 0; i < SCHED_INDEX_SIZE; i++) {
+    index_table[i].pos = LWB_SCHED_INDEX_INVALID;
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+lwb_sched_index_add(uint16_t id, uint8_t stream_id, uint16_t pos)
+{
+  if(pos >= LWB_CONF_MAX_N_STREAMS) {
+    DEBUG_PRINT_ERROR("invalid stream index position");
+    return 0;
+  }
+  uint16_t i = lwb_sched_index_find(id, stream_id);
+  index_table[i].id        = id;
+  index_table[i].stream_id = stream_id;
+  index_table[i].pos       = pos;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+lwb_sched_index_get(uint16_t id, uint8_t stream_id)
+{
+  return index_table[lwb_sched_index_find(id, stream_id)].pos;
+}
+/*---------------------------------------------------------------------------*/
+void
+lwb_sched_index_remove(uint16_t id, uint8_t stream_id)
+{
+  uint16_t i = lwb_sched_index_find(id, stream_id);
+  uint16_t j = i;
+  if(index_table[i].pos == LWB_SCHED_INDEX_INVALID) {
+    return;                                                 /* not found */
+  }
+  /* shift back all following entries of this cluster which are not at 
+   * their home position, i.e. whose home position is not within (i, j] */
+  while(1) {
+    j = (j + 1) & SCHED_INDEX_MASK;
+    if(index_table[j].pos == LWB_SCHED_INDEX_INVALID) {
+      break;
+    }
+    uint16_t k = SCHED_INDEX_HASH(index_table[j].id, 
+                                  index_table[j].stream_id);
+    if(((j - k) & SCHED_INDEX_MASK) >= ((j - i) & SCHED_INDEX_MASK)) {
+      index_table[i] = index_table[j];
+      i = j;
+    }
+  }
+  index_table[i].pos = LWB_SCHED_INDEX_INVALID;
+}
+/*---------------------------------------------------------------------------*/
+
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+
+/**
+ * @}
+ * @}
+ */
@@ -67,6 +67,15 @@
 #error "LWB_CONF_STREAM_EXTRA_DATA_LEN not set to 1!"
 #endif
 
+/* the data rate of a stream (1 / IPI in packets per second) as a fixed-point
+ * number with LWB_SCHED_RATE_SHIFT fractional bits, rounded up; the aggregate
+ * rate overestimates the demand by less than n_streams / 2^16 packets per
+ * second, i.e. the period never exceeds the optimum but may be one below it
+ * if the optimum is within this margin of an integer; the sum does not
+ * overflow for less than 2^16 streams */
+#define LWB_SCHED_RATE_SHIFT    16
+#define LWB_SCHED_RATE(ipi)     ((((uint32_t)1 << LWB_SCHED_RATE_SHIFT) + \
+                                  (ipi) - 1) / (ipi))
 /*---------------------------------------------------------------------------*/
 typedef struct {
   /* starting time offset (necessary to get rid of e.g. a backlog of messages 
@@ -98,8 +107,6 @@ typedef struct stream_info {
   uint8_t  n_cons_missed;
 } lwb_stream_list_t;
 /*---------------------------------------------------------------------------*/
-uint16_t lwb_sched_compress(uint8_t* compressed_data, uint8_t n_slots);
-/*---------------------------------------------------------------------------*/
 static uint16_t          period;
 static uint32_t          time;               /* global time */
 static uint16_t          n_streams;          /* # streams */
@@ -107,12 +114,20 @@ static lwb_sched_stats_t sched_stats = { 0 };
 static uint8_t           first_index;        /* offset for the stream list */
 static uint8_t           n_slots_assigned;   /* # assigned slots */
 static uint8_t           saturated = 0;
-static uint32_t          data_cnt;
-static uint16_t          data_ipi;
+/* aggregate data rate of all streams (sum of LWB_SCHED_RATE(ipi)), updated 
+ * whenever a stream is added, updated or removed */
+static uint32_t          data_rate;
 static volatile uint8_t  n_pending_sack = 0;
 /* factor of 4 because of the memory alignment and faster index calculation! */
 static uint8_t           pending_sack[4 * LWB_CONF_SCHED_SACK_BUFFER_SIZE]; 
-#if !LWB_CONF_SCHED_USE_XMEM
+/* the streams are updated incrementally while the data slots of a round are
+ * processed (see lwb_sched_proc_slot) */
+static uint8_t           update_started;
+static uint8_t           update_slot_pos;  /* current position in schedule */
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+  /* the stream info, sorted by node ID */
+  static lwb_sched_streams_t streams;
+#elif !LWB_CONF_SCHED_USE_XMEM
   /* a list of pointers to the stream info structures, for faster access 
    * (constant time vs. linear time) */
   static lwb_stream_list_t  *streams[LWB_CONF_MAX_DATA_SLOTS];   
@@ -125,6 +140,209 @@ static uint8_t           pending_sack[4 * LWB_CONF_SCHED_SACK_BUFFER_SIZE];
   static uint32_t streams_list = MEMBX_INVALID_ADDR;  
   /* data structures to hold the stream info */
   MEMBX(streams_memb, sizeof(lwb_stream_list_t), LWB_CONF_MAX_N_STREAMS);
+#if LWB_CONF_SCHED_XMEM_CACHE_SIZE
+  /**
+   * @brief an entry of the write-back cache for the stream info in the 
+   * external memory
+   */
+  typedef struct {
+    uint32_t          addr;   /* MEMBX_INVALID_ADDR if the entry is unused */
+    uint8_t           dirty;  /* not yet written back to the ext. memory */
+    lwb_stream_list_t stream;
+  } lwb_stream_cache_t;
+  /* direct-mapped cache, indexed by the memory block index */
+  static lwb_stream_cache_t stream_cache[LWB_CONF_SCHED_XMEM_CACHE_SIZE];
+#endif /* LWB_CONF_SCHED_XMEM_CACHE_SIZE */
+#endif /* LWB_CONF_SCHED_USE_XMEM */
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+  static uint16_t           update_pos;          /* next stream to update */
+#elif !LWB_CONF_SCHED_USE_XMEM
+  static lwb_stream_list_t* update_pos;
+#else /* LWB_CONF_SCHED_USE_XMEM */
+  static uint32_t           update_pos;
+  /* the last updated stream (hint for lwb_sched_del_stream) */
+  static uint32_t           update_prev;
+#endif /* LWB_CONF_SCHED_USE_XMEM */
+/*---------------------------------------------------------------------------*/
+#if LWB_CONF_SCHED_USE_XMEM
+#if LWB_CONF_SCHED_XMEM_CACHE_SIZE
+/* the cache entry for the stream info at address addr */
+#define LWB_SCHED_CACHE_ENTRY(addr) \
+  (&stream_cache[((addr) - streams_memb.mem) / sizeof(lwb_stream_list_t) & \
+                 (LWB_CONF_SCHED_XMEM_CACHE_SIZE - 1)])
+#endif /* LWB_CONF_SCHED_XMEM_CACHE_SIZE */
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief load the stream info at address addr from the external memory 
+ * (or the cache)
+ * @remark an entry of the cache is only allocated if it is unused: the 
+ * stream list is traversed in the same order every round and replacing the
+ * entries in such a cyclic access pattern would result in a miss for each 
+ * access if there are more streams than cache entries
+ */
+static inline void
+lwb_sched_stream_read(uint32_t addr, lwb_stream_list_t* stream)
+{
+#if LWB_CONF_SCHED_XMEM_CACHE_SIZE
+  lwb_stream_cache_t* e = LWB_SCHED_CACHE_ENTRY(addr);
+  if(e->addr == addr) {
+    memcpy(stream, &e->stream, sizeof(lwb_stream_list_t));
+    return;
+  }
+  xmem_read(addr, sizeof(lwb_stream_list_t), (uint8_t*)stream);
+  if(e->addr == MEMBX_INVALID_ADDR) {
+    memcpy(&e->stream, stream, sizeof(lwb_stream_list_t));
+    e->addr = addr;
+  }
+#else /* LWB_CONF_SCHED_XMEM_CACHE_SIZE */
+  xmem_read(addr, sizeof(lwb_stream_list_t), (uint8_t*)stream);
+#endif /* LWB_CONF_SCHED_XMEM_CACHE_SIZE */
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief store the stream info at address addr (if the stream is cached, the
+ * write to the external memory is deferred until lwb_sched_cache_flush())
+ */
+static inline void
+lwb_sched_stream_write(uint32_t addr, const lwb_stream_list_t* stream)
+{
+#if LWB_CONF_SCHED_XMEM_CACHE_SIZE
+  lwb_stream_cache_t* e = LWB_SCHED_CACHE_ENTRY(addr);
+  if(e->addr == addr || e->addr == MEMBX_INVALID_ADDR) {
+    memcpy(&e->stream, stream, sizeof(lwb_stream_list_t));
+    e->addr  = addr;
+    e->dirty = 1;
+    return;
+  }
+#endif /* LWB_CONF_SCHED_XMEM_CACHE_SIZE */
+  xmem_write(addr, sizeof(lwb_stream_list_t), (uint8_t*)stream);
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief write all modified stream info structures back to the external 
+ * memory, the cached content remains valid
+ */
+static inline void
+lwb_sched_cache_flush(void)
+{
+#if LWB_CONF_SCHED_XMEM_CACHE_SIZE
+  uint16_t i;
+  for(i = 0; i < LWB_CONF_SCHED_XMEM_CACHE_SIZE; i++) {
+    if(stream_cache[i].dirty) {
+      xmem_write(stream_cache[i].addr, sizeof(lwb_stream_list_t), 
+                 (uint8_t*)&stream_cache[i].stream);
+      stream_cache[i].dirty = 0;
+    }
+  }
+#endif /* LWB_CONF_SCHED_XMEM_CACHE_SIZE */
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief drop the stream info at address addr from the cache (without 
+ * writing it back), must be called when the memory block is freed
+ */
+static inline void
+lwb_sched_cache_invalidate(uint32_t addr)
+{
+#if LWB_CONF_SCHED_XMEM_CACHE_SIZE
+  lwb_stream_cache_t* e = LWB_SCHED_CACHE_ENTRY(addr);
+  if(e->addr == addr) {
+    e->addr  = MEMBX_INVALID_ADDR;
+    e->dirty = 0;
+  }
+#endif /* LWB_CONF_SCHED_XMEM_CACHE_SIZE */
+}
+#endif /* LWB_CONF_SCHED_USE_XMEM */
+/*---------------------------------------------------------------------------*/
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+/**
+ * @brief   look up a stream in the stream arrays on the host
+ * @param[in] id node ID
+ * @param[in] stream_id stream ID
+ * @return the position of the stream or LWB_SCHED_STREAMS_INVALID
+ */
+static inline uint16_t
+lwb_sched_get_stream(uint16_t id, uint8_t stream_id)
+{
+  return lwb_sched_streams_find(&streams, n_streams, id, stream_id);
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief   remove a stream from the stream arrays on the host
+ * @param[in] pos position of the stream to remove
+ */
+static inline void 
+lwb_sched_del_stream(uint16_t pos) 
+{
+  if(pos >= n_streams) {    
+    return;  /* entry not found, don't do anything */
+  }
+  uint16_t id  = streams.id[pos];
+  uint8_t  stream_id  = streams.stream_id[pos];
+  data_rate -= LWB_SCHED_RATE(streams.ipi[pos]);
+  if(update_started && pos < update_pos) {
+    update_pos--;
+  }
+  lwb_sched_streams_remove(&streams, n_streams, pos);
+  n_streams--;
+  sched_stats.n_deleted++;  
+#if LWB_CONF_SCHED_VAR_SLOTS
+  lwb_sched_slot_len_remove(id, stream_id);
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+  DEBUG_PRINT_INFO("stream %u.%u removed", id, stream_id);
+}
+#else /* LWB_CONF_SCHED_STREAM_ARRAYS */
+/**
+ * @brief   look up a stream in the stream list on the host
+ * @param[in] id node ID
+ * @param[in] stream_id stream ID
+ * @return the stream info (the address in the ext. mem. if 
+ * LWB_CONF_SCHED_USE_XMEM is enabled) or 0 (MEMBX_INVALID_ADDR) if the stream
+ * does not exist
+ */
+#if !LWB_CONF_SCHED_USE_XMEM
+static inline lwb_stream_list_t*
+lwb_sched_get_stream(uint16_t id, uint8_t stream_id)
+{
+#if LWB_CONF_SCHED_HASH_INDEX
+  uint16_t pos = lwb_sched_index_get(id, stream_id);
+  if(pos == LWB_SCHED_INDEX_INVALID) {
+    return 0;
+  }
+  return (lwb_stream_list_t*)streams_memb.mem + pos;
+#else /* LWB_CONF_SCHED_HASH_INDEX */
+  lwb_stream_list_t *s;
+  for(s = list_head(streams_list); s != 0; s = s->next) {
+    if(id == s->id && stream_id == s->stream_id) {
+      break;
+    }
+  }
+  return s;
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+}
+#else /* LWB_CONF_SCHED_USE_XMEM */
+static inline uint32_t
+lwb_sched_get_stream(uint16_t id, uint8_t stream_id)
+{
+#if LWB_CONF_SCHED_HASH_INDEX
+  uint16_t pos = lwb_sched_index_get(id, stream_id);
+  if(pos == LWB_SCHED_INDEX_INVALID) {
+    return MEMBX_INVALID_ADDR;
+  }
+  return streams_memb.mem + (uint32_t)pos * streams_memb.size;
+#else /* LWB_CONF_SCHED_HASH_INDEX */
+  lwb_stream_list_t s;
+  uint32_t stream_addr = streams_list;
+  while(stream_addr != MEMBX_INVALID_ADDR) {
+    lwb_sched_stream_read(stream_addr, &s);
+    if(id == s.id && stream_id == s.stream_id) {
+      break;
+    }
+    stream_addr = s.next;  /* go to the next address */ 
+  }
+  return stream_addr;
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+}
 #endif /* LWB_CONF_SCHED_USE_XMEM */
 /*---------------------------------------------------------------------------*/
 /**
@@ -141,56 +359,85 @@ lwb_sched_del_stream(lwb_stream_list_t* stream)
   }
   uint16_t id  = stream->id;
   uint8_t  stream_id  = stream->stream_id;
+  data_rate -= LWB_SCHED_RATE(stream->ipi);
+#if LWB_CONF_SCHED_HASH_INDEX
+  lwb_sched_index_remove(id, stream_id);
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+  if(stream == update_pos) {
+    update_pos = stream->next;
+  }
   list_remove(streams_list, stream);
   memb_free(&streams_memb, stream);
   n_streams--;
   sched_stats.n_deleted++;  
+#if LWB_CONF_SCHED_VAR_SLOTS
+  lwb_sched_slot_len_remove(id, stream_id);
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
   DEBUG_PRINT_INFO("stream %u.%u removed", id, stream_id);
 }
 #else
+/**
+ * @param[in] prev_addr address of the previous stream in the list if known,
+ * MEMBX_INVALID_ADDR otherwise (the list is searched)
+ */
 static void 
-lwb_sched_del_stream(uint32_t stream_addr) 
+lwb_sched_del_stream(uint32_t stream_addr, uint32_t prev_addr) 
 {
   if(stream_addr == MEMBX_INVALID_ADDR || streams_list == MEMBX_INVALID_ADDR) {    
     return;
   }  
   lwb_stream_list_t stream;
-  uint16_t    node;
-  uint8_t     stream_id;
-  xmem_read(stream_addr, sizeof(lwb_stream_list_t), (uint8_t*)&stream);
+  lwb_sched_stream_read(stream_addr, &stream);
   uint32_t next_addr = (uint32_t)stream.next; 
+  uint16_t ipi       = stream.ipi;
+  uint16_t node      = stream.id;
+  uint8_t  stream_id = stream.stream_id;
+  if(stream_addr == update_pos) {
+    update_pos = next_addr;
+  }
+  if(stream_addr == update_prev) {
+    update_prev = MEMBX_INVALID_ADDR;
+  }
   if(streams_list == stream_addr) {  /* special case: it's the first element */
-    node  = stream.id;
-    stream_id  = stream.stream_id;
     streams_list = next_addr; 
   } else {
-    uint32_t prev_addr = streams_list;
-    do {
-      xmem_read(prev_addr, sizeof(lwb_stream_list_t), (uint8_t*)&stream);
-      if(stream.next == stream_addr) {
-        node  = stream.id;
-        stream_id  = stream.stream_id;
-        break;
-      }
-      prev_addr = stream.next;
-    } while(prev_addr != MEMBX_INVALID_ADDR);
     if(prev_addr == MEMBX_INVALID_ADDR) {
-      /* not found! */
-      DEBUG_PRINT_WARNING("memory block not freed (invalid address)");
-      return;
+      /* search the previous element */
+      prev_addr = streams_list;
+      do {
+        lwb_sched_stream_read(prev_addr, &stream);
+        if(stream.next == stream_addr) {
+          break;
+        }
+        prev_addr = stream.next;
+      } while(prev_addr != MEMBX_INVALID_ADDR);
+      if(prev_addr == MEMBX_INVALID_ADDR) {
+        /* not found! */
+        DEBUG_PRINT_WARNING("memory block not freed (invalid address)");
+        return;
+      }
     }
     /* read, modify and write back */
-    xmem_read(prev_addr, sizeof(lwb_stream_list_t), (uint8_t*)&stream);
+    lwb_sched_stream_read(prev_addr, &stream);
     stream.next = next_addr;                      /* adjust the next-pointer */
-    xmem_write(prev_addr, sizeof(lwb_stream_list_t), (uint8_t*)&stream);
+    lwb_sched_stream_write(prev_addr, &stream);
   }
+#if LWB_CONF_SCHED_HASH_INDEX
+  lwb_sched_index_remove(node, stream_id);
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+  lwb_sched_cache_invalidate(stream_addr);
   membx_free(&streams_memb, stream_addr);   /* mark the memory block as free */
+  data_rate -= LWB_SCHED_RATE(ipi);
   n_streams--;
   sched_stats.n_deleted++;
   
+#if LWB_CONF_SCHED_VAR_SLOTS
+  lwb_sched_slot_len_remove(node, stream_id);
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
   DEBUG_PRINT_INFO("stream %u.%u removed", node, stream_id);
 }
 #endif /* LWB_CONF_SCHED_USE_XMEM */
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
 /*---------------------------------------------------------------------------*/
 uint8_t 
 lwb_sched_prepare_sack(void *payload) 
@@ -208,11 +455,13 @@ lwb_sched_prepare_sack(void *payload)
 void 
 lwb_sched_proc_srq(const lwb_stream_req_t* req) 
 {
-#if !LWB_CONF_SCHED_USE_XMEM
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+  uint16_t pos;
+#elif !LWB_CONF_SCHED_USE_XMEM
   lwb_stream_list_t *s  = 0;   
 #else /* LWB_CONF_SCHED_USE_XMEM */
   lwb_stream_list_t s, new_stream;
-  uint32_t stream_addr, prev_addr;
+  uint32_t stream_addr, prev_addr, next_addr;
 #endif /* LWB_CONF_SCHED_USE_XMEM */
   lwb_stream_extra_data_t* extra_data = 
     (lwb_stream_extra_data_t*)req->extra_data;
@@ -236,20 +485,46 @@ lwb_sched_proc_srq(const lwb_stream_req_t* req)
       last = (int32_t)time + (int32_t)extra_data->t_offset;
     }
   
-#if !LWB_CONF_SCHED_USE_XMEM
+#if LWB_CONF_SCHED_STREAM_ARRAYS
     /* check if stream already exists */
-    if(n_streams) {
-      for(s = list_head(streams_list); s != 0; s = s->next) {
-        if(req->id == s->id && req->stream_id == s->stream_id) {
-          /* already exists -> update the IPI */
-          s->ipi = req->ipi;
-          s->last_assigned = last;
-          s->n_cons_missed = 0;         /* reset this counter */
-          DEBUG_PRINT_VERBOSE("stream request %u.%u processed (IPI updated)",
-                              req->id, req->stream_id);
-          goto add_sack;
-        }
-      }  
+    pos = lwb_sched_get_stream(req->id, req->stream_id);
+    if(pos != LWB_SCHED_STREAMS_INVALID) {
+      /* already exists -> update the IPI */
+      data_rate = data_rate - LWB_SCHED_RATE(streams.ipi[pos]) + 
+                  LWB_SCHED_RATE(req->ipi);
+      streams.ipi[pos] = req->ipi;
+      streams.last_assigned[pos] = last;
+      streams.n_cons_missed[pos] = 0;         /* reset this counter */
+      DEBUG_PRINT_VERBOSE("stream request %u.%u processed (IPI updated)",
+                          req->id, req->stream_id);
+      goto add_sack;
+    }
+    /* does not exist: insert the new stream, ordered by node id */
+    pos = lwb_sched_streams_insert(&streams, n_streams, req->id, 
+                                   req->stream_id);
+    if(pos == LWB_SCHED_STREAMS_INVALID) {
+      DEBUG_PRINT_ERROR("out of memory: stream request dropped");
+      sched_stats.n_no_space++;  /* no space for new streams */
+      return;
+    }
+    if(update_started && pos <= update_pos) {
+      update_pos++;
+    }
+    streams.ipi[pos]           = req->ipi;
+    streams.last_assigned[pos] = last;
+#elif !LWB_CONF_SCHED_USE_XMEM
+    /* check if stream already exists */
+    s = lwb_sched_get_stream(req->id, req->stream_id);
+    if(s) {
+      /* already exists -> update the IPI */
+      data_rate = data_rate - LWB_SCHED_RATE(s->ipi) + 
+                  LWB_SCHED_RATE(req->ipi);
+      s->ipi = req->ipi;
+      s->last_assigned = last;
+      s->n_cons_missed = 0;         /* reset this counter */
+      DEBUG_PRINT_VERBOSE("stream request %u.%u processed (IPI updated)",
+                          req->id, req->stream_id);
+      goto add_sack;
     }
     /* does not exist: add the new stream */
     s = memb_alloc(&streams_memb);
@@ -263,6 +538,10 @@ lwb_sched_proc_srq(const lwb_stream_req_t* req)
     s->last_assigned = last;
     s->stream_id     = req->stream_id;
     s->n_cons_missed = 0;
+#if LWB_CONF_SCHED_HASH_INDEX
+    lwb_sched_index_add(req->id, req->stream_id, 
+                        s - (lwb_stream_list_t*)streams_memb.mem);
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
     /* insert the stream into the list, ordered by node id */
     lwb_stream_list_t *prev;
     for(prev = list_head(streams_list); prev != NULL; prev = prev->next) {
@@ -274,29 +553,20 @@ lwb_sched_proc_srq(const lwb_stream_req_t* req)
     list_insert(streams_list, prev, s);   
 #else      
     /* check whether stream already exists */
-    if(n_streams) {
-      stream_addr = streams_list;
-      do {
-        /* load the first block */
-        xmem_read(stream_addr, sizeof(lwb_stream_list_t), (uint8_t*)&s);
-        /* check the ID */
-        if(req->id == s.id && req->stream_id == s.stream_id) {
-          /* already exists -> update the IPI */
-          s.ipi = req->ipi;
-          s.last_assigned = last;
-          s.n_cons_missed = 0;         /* reset this counter */
-          /* insert into the list of pending S-ACKs */
-          memcpy(pending_sack + n_pending_sack * 4, &req->id, 2);
-          pending_sack[n_pending_sack * 4 + 2] = req->stream_id;
-          n_pending_sack++;
-          DEBUG_PRINT_VERBOSE("stream %u.%u updated (IPI %u)", 
-                              req->id, req->stream_id, req->ipi);
-          /* save the changes */
-          xmem_write(stream_addr, sizeof(lwb_stream_list_t), (uint8_t*)&s);
-          return;
-        }        
-        stream_addr = s.next;  /* go to the next address */  
-      } while(stream_addr != MEMBX_INVALID_ADDR);
+    stream_addr = lwb_sched_get_stream(req->id, req->stream_id);
+    if(stream_addr != MEMBX_INVALID_ADDR) {
+      lwb_sched_stream_read(stream_addr, &s);
+      /* already exists -> update the IPI */
+      data_rate = data_rate - LWB_SCHED_RATE(s.ipi) + 
+                  LWB_SCHED_RATE(req->ipi);
+      s.ipi = req->ipi;
+      s.last_assigned = last;
+      s.n_cons_missed = 0;         /* reset this counter */
+      DEBUG_PRINT_VERBOSE("stream %u.%u updated (IPI %u)", 
+                          req->id, req->stream_id, req->ipi);
+      /* save the changes */
+      lwb_sched_stream_write(stream_addr, &s);
+      goto add_sack;
     }        
     /* does not exist: add the new stream */
     stream_addr = membx_alloc(&streams_memb);
@@ -311,108 +581,59 @@ lwb_sched_proc_srq(const lwb_stream_req_t* req)
     new_stream.stream_id     = req->stream_id;
     new_stream.n_cons_missed = 0;
     new_stream.next          = MEMBX_INVALID_ADDR;
-    /* insert the stream into the list, ordered by node id */
-    if(streams_list == MEMBX_INVALID_ADDR) {   /* empty list? */
+#if LWB_CONF_SCHED_HASH_INDEX
+    lwb_sched_index_add(req->id, req->stream_id, 
+                        (stream_addr - streams_memb.mem) / streams_memb.size);
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+    /* insert the stream into the list, ordered by node id (behind the
+     * streams of the same node, as in the SRAM list) */
+    prev_addr = MEMBX_INVALID_ADDR;
+    next_addr = streams_list;
+    while(next_addr != MEMBX_INVALID_ADDR) {
+      lwb_sched_stream_read(next_addr, &s);
+      if(req->id < s.id) {
+        break;
+      }
+      prev_addr = next_addr;
+      next_addr = s.next;  /* go to the next address */
+    }
+    new_stream.next = next_addr;
+    if(prev_addr == MEMBX_INVALID_ADDR) {
+      /* the element is inserted at the head of the list */
       streams_list = stream_addr;
     } else {
-      prev_addr = streams_list;
-      do {
-        xmem_read(prev_addr, sizeof(lwb_stream_list_t), (uint8_t*)&s);
-        /* check the ID */
-        if(req->id <= s.id || s.next == MEMBX_INVALID_ADDR) { 
-          /* the element is inserted at the head of the list */
-          if(streams_list == prev_addr) { 
-            streams_list = stream_addr;
-            new_stream.next = prev_addr;
-          } else {
-            new_stream.next = s.next;
-            s.next = stream_addr;
-            xmem_write(prev_addr, sizeof(lwb_stream_list_t), (uint8_t*)&s);
-          }        
-          break;
-        }      
-        prev_addr = s.next;  /* go to the next address */
-      } while(prev_addr != MEMBX_INVALID_ADDR);      
+      lwb_sched_stream_read(prev_addr, &s);
+      s.next = stream_addr;
+      lwb_sched_stream_write(prev_addr, &s);
     }
-    xmem_write(stream_addr, sizeof(lwb_stream_list_t), (uint8_t*)&new_stream);
+    lwb_sched_stream_write(stream_addr, &new_stream);
+    /* the stream may have been inserted after update_prev */
+    update_prev = MEMBX_INVALID_ADDR;
 #endif /* LWB_CONF_SCHED_USE_XMEM */
     n_streams++;
+    data_rate += LWB_SCHED_RATE(req->ipi);
     sched_stats.n_added++;     
     DEBUG_PRINT_VERBOSE("stream %u.%u added", req->id, req->stream_id);
 
   } else {
-#if !LWB_CONF_SCHED_USE_XMEM  
     /* remove this stream */
-    for(s = list_head(streams_list); s != 0; s = s->next) {
-      if(req->id == s->id && req->stream_id == s->stream_id) {
-        break;
-      }
-    }
-    lwb_sched_del_stream(s);    
-#else
-    stream_addr = streams_list;
-    while(stream_addr != MEMBX_INVALID_ADDR) {
-      xmem_read(stream_addr, sizeof(lwb_stream_list_t), (uint8_t*)&s);
-      if(req->id == s.id && req->stream_id == s.stream_id) {
-        break;
-      }
-      stream_addr = s.next;  /* go to the next address */ 
-    }
-    lwb_sched_del_stream(stream_addr);
-#endif  /* LWB_CONF_SCHED_USE_XMEM */
+#if LWB_CONF_SCHED_USE_XMEM
+    lwb_sched_del_stream(lwb_sched_get_stream(req->id, req->stream_id), 
+                         MEMBX_INVALID_ADDR);
+#else /* LWB_CONF_SCHED_USE_XMEM */
+    lwb_sched_del_stream(lwb_sched_get_stream(req->id, req->stream_id));
+#endif /* LWB_CONF_SCHED_USE_XMEM */
   }
 add_sack:
+#if LWB_CONF_SCHED_VAR_SLOTS
+  lwb_sched_slot_len_update(req);
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
   /* insert into the list of pending S-ACKs */
   memcpy(pending_sack + n_pending_sack * 4, &req->id, 2);
   pending_sack[n_pending_sack * 4 + 2] = req->stream_id;
   n_pending_sack++;   
 }
 /*---------------------------------------------------------------------------*/
-/**
- * @brief implementation of the binary GCD algorithm
- * @param[in] u an unsigned integer
- * @param[in] v an unsigned integer
- * @return the greatest common divider of u and v
- */
-static inline uint16_t 
-gcd(uint16_t u, uint16_t v) 
-{
-  uint16_t shift;
-
-  /* GCD(0,x) := x */
-  if(u == 0 || v == 0) {
-    return u | v;
-  }
-
-  /* Let shift := lg K, where K is the greatest power of 2
-     dividing both u and v. */
-  for(shift = 0; ((u | v) & 1) == 0; ++shift) {
-    u >>= 1;
-    v >>= 1;
-  }
-  while((u & 1) == 0) {
-    u >>= 1;
-  }
-  /* From here on, u is always odd. */
-  do {
-    while((v & 1) == 0) {  /* Loop X */
-      v >>= 1;
-    }
-    /* Now u and v are both odd, so diff(u, v) is even.
-       Let u = min(u, v), v = diff(u, v)/2. */
-    if(u < v) {
-      v -= u;
-    } else {
-      uint16_t diff = u - v;
-      u = v;
-      v = diff;
-    }
-    v >>= 1;
-  } while(v != 0);
-
-  return u << shift;
-}
-/*---------------------------------------------------------------------------*/
 /**
  * @brief adapts the communication period T according to the traffic demand
  * @return the new period
@@ -425,14 +646,13 @@ lwb_sched_adapt_period(void)
      * seconds: set the period to a low value */
     return LWB_CONF_SCHED_PERIOD_MIN;
   }
-  if(!data_cnt) {
+  if(!data_rate) {
     return LWB_CONF_SCHED_PERIOD_IDLE;     /* no streams */
   }
   saturated = 0;
-  uint16_t new_period = (uint16_t)(((uint32_t)data_ipi * 
-                                    LWB_CONF_MAX_DATA_SLOTS) / data_cnt);
-  /*new_period = (((uint32_t)data_ipi * LWB_CONF_MAX_DATA_SLOTS) / data_cnt) *
-   *             n_pkts / n_slots;*/
+  /* the longest period in which all packets fit into the data slots */
+  uint32_t new_period = ((uint32_t)LWB_CONF_MAX_DATA_SLOTS << 
+                         LWB_SCHED_RATE_SHIFT) / data_rate;
   /* check for saturation */
   if(new_period < LWB_CONF_SCHED_PERIOD_MIN) {
     /* T_opt is smaller than LWB_CONF_SCHED_PERIOD_MIN */
@@ -444,60 +664,116 @@ lwb_sched_adapt_period(void)
   if(new_period > LWB_CONF_SCHED_PERIOD_MAX) {
     return LWB_CONF_SCHED_PERIOD_MAX;
   }
-  return new_period;
+  return (uint16_t)new_period;
 }
 /*---------------------------------------------------------------------------*/
 /**
- * @brief searches the list node_list/stream_list for the id/stream_id
+ * @brief checks whether a packet of the stream id/stream_id has been received
+ * in the last round (merge-join of the stream list and the schedule)
  * @param[in] id the node ID to search for
  * @param[in] stream_id the stream ID to search for
- * @param[in] node_list the list of node IDs to search
- * @param[in] stream_list the list of stream IDs to search
+ * @param[in] node_list the node IDs of the data slots of the last round
+ * @param[in] stream_list the stream IDs of the packets received in these 
+ * slots (LWB_INVALID_STREAM_ID if no packet was received)
  * @param[in] list_len the number of entries in the node and stream list
+ * @param[in,out] pos the current position in the node and stream list, must
+ * be set to zero before the first call
  * @return one if the id/stream_id exists in the list, zero otherwise
- * @remark this search could be optimized as the node ids in the list are 
- * supposed to be sorted in increasing order
+ * @remark the function must be called for the streams in increasing order 
+ * of their node IDs; the node IDs in node_list are sorted in increasing order
+ * except for the slots of the host at the beginning of the schedule, which 
+ * never contain a received packet, i.e. the list is traversed only once for 
+ * all streams
  */
 static inline uint8_t 
 lwb_sched_stream_in_list(uint16_t id, 
                          uint8_t stream_id, 
                          const uint16_t* node_list, 
                          const uint8_t* stream_list, 
-                         uint8_t list_len) 
+                         uint8_t list_len,
+                         uint8_t* pos) 
 {
-  while(list_len) {
-    if(*node_list == id && *stream_list == stream_id) {
+  uint8_t i = *pos;
+  /* skip the slots of nodes with a smaller ID and the slots without a 
+   * received packet */
+  while(i < list_len && 
+        (node_list[i] < id || stream_list[i] == LWB_INVALID_STREAM_ID)) {
+    i++;
+  }
+  *pos = i;
+  /* a node may have several streams: check all slots of this node */
+  while(i < list_len && node_list[i] == id) {
+    if(stream_list[i] == stream_id) {
       return 1;
     }
-    node_list++;
-    stream_list++;  
-    list_len--;
+    i++;
   }
   return 0;
 }
 /*---------------------------------------------------------------------------*/
-uint16_t 
-lwb_sched_compute(lwb_schedule_t * const sched, 
-                  const uint8_t * const streams_to_update, 
-                  uint8_t reserve_slot_host) 
-{  
-  static uint16_t slots_tmp[LWB_CONF_MAX_DATA_SLOTS];
-
-  data_ipi = 1;
-  data_cnt = 0;
-  first_index = 0; 
-  n_slots_assigned = 0;
-  
-  /* loop through all the streams in the list */
-#if !LWB_CONF_SCHED_USE_XMEM
-  memset(streams, 0, sizeof(streams)); /* clear content of the stream list */
-  lwb_stream_list_t *curr_stream = list_head(streams_list);
-  while(curr_stream != NULL) {
+/**
+ * @brief updates the streams of the nodes up to last_id according to the 
+ * packets received in the current round and removes the streams with too
+ * many consecutive misses (first part of the schedule computation)
+ * @param[in] sched the schedule of the current round
+ * @param[in] streams_to_update the stream IDs of the received packets
+ * @param[in] n_slots the number of data slots processed so far
+ * @param[in] last_id the largest node ID whose data slots are all known
+ * @remark the streams are processed in the order of their node IDs, the 
+ * position is kept until the new schedule is computed
+ */
+static void
+lwb_sched_update_streams(const lwb_schedule_t * const sched, 
+                         const uint8_t * const streams_to_update, 
+                         uint8_t n_slots,
+                         uint16_t last_id)
+{
+  if(!update_started) {
+    update_started = 1;
+    update_slot_pos = 0;
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+    update_pos = 0;
+#elif !LWB_CONF_SCHED_USE_XMEM
+    update_pos = list_head(streams_list);
+#else /* LWB_CONF_SCHED_USE_XMEM */
+    update_pos = streams_list;
+    update_prev = MEMBX_INVALID_ADDR;
+#endif /* LWB_CONF_SCHED_USE_XMEM */
+  }
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+  while(update_pos < n_streams && streams.id[update_pos] <= last_id) {
+    uint16_t i = update_pos;
+    if(lwb_sched_stream_in_list(streams.id[i], 
+                                streams.stream_id[i], 
+                                sched->slot, 
+                                streams_to_update, 
+                                n_slots,
+                                &update_slot_pos)) {
+      streams.n_cons_missed[i] = 0;
+    } else if(streams.n_cons_missed[i] & 0x80) {
+      /* no packet received from this stream */
+      streams.n_cons_missed[i] &= 0x7f;               /* clear the last bit */
+      streams.n_cons_missed[i]++;
+    }
+    if(streams.n_cons_missed[i] > LWB_CONF_SCHED_STREAM_REMOVAL_THRES) {
+      /* too many consecutive slots without reception: delete this stream, 
+       * the next stream moves to position i */
+      lwb_sched_del_stream(i);
+    } else {
+      update_pos++;
+    }
+  }
+#elif !LWB_CONF_SCHED_USE_XMEM
+  lwb_stream_list_t *curr_stream;
+  while(update_pos != NULL && update_pos->id <= last_id) {
+    curr_stream = update_pos;
+    update_pos = curr_stream->next;
     if(lwb_sched_stream_in_list(curr_stream->id, 
                                 curr_stream->stream_id, 
                                 sched->slot, 
                                 streams_to_update, 
-                                LWB_SCHED_N_SLOTS(sched))) {
+                                n_slots,
+                                &update_slot_pos)) {
       curr_stream->n_cons_missed = 0;
     } else if(curr_stream->n_cons_missed & 0x80) {
       /* no packet received from this stream */
@@ -506,55 +782,83 @@ lwb_sched_compute(lwb_schedule_t * const sched,
     }
     if(curr_stream->n_cons_missed > LWB_CONF_SCHED_STREAM_REMOVAL_THRES) {
       /* too many consecutive slots without reception: delete this stream */
-      lwb_stream_list_t *stream_to_remove = curr_stream;
-      curr_stream = curr_stream->next;
-      lwb_sched_del_stream(stream_to_remove);
-    } else {
-      uint16_t curr_gcd = gcd(data_ipi, curr_stream->ipi);
-      uint16_t k1 = curr_stream->ipi / curr_gcd;
-      uint16_t k2 = data_ipi / curr_gcd;
-      data_cnt = data_cnt * k1 + k2;
-      data_ipi = data_ipi * k1;
-      curr_stream = curr_stream->next;
+      lwb_sched_del_stream(curr_stream);
     }
   }
 #else /* LWB_CONF_SCHED_USE_XMEM */
-  uint32_t stream_addr = streams_list;
+  uint32_t stream_addr;
   lwb_stream_list_t curr_stream;
-  while(stream_addr != MEMBX_INVALID_ADDR) {
-    xmem_read(stream_addr, sizeof(lwb_stream_list_t), (uint8_t*)&curr_stream);
+  while(update_pos != MEMBX_INVALID_ADDR) {
+    stream_addr = update_pos;
+    lwb_sched_stream_read(stream_addr, &curr_stream);
+    if(curr_stream.id > last_id) {
+      break;
+    }
+    if(stream_addr == curr_stream.next) {  /* prevent endless loop */
+      DEBUG_PRINT_WARNING("unexpected stream address!");
+      update_pos = MEMBX_INVALID_ADDR;
+      break;
+    }
+    update_pos = curr_stream.next;
     if(lwb_sched_stream_in_list(curr_stream.id, 
                                 curr_stream.stream_id, 
                                 sched->slot, 
                                 streams_to_update, 
-                                LWB_SCHED_N_SLOTS(sched))) {
+                                n_slots,
+                                &update_slot_pos)) {
       curr_stream.n_cons_missed = 0;
-      xmem_write(stream_addr, sizeof(lwb_stream_list_t), 
-                 (uint8_t*)&curr_stream);
+      lwb_sched_stream_write(stream_addr, &curr_stream);
     } else if(curr_stream.n_cons_missed & 0x80) {
       curr_stream.n_cons_missed &= 0x7f;
       curr_stream.n_cons_missed++;
-      xmem_write(stream_addr, sizeof(lwb_stream_list_t), 
-                 (uint8_t*)&curr_stream);
+      lwb_sched_stream_write(stream_addr, &curr_stream);
     }
     
     if(curr_stream.n_cons_missed > LWB_CONF_SCHED_STREAM_REMOVAL_THRES) {
       /* too many consecutive slots without reception: delete this stream */
-      lwb_sched_del_stream(stream_addr);
+      lwb_sched_del_stream(stream_addr, update_prev);
     } else {
-      uint16_t curr_gcd = gcd(data_ipi, curr_stream.ipi);
-      uint16_t k1 = curr_stream.ipi / curr_gcd;
-      uint16_t k2 = data_ipi / curr_gcd;
-      data_cnt = data_cnt * k1 + k2;
-      data_ipi = data_ipi * k1;
-    }    
-    if(stream_addr == curr_stream.next) {  /* prevent endless loop */
-      DEBUG_PRINT_WARNING("unexpected stream address!");
-      break;
+      update_prev = stream_addr;
     }
-    stream_addr = curr_stream.next;      
   }
 #endif /* LWB_CONF_SCHED_USE_XMEM */
+}
+/*---------------------------------------------------------------------------*/
+void 
+lwb_sched_proc_slot(const lwb_schedule_t * const sched,
+                    const uint8_t * const streams_to_update,
+                    uint8_t slot_idx)
+{
+  uint16_t last_id = LWB_SCHED_LAST_KNOWN_ID(sched, slot_idx);
+  if(last_id) {
+    lwb_sched_update_streams(sched, streams_to_update, slot_idx + 1, last_id);
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint16_t 
+lwb_sched_compute(lwb_schedule_t * const sched, 
+                  const uint8_t * const streams_to_update, 
+                  uint8_t reserve_slot_host) 
+{  
+  static uint16_t slots_tmp[LWB_CONF_MAX_DATA_SLOTS];
+
+  first_index = 0; 
+  n_slots_assigned = 0;
+  
+  /* update the remaining streams (all streams if lwb_sched_proc_slot() has
+   * not been called in this round) */
+  lwb_sched_update_streams(sched, streams_to_update, 
+                           LWB_SCHED_N_SLOTS(sched), 0xffff);
+  update_started = 0;
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+  uint16_t i;
+#elif !LWB_CONF_SCHED_USE_XMEM
+  lwb_stream_list_t *curr_stream;
+  memset(streams, 0, sizeof(streams)); /* clear content of the stream list */
+#else /* LWB_CONF_SCHED_USE_XMEM */
+  uint32_t stream_addr;
+  lwb_stream_list_t curr_stream;
+#endif /* LWB_CONF_SCHED_USE_XMEM */
 
   /* clear content of the schedule (do NOT move this line further above!) */
   memset(sched->slot, 0, sizeof(sched->slot));  
@@ -573,9 +877,60 @@ lwb_sched_compute(lwb_schedule_t * const sched,
   }
   /* random initial position in the list */
   uint16_t rand_init_pos = (random_rand() >> 1) % n_streams;
+#if !LWB_CONF_SCHED_STREAM_ARRAYS
   uint16_t i;
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
   
-#if !LWB_CONF_SCHED_USE_XMEM
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+  i = rand_init_pos;
+  do {
+    /* assign slots for this stream, if possible */
+    if((n_slots_assigned < LWB_CONF_MAX_DATA_SLOTS) && 
+       (time >= (streams.ipi[i] + streams.last_assigned[i]))) {
+      /* the number of slots to assign to stream i */
+      uint16_t to_assign = (time - streams.last_assigned[i]) / 
+                           streams.ipi[i];  /* elapsed time / period */
+      if(saturated) {
+        uint16_t next = (i + 1 == n_streams) ? 0 : (i + 1);
+        if(next == rand_init_pos) {
+          /* last random stream: assign all possible slots */
+        } else {
+          /* ensure fairness among source nodes when the bandwidth saturates
+           * assigned a number of slots proportional to (1/IPI) */
+          uint16_t slots_ipi = period / streams.ipi[i];
+          if(to_assign > slots_ipi) {
+            to_assign = slots_ipi;
+            if(to_assign == 0 && i == rand_init_pos) {
+              /* first random stream: assign one slot to it, even if it has 
+               * very long IPI */
+              to_assign = 1;
+            }
+          }
+        }
+      }
+      if(to_assign > (LWB_CONF_MAX_DATA_SLOTS - n_slots_assigned)) {
+        to_assign = LWB_CONF_MAX_DATA_SLOTS - n_slots_assigned;
+      }
+      streams.last_assigned[i] += to_assign * streams.ipi[i];
+      if(to_assign) {
+        /* set the last bit, we are expecting a packet from this stream in 
+         * the next round (not if it got no slot due to the saturation) */
+        streams.n_cons_missed[i] |= 0x80; 
+      }
+      for(; to_assign > 0; to_assign--, n_slots_assigned++) {
+        slots_tmp[n_slots_assigned] = streams.id[i];
+      }
+    }
+    /* go to the next stream */
+    i++;
+    if(i == n_streams) {
+      /* end of the arrays: start again from the first stream */
+      i = 0;
+      first_index = n_slots_assigned; 
+    }
+  } while(i != rand_init_pos);
+
+#elif !LWB_CONF_SCHED_USE_XMEM
   curr_stream = list_head(streams_list);
   /* make curr_stream point to the random initial position */
   for(i = 0; i < rand_init_pos; i++) {
@@ -612,13 +967,15 @@ lwb_sched_compute(lwb_schedule_t * const sched,
         to_assign = LWB_CONF_MAX_DATA_SLOTS - n_slots_assigned;
       }
       curr_stream->last_assigned += to_assign * curr_stream->ipi;
+      if(to_assign) {
+        /* set the last bit, we are expecting a packet from this stream in 
+         * the next round (not if it got no slot due to the saturation) */
+        curr_stream->n_cons_missed |= 0x80; 
+      }
       for(; to_assign > 0; to_assign--, n_slots_assigned++) {
         slots_tmp[n_slots_assigned] = curr_stream->id;
         streams[n_slots_assigned] = curr_stream;
       }
-      /* set the last bit, we are expecting a packet from this stream in the
-       * next round */
-      curr_stream->n_cons_missed |= 0x80; 
     }
     /* go to the next stream in the list */
     curr_stream = curr_stream->next;
@@ -638,7 +995,7 @@ lwb_sched_compute(lwb_schedule_t * const sched,
   stream_addr = streams_list;
   /* make curr_stream point to the random initial position */
   for(i = 0; i < rand_init_pos && stream_addr != MEMBX_INVALID_ADDR; i++) {
-    xmem_read(stream_addr, sizeof(lwb_stream_list_t), (uint8_t*)&curr_stream);
+    lwb_sched_stream_read(stream_addr, &curr_stream);
     stream_addr = curr_stream.next;
     if(stream_addr == MEMBX_INVALID_ADDR) {
       DEBUG_PRINT_WARNING("unexpected invalid stream address");
@@ -648,7 +1005,7 @@ lwb_sched_compute(lwb_schedule_t * const sched,
   }
   uint32_t init_stream = stream_addr;
   do {
-    xmem_read(stream_addr, sizeof(lwb_stream_list_t), (uint8_t*)&curr_stream);
+    lwb_sched_stream_read(stream_addr, &curr_stream);
     /* assign slots for this stream, if possible */
     if((n_slots_assigned < LWB_CONF_MAX_DATA_SLOTS) && 
        (time >= (curr_stream.ipi + curr_stream.last_assigned))) {
@@ -677,14 +1034,15 @@ lwb_sched_compute(lwb_schedule_t * const sched,
         to_assign = LWB_CONF_MAX_DATA_SLOTS - n_slots_assigned;   /* limit */
       }
       curr_stream.last_assigned += to_assign * curr_stream.ipi;
+      if(to_assign) {
+        /* set the last bit, we are expecting a packet from this stream in 
+         * the next round (not if it got no slot due to the saturation) */
+        curr_stream.n_cons_missed |= 0x80;
+      }
       for(; to_assign > 0; to_assign--, n_slots_assigned++) {
         slots_tmp[n_slots_assigned] = curr_stream.id;
       }
-      /* set the last bit, we are expecting a packet from this stream in the 
-       * next round and save the changes */
-      curr_stream.n_cons_missed |= 0x80;
-      xmem_write(stream_addr, sizeof(lwb_stream_list_t), 
-                 (uint8_t*)&curr_stream);
+      lwb_sched_stream_write(stream_addr, &curr_stream);   /* save changes */
     }
     /* go to the next stream in the list */
     stream_addr = curr_stream.next;
@@ -703,6 +1061,12 @@ lwb_sched_compute(lwb_schedule_t * const sched,
          slots_tmp, first_index * sizeof(sched->slot[0]));
   
 set_schedule:
+#if LWB_CONF_SCHED_USE_XMEM
+  lwb_sched_cache_flush();         /* write the changes of this round back */
+#endif /* LWB_CONF_SCHED_USE_XMEM */
+#if LWB_CONF_DATA_QUEUE_DEPTH
+  n_slots_assigned = lwb_sched_add_queue_depth_slots(sched, n_slots_assigned);
+#endif /* LWB_CONF_DATA_QUEUE_DEPTH */
   sched->n_slots = n_slots_assigned;
 
   if(n_pending_sack) {
@@ -710,14 +1074,17 @@ set_schedule:
   }
   //if((time < (sched_stats.t_last_req + LWB_CONF_SCHED_T_NO_REQ)) || 
   //   (time >= (sched_stats.t_last_cont + LWB_CONF_SCHED_T_NO_REQ)) ||
-  //   !data_cnt) {    -> always schedule a contention slot
+  //   !data_rate) {    -> always schedule a contention slot
     /* schedule a contention slot */
     sched_stats.t_last_cont = time;
     LWB_SCHED_SET_CONT_SLOT(sched);
   //}  
   
+#if LWB_CONF_SCHED_VAR_SLOTS
+  lwb_sched_set_slot_len(sched);   /* before the slots are compressed */
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
 #if LWB_CONF_SCHED_COMPRESS
-  uint8_t len = lwb_sched_compress((uint8_t*)sched->slot, n_slots_assigned);
+  uint8_t len = lwb_sched_compress(sched);
   if((len + LWB_SCHED_PKT_HEADER_LEN) > LWB_CONF_MAX_PKT_LEN) {
     DEBUG_PRINT_ERROR("compressed schedule is too big!");
   }
@@ -740,19 +1107,37 @@ set_schedule:
 uint16_t 
 lwb_sched_init(lwb_schedule_t* sched) 
 {
-#if !LWB_CONF_SCHED_USE_XMEM
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+  /* nothing to do, the number of streams is reset below */
+#elif !LWB_CONF_SCHED_USE_XMEM
   memb_init(&streams_memb);
   list_init(streams_list);
 #else /* LWB_CONF_SCHED_USE_XMEM */
   membx_init(&streams_memb, xmem_alloc(streams_memb.size * streams_memb.num));
   streams_list = MEMBX_INVALID_ADDR;
+#if LWB_CONF_SCHED_XMEM_CACHE_SIZE
+  uint16_t i;
+  for(i = 0; i < LWB_CONF_SCHED_XMEM_CACHE_SIZE; i++) {
+    stream_cache[i].addr  = MEMBX_INVALID_ADDR;
+    stream_cache[i].dirty = 0;
+  }
+#endif /* LWB_CONF_SCHED_XMEM_CACHE_SIZE */
 #endif /* LWB_CONF_SCHED_USE_XMEM */
+#if LWB_CONF_SCHED_HASH_INDEX
+  lwb_sched_index_init();
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+#if LWB_CONF_SCHED_VAR_SLOTS
+  lwb_sched_slot_len_init();
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+#if LWB_CONF_DATA_QUEUE_DEPTH
+  lwb_sched_queue_depth_init();
+#endif /* LWB_CONF_DATA_QUEUE_DEPTH */
 
-  data_ipi = 1;
-  data_cnt = 0;
+  data_rate = 0;
   n_streams = 0;
   n_slots_assigned = 0;
   n_pending_sack = 0;
+  update_started = 0;
   time = 0;                                        /* global time starts now */
   period = LWB_CONF_SCHED_PERIOD_IDLE;
   sched->n_slots = 0;                                       /* no data slots */
@@ -769,6 +1154,27 @@ lwb_sched_init(lwb_schedule_t* sched)
   return LWB_SCHED_PKT_HEADER_LEN; /* empty schedule, no slots allocated yet */
 }
 /*---------------------------------------------------------------------------*/
+uint16_t
+lwb_sched_set_time(lwb_schedule_t* sched, uint32_t t)
+{
+  time = t;     /* the streams are kept */
+  if(sched) {
+    sched_stats.t_last_cont = time;
+    sched->n_slots = 0;
+    LWB_SCHED_SET_CONT_SLOT(sched);     /* include a contention slot */
+    sched->time = time;
+    sched->period = period;
+    LWB_SCHED_SET_AS_1ST(sched); 
+  }
+  return LWB_SCHED_PKT_HEADER_LEN;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+lwb_sched_get_n_streams(void)
+{
+  return n_streams;
+}
+/*---------------------------------------------------------------------------*/
 
 #endif /* LWB_SCHED_MIN_ENERGY */
 
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @addtogroup  lwb-scheduler
+ * @{
+ *
+ * @defgroup    sched-queue-depth Queue depth of the sources
+ * @{
+ *
+ * @file 
+ * @brief additional data slots for the nodes whose outgoing queue is filling
+ * up
+ *
+ * Each data packet carries the number of messages in the outgoing queue of 
+ * its sender (LWB_CONF_DATA_QUEUE_DEPTH). The host keeps the nodes that 
+ * report at least LWB_CONF_SCHED_QUEUE_DEPTH_THRES messages in a small table 
+ * and the schedulers add data slots for these nodes to the next schedule, 
+ * i.e. before the queue overflows.
+ */
+ 
+#include "lwb.h"
+
+#if LWB_CONF_DATA_QUEUE_DEPTH
+
+#if LWB_CONF_SCHED_QUEUE_DEPTH_THRES == 0
+#error "LWB_CONF_SCHED_QUEUE_DEPTH_THRES must be at least 1"
+#endif
+
+#ifndef MIN
+#define MIN(x, y)       ((x) < (y) ? (x) : (y))
+#endif /* MIN */
+/*---------------------------------------------------------------------------*/
+typedef struct {
+  uint16_t id;
+  uint8_t  depth;
+} sched_queue_depth_t;
+/*---------------------------------------------------------------------------*/
+static sched_queue_depth_t depth_table[LWB_CONF_SCHED_QUEUE_DEPTH_N_NODES];
+static uint8_t             n_entries = 0;
+/*---------------------------------------------------------------------------*/
+void
+lwb_sched_queue_depth_init(void)
+{
+  n_entries = 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+lwb_sched_proc_queue_depth(uint16_t id, uint8_t depth)
+{
+  uint8_t i, j;
+  for(i = 0; i < n_entries; i++) {
+    if(depth_table[i].id == id) {
+      break;
+    }
+  }
+  if(depth < LWB_CONF_SCHED_QUEUE_DEPTH_THRES) {
+    if(i < n_entries) {
+      /* the queue has been drained */
+      depth_table[i] = depth_table[--n_entries];
+    }
+    return;
+  }
+  if(i == n_entries) {
+    if(n_entries < LWB_CONF_SCHED_QUEUE_DEPTH_N_NODES) {
+      n_entries++;
+    } else {
+      /* table full: replace the node with the lowest queue depth */
+      for(i = 0, j = 1; j < n_entries; j++) {
+        if(depth_table[j].depth < depth_table[i].depth) {
+          i = j;
+        }
+      }
+      if(depth_table[i].depth >= depth) {
+        return;
+      }
+    }
+  }
+  depth_table[i].id    = id;
+  depth_table[i].depth = depth;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+lwb_sched_add_queue_depth_slots(lwb_schedule_t* sched, uint8_t n_slots)
+{
+  uint8_t i, k, n, pos;
+  
+  while(n_entries && n_slots < LWB_CONF_MAX_DATA_SLOTS) {
+    /* the fullest queue first */
+    for(k = 0, i = 1; i < n_entries; i++) {
+      if(depth_table[i].depth > depth_table[k].depth) {
+        k = i;
+      }
+    }
+    uint16_t id = depth_table[k].id;
+    n = MIN(depth_table[k].depth - LWB_CONF_SCHED_QUEUE_DEPTH_THRES + 1,
+            LWB_CONF_MAX_DATA_SLOTS - n_slots);
+    depth_table[k] = depth_table[--n_entries];
+    /* keep the node IDs ordered: skip the slots of the host and the slots
+     * of all nodes with a smaller or equal ID */
+    for(pos = 0; pos < n_slots && sched->slot[pos] == node_id; pos++);
+    for(; pos < n_slots && sched->slot[pos] <= id; pos++);
+    memmove(&sched->slot[pos + n], &sched->slot[pos], 
+            (n_slots - pos) * sizeof(sched->slot[0]));
+    for(i = 0; i < n; i++) {
+      sched->slot[pos + i] = id;
+    }
+    n_slots += n;
+    DEBUG_PRINT_VERBOSE("%u slots added for node %u (queue depth)", n, id);
+  }
+  return n_slots;
+}
+/*---------------------------------------------------------------------------*/
+
+#endif /* LWB_CONF_DATA_QUEUE_DEPTH */
+
+/**
+ * @}
+ * @}
+ */
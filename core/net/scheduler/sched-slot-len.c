@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @addtogroup  lwb-scheduler
+ * @{
+ *
+ * @defgroup    sched-slot-len Slot length classes
+ * @{
+ *
+ * @file 
+ * @brief length classes of the data slots on the host
+ *
+ * Keeps the length class of each stream (derived from the max. payload 
+ * length in the stream request) in an array sorted by node ID. A node sends
+ * the packets of all its streams from the same queue, i.e. each data slot of
+ * a node gets the largest class of all streams of this node. The schedulers
+ * keep this table up to date the same way as the stream index.
+ */
+ 
+#include "lwb.h"
+
+#if LWB_CONF_SCHED_VAR_SLOTS
+
+#if LWB_SLOT_N_CLASSES > 4
+#error "only 2 bits per slot are reserved for the length class"
+#endif
+/*---------------------------------------------------------------------------*/
+typedef struct {
+  uint16_t id;
+  uint8_t  stream_id;
+  uint8_t  len_class;
+} sched_slot_len_t;
+/*---------------------------------------------------------------------------*/
+static sched_slot_len_t slot_len_table[LWB_CONF_MAX_N_STREAMS];
+static uint16_t         n_entries = 0;
+/*---------------------------------------------------------------------------*/
+/* returns the position of the first entry with a node ID >= id */
+static uint16_t
+lwb_sched_slot_len_find(uint16_t id)
+{
+  uint16_t lo = 0, hi = n_entries;
+  while(lo < hi) {
+    uint16_t mid = (lo + hi) >> 1;
+    if(slot_len_table[mid].id < id) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+/*---------------------------------------------------------------------------*/
+/* the smallest class that fits a packet with max_len bytes of payload */
+static uint8_t
+lwb_sched_slot_len_get_class(uint8_t max_len)
+{
+  uint8_t c;
+  if(!max_len) {
+    return LWB_SLOT_N_CLASSES - 1;
+  }
+  for(c = 0; c < LWB_SLOT_N_CLASSES - 1; c++) {
+    if((uint16_t)max_len + LWB_CONF_HEADER_LEN + LWB_DATA_PKT_TRAILER_LEN <= 
+       LWB_SLOT_CLASS_PKT_LEN(c)) {
+      break;
+    }
+  }
+  return c;
+}
+/*---------------------------------------------------------------------------*/
+void
+lwb_sched_slot_len_init(void)
+{
+  n_entries = 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+lwb_sched_slot_len_update(const lwb_stream_req_t* req)
+{
+  uint16_t i;
+  if(!req->ipi) {
+    lwb_sched_slot_len_remove(req->id, req->stream_id);
+    return;
+  }
+  for(i = lwb_sched_slot_len_find(req->id); 
+      i < n_entries && slot_len_table[i].id == req->id; i++) {
+    if(slot_len_table[i].stream_id == req->stream_id) {
+      slot_len_table[i].len_class = lwb_sched_slot_len_get_class(req->max_len);
+      return;
+    }
+  }
+  if(n_entries >= LWB_CONF_MAX_N_STREAMS) {
+    /* the node then gets slots of the largest class */
+    DEBUG_PRINT_WARNING("no space for the slot length of stream %u.%u",
+                        req->id, req->stream_id);
+    return;
+  }
+  /* insert after all streams of this node */
+  memmove(&slot_len_table[i + 1], &slot_len_table[i], 
+          (n_entries - i) * sizeof(sched_slot_len_t));
+  slot_len_table[i].id        = req->id;
+  slot_len_table[i].stream_id = req->stream_id;
+  slot_len_table[i].len_class = lwb_sched_slot_len_get_class(req->max_len);
+  n_entries++;
+}
+/*---------------------------------------------------------------------------*/
+void
+lwb_sched_slot_len_remove(uint16_t id, uint8_t stream_id)
+{
+  uint16_t i;
+  for(i = lwb_sched_slot_len_find(id); 
+      i < n_entries && slot_len_table[i].id == id; i++) {
+    if(slot_len_table[i].stream_id == stream_id) {
+      n_entries--;
+      memmove(&slot_len_table[i], &slot_len_table[i + 1], 
+              (n_entries - i) * sizeof(sched_slot_len_t));
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+lwb_sched_set_slot_len(lwb_schedule_t* sched)
+{
+  uint8_t  n_slots = LWB_SCHED_N_SLOTS(sched);
+  uint8_t  i, len_class = LWB_SLOT_N_CLASSES - 1;
+  uint16_t prev_id = 0, j;
+
+  memset(sched->slot_len, 0, sizeof(sched->slot_len));
+  for(i = 0; i < n_slots; i++) {
+    /* a node usually has several consecutive slots */
+    if(i == 0 || sched->slot[i] != prev_id) {
+      prev_id = sched->slot[i];
+      len_class = LWB_SLOT_N_CLASSES - 1;
+      j = lwb_sched_slot_len_find(prev_id);
+      if(j < n_entries && slot_len_table[j].id == prev_id) {
+        len_class = 0;
+        for(; j < n_entries && slot_len_table[j].id == prev_id; j++) {
+          len_class = MAX(len_class, slot_len_table[j].len_class);
+        }
+      }
+    }
+    LWB_SCHED_SET_SLOT_LEN(sched, i, len_class);
+  }
+}
+/*---------------------------------------------------------------------------*/
+
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+
+/**
+ * @}
+ * @}
+ */
@@ -53,8 +53,8 @@
 #ifdef LWB_SCHED_STATIC
 
 #if !defined(LWB_CONF_STREAM_EXTRA_DATA_LEN) || \
-    (LWB_CONF_STREAM_EXTRA_DATA_LEN != 0)
-#error "LWB_CONF_STREAM_EXTRA_DATA_LEN not set to 0!"
+    (LWB_CONF_STREAM_EXTRA_DATA_LEN != (LWB_CONF_SCHED_BURST ? 1 : 0))
+#error "LWB_CONF_STREAM_EXTRA_DATA_LEN not set to 0 (1 for burst streams)!"
 #endif
 
 /* max. number of packets per period */
@@ -63,6 +63,18 @@
 #ifndef MAX
 #define MAX(x, y)       ((x) > (y) ? (x) : (y))
 #endif /* MAX */
+#ifndef MIN
+#define MIN(x, y)       ((x) < (y) ? (x) : (y))
+#endif /* MIN */
+
+#if LWB_CONF_SCHED_BURST
+#define STREAM_BURST(b) (b)
+#else /* LWB_CONF_SCHED_BURST */
+#define STREAM_BURST(b) 1
+#endif /* LWB_CONF_SCHED_BURST */
+/* bandwidth of a stream (# packets per period) */
+#define STREAM_BW(ipi, burst)   (MAX(1, (LWB_CONF_SCHED_PERIOD_IDLE / (ipi))) * \
+                                 STREAM_BURST(burst))
 /*---------------------------------------------------------------------------*/
 /**
  * @brief struct to store information about active streams on the host
@@ -74,10 +86,14 @@ typedef struct stream_info {
   uint32_t last_assigned;
   uint8_t  stream_id;
   uint8_t  n_cons_missed;
+#if LWB_CONF_SCHED_BURST
+  uint8_t  burst;         /* # consecutive slots per IPI */
+#endif /* LWB_CONF_SCHED_BURST */
+#if LWB_CONF_SCHED_BULK
+  uint8_t  backlog;       /* # messages left to drain with bulk slots */
+#endif /* LWB_CONF_SCHED_BULK */
 } lwb_stream_list_t;
 /*---------------------------------------------------------------------------*/
-uint16_t lwb_sched_compress(uint8_t* compressed_data, uint8_t n_slots);
-/*---------------------------------------------------------------------------*/
 static uint16_t           period;
 static uint32_t           time;                               /* global time */
 static uint16_t           n_streams;                            /* # streams */
@@ -87,12 +103,93 @@ static int32_t            used_bw;   /* used bandwidth: # packets per period */
 static volatile uint8_t   n_pending_sack = 0;
 /* factor of 4 because of the memory alignment and faster index calculation! */
 static uint8_t            pending_sack[4 * LWB_CONF_SCHED_SACK_BUFFER_SIZE]; 
+/* the streams are updated incrementally while the data slots of a round are
+ * processed (see lwb_sched_proc_slot) */
+static uint8_t            update_started;
+static uint8_t            update_slot_pos; /* current position in schedule */
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+/* the stream info, sorted by node ID */
+static lwb_sched_streams_t streams;
+#else /* LWB_CONF_SCHED_STREAM_ARRAYS */
 /* a list of pointers to the stream info structures, for faster access 
  * (constant time vs. linear time) */
 static lwb_stream_list_t* streams[LWB_CONF_MAX_DATA_SLOTS];   
 LIST(streams_list);                    /* -> lists only work for data in RAM */
 /* data structures to hold the stream info */
 MEMB(streams_memb, lwb_stream_list_t, LWB_CONF_MAX_N_STREAMS);
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+static uint16_t           update_pos;            /* next stream to update */
+#else /* LWB_CONF_SCHED_STREAM_ARRAYS */
+static lwb_stream_list_t* update_pos;
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
+/*---------------------------------------------------------------------------*/
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+/**
+ * @brief   look up a stream in the stream arrays on the host
+ * @param[in] id node ID
+ * @param[in] stream_id stream ID
+ * @return the position of the stream or LWB_SCHED_STREAMS_INVALID
+ */
+static inline uint16_t
+lwb_sched_get_stream(uint16_t id, uint8_t stream_id)
+{
+  return lwb_sched_streams_find(&streams, n_streams, id, stream_id);
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief   remove a stream from the stream arrays on the host
+ * @param[in] pos position of the stream to remove
+ */
+static inline void 
+lwb_sched_del_stream(uint16_t pos) 
+{
+  if(pos >= n_streams) {    
+    return;  /* entry not found, don't do anything */
+  }
+  uint16_t node  = streams.id[pos];
+  uint8_t  stream_id  = streams.stream_id[pos];
+  used_bw = used_bw - STREAM_BW(streams.ipi[pos], streams.burst[pos]);
+  if(used_bw < 0) {
+      DEBUG_PRINT_ERROR("something went wrong, used_bw < 0");
+      used_bw = 0;
+  }
+  if(update_started && pos < update_pos) {
+    update_pos--;
+  }
+  lwb_sched_streams_remove(&streams, n_streams, pos);
+  n_streams--;
+#if LWB_CONF_SCHED_VAR_SLOTS
+  lwb_sched_slot_len_remove(node, stream_id);
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+  DEBUG_PRINT_INFO("stream %u.%u removed", node, stream_id);
+}
+#else /* LWB_CONF_SCHED_STREAM_ARRAYS */
+/**
+ * @brief   look up a stream in the stream list on the host
+ * @param[in] id node ID
+ * @param[in] stream_id stream ID
+ * @return the stream info or 0 if the stream does not exist
+ */
+static inline lwb_stream_list_t*
+lwb_sched_get_stream(uint16_t id, uint8_t stream_id)
+{
+#if LWB_CONF_SCHED_HASH_INDEX
+  uint16_t pos = lwb_sched_index_get(id, stream_id);
+  if(pos == LWB_SCHED_INDEX_INVALID) {
+    return 0;
+  }
+  return (lwb_stream_list_t*)streams_memb.mem + pos;
+#else /* LWB_CONF_SCHED_HASH_INDEX */
+  lwb_stream_list_t *s;
+  for(s = list_head(streams_list); s != 0; s = s->next) {
+    if(id == s->id && stream_id == s->stream_id) {
+      break;
+    }
+  }
+  return s;
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+}
 /*---------------------------------------------------------------------------*/
 /**
  * @brief   remove a stream from the stream list on the host
@@ -107,16 +204,26 @@ lwb_sched_del_stream(lwb_stream_list_t* stream)
   }
   uint16_t node  = stream->id;
   uint8_t  stream_id  = stream->stream_id;
-  used_bw = used_bw - MAX(1, (LWB_CONF_SCHED_PERIOD_IDLE / stream->ipi));
+  used_bw = used_bw - STREAM_BW(stream->ipi, stream->burst);
   if(used_bw < 0) {
       DEBUG_PRINT_ERROR("something went wrong, used_bw < 0");
       used_bw = 0;
   }
+#if LWB_CONF_SCHED_HASH_INDEX
+  lwb_sched_index_remove(node, stream_id);
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+  if(stream == update_pos) {
+    update_pos = stream->next;
+  }
   list_remove(streams_list, stream);
   memb_free(&streams_memb, stream);
   n_streams--;
+#if LWB_CONF_SCHED_VAR_SLOTS
+  lwb_sched_slot_len_remove(node, stream_id);
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
   DEBUG_PRINT_INFO("stream %u.%u removed", node, stream_id);
 }
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
 /*---------------------------------------------------------------------------*/
 uint8_t 
 lwb_sched_prepare_sack(void *payload) 
@@ -134,7 +241,11 @@ lwb_sched_prepare_sack(void *payload)
 void 
 lwb_sched_proc_srq(const lwb_stream_req_t* req) 
 {
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+  uint16_t pos;
+#else /* LWB_CONF_SCHED_STREAM_ARRAYS */
   lwb_stream_list_t *s = 0;
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
   
   if(LWB_INVALID_STREAM_ID == req->stream_id) { 
     DEBUG_PRINT_WARNING("invalid stream request (LWB_INVALID_STREAM_ID)");
@@ -150,38 +261,81 @@ lwb_sched_proc_srq(const lwb_stream_req_t* req)
    * an ipi of 0 implies 'remove' */
   if(req->ipi > 0) { 
     /* check if stream already exists */
-    if(n_streams) {
-      for(s = list_head(streams_list); s != 0; s = s->next) {
-        if(req->id == s->id && req->stream_id == s->stream_id) {
-          /* already exists -> update the IPI...
-           * ... but first, check whether the scheduler can support the 
-           * requested data_ipi */
-          if(used_bw + MAX(1, (LWB_CONF_SCHED_PERIOD_IDLE / req->ipi)) > 
-             BANDWIDTH_LIMIT) {
-            DEBUG_PRINT_ERROR("stream req %u.%u dropped, network saturated", 
-                              req->id, req->stream_id);
-            return;
-          }
-          used_bw = used_bw - MAX(1, (LWB_CONF_SCHED_PERIOD_IDLE / s->ipi)) + 
-                    MAX(1, (LWB_CONF_SCHED_PERIOD_IDLE / req->ipi));
-          s->ipi = req->ipi;
-          s->last_assigned = time;
-          s->n_cons_missed = 0;         /* reset this counter */
-          DEBUG_PRINT_INFO("stream %u.%u updated (IPI %u)", 
-                           req->id, req->stream_id, req->ipi);
-          goto add_sack;
-        }
-      }  
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+    pos = lwb_sched_get_stream(req->id, req->stream_id);
+    if(pos != LWB_SCHED_STREAMS_INVALID) {
+      /* already exists -> update the IPI...
+       * ... but first, check whether the scheduler can support the 
+       * requested data_ipi */
+      if(used_bw + STREAM_BW(req->ipi, LWB_STREAM_REQ_GET_BURST(req)) > 
+         BANDWIDTH_LIMIT) {
+        DEBUG_PRINT_ERROR("stream req %u.%u dropped, network saturated", 
+                          req->id, req->stream_id);
+        return;
+      }
+      used_bw = used_bw - STREAM_BW(streams.ipi[pos], streams.burst[pos]) + 
+                STREAM_BW(req->ipi, LWB_STREAM_REQ_GET_BURST(req));
+      streams.ipi[pos] = req->ipi;
+#if LWB_CONF_SCHED_BURST
+      streams.burst[pos] = LWB_STREAM_REQ_GET_BURST(req);
+#endif /* LWB_CONF_SCHED_BURST */
+      streams.last_assigned[pos] = time;
+      streams.n_cons_missed[pos] = 0;         /* reset this counter */
+      DEBUG_PRINT_INFO("stream %u.%u updated (IPI %u)", 
+                       req->id, req->stream_id, req->ipi);
+      goto add_sack;
+    }
+#else /* LWB_CONF_SCHED_STREAM_ARRAYS */
+    s = lwb_sched_get_stream(req->id, req->stream_id);
+    if(s) {
+      /* already exists -> update the IPI...
+       * ... but first, check whether the scheduler can support the 
+       * requested data_ipi */
+      if(used_bw + STREAM_BW(req->ipi, LWB_STREAM_REQ_GET_BURST(req)) > 
+         BANDWIDTH_LIMIT) {
+        DEBUG_PRINT_ERROR("stream req %u.%u dropped, network saturated", 
+                          req->id, req->stream_id);
+        return;
+      }
+      used_bw = used_bw - STREAM_BW(s->ipi, s->burst) + 
+                STREAM_BW(req->ipi, LWB_STREAM_REQ_GET_BURST(req));
+      s->ipi = req->ipi;
+#if LWB_CONF_SCHED_BURST
+      s->burst = LWB_STREAM_REQ_GET_BURST(req);
+#endif /* LWB_CONF_SCHED_BURST */
+      s->last_assigned = time;
+      s->n_cons_missed = 0;         /* reset this counter */
+      DEBUG_PRINT_INFO("stream %u.%u updated (IPI %u)", 
+                       req->id, req->stream_id, req->ipi);
+      goto add_sack;
     }
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
     /* does not exist: add the new stream...
      * but first, check whether the scheduler can support the requested ipi */
-    if(used_bw + MAX(1, (LWB_CONF_SCHED_PERIOD_IDLE / req->ipi)) > 
+    if(used_bw + STREAM_BW(req->ipi, LWB_STREAM_REQ_GET_BURST(req)) > 
        BANDWIDTH_LIMIT) {
       DEBUG_PRINT_WARNING("stream request %u.%u dropped, network saturated", 
                           req->id, req->stream_id);
       return;
     }
-    used_bw = used_bw + MAX(1, (LWB_CONF_SCHED_PERIOD_IDLE / req->ipi));
+    used_bw = used_bw + STREAM_BW(req->ipi, LWB_STREAM_REQ_GET_BURST(req));
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+    /* insert the stream, ordered by node id */
+    pos = lwb_sched_streams_insert(&streams, n_streams, req->id, 
+                                   req->stream_id);
+    if(pos == LWB_SCHED_STREAMS_INVALID) {
+      DEBUG_PRINT_ERROR("out of memory: stream request dropped");
+      return;
+    }
+    if(update_started && pos <= update_pos) {
+      update_pos++;
+    }
+    streams.ipi[pos]           = req->ipi;
+    streams.last_assigned[pos] = time;
+#if LWB_CONF_SCHED_BURST
+    streams.burst[pos]         = LWB_STREAM_REQ_GET_BURST(req);
+#endif /* LWB_CONF_SCHED_BURST */
+#else /* LWB_CONF_SCHED_STREAM_ARRAYS */
     s = memb_alloc(&streams_memb);
     if(s == 0) {
       DEBUG_PRINT_ERROR("out of memory: stream request dropped");
@@ -192,6 +346,16 @@ lwb_sched_proc_srq(const lwb_stream_req_t* req)
     s->last_assigned = time;
     s->stream_id     = req->stream_id;
     s->n_cons_missed = 0;
+#if LWB_CONF_SCHED_BURST
+    s->burst         = LWB_STREAM_REQ_GET_BURST(req);
+#endif /* LWB_CONF_SCHED_BURST */
+#if LWB_CONF_SCHED_BULK
+    s->backlog       = 0;
+#endif /* LWB_CONF_SCHED_BULK */
+#if LWB_CONF_SCHED_HASH_INDEX
+    lwb_sched_index_add(req->id, req->stream_id, 
+                        s - (lwb_stream_list_t*)streams_memb.mem);
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
     /* insert the stream into the list, ordered by node id */
     lwb_stream_list_t *prev;
     for(prev = list_head(streams_list); prev != NULL; prev = prev->next) {
@@ -201,19 +365,18 @@ lwb_sched_proc_srq(const lwb_stream_req_t* req)
       }
     }
     list_insert(streams_list, prev, s);   
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
     n_streams++;
     DEBUG_PRINT_INFO("stream %u.%u added (IPI %u)", req->id, 
                      req->stream_id, req->ipi);         
   } else {
     /* remove this stream */
-    for(s = list_head(streams_list); s != 0; s = s->next) {
-      if(req->id == s->id && req->stream_id == s->stream_id) {
-        break;
-      }
-    }
-    lwb_sched_del_stream(s);
+    lwb_sched_del_stream(lwb_sched_get_stream(req->id, req->stream_id));
   }
 add_sack:
+#if LWB_CONF_SCHED_VAR_SLOTS
+  lwb_sched_slot_len_update(req);
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
   /* insert into the list of pending S-ACKs */
   /* use memcpy to avoid pointer misalignment errors */
   memcpy(pending_sack + n_pending_sack * 4, &req->id, 2);  
@@ -221,47 +384,126 @@ add_sack:
   n_pending_sack++;
 }
 /*---------------------------------------------------------------------------*/
+/**
+ * @brief checks whether a packet of the stream id/stream_id has been received
+ * in the last round (merge-join of the stream list and the schedule)
+ * @param[in] id the node ID to search for
+ * @param[in] stream_id the stream ID to search for
+ * @param[in] node_list the node IDs of the data slots of the last round
+ * @param[in] stream_list the stream IDs of the packets received in these 
+ * slots (LWB_INVALID_STREAM_ID if no packet was received)
+ * @param[in] list_len the number of entries in the node and stream list
+ * @param[in,out] pos the current position in the node and stream list, must
+ * be set to zero before the first call
+ * @return one if the id/stream_id exists in the list, zero otherwise
+ * @remark the function must be called for the streams in increasing order 
+ * of their node IDs; the node IDs in node_list are sorted in increasing order
+ * except for the slots of the host at the beginning of the schedule, which 
+ * never contain a received packet, i.e. the list is traversed only once for 
+ * all streams
+ */
 static inline uint8_t 
 lwb_sched_stream_in_list(uint16_t id, 
                          uint8_t stream_id, 
                          const uint16_t* node_list, 
                          const uint8_t* stream_list, 
-                         uint8_t list_len) 
+                         uint8_t list_len,
+                         uint8_t* pos) 
 {
-  /* assume that the node IDs in node_list are sorted in increasing order */
-  while(list_len && *node_list <= id) {
-    if(*node_list == id && *stream_list == stream_id) {
+  uint8_t i = *pos;
+  /* skip the slots of nodes with a smaller ID and the slots without a 
+   * received packet */
+  while(i < list_len && 
+        (node_list[i] < id || stream_list[i] == LWB_INVALID_STREAM_ID)) {
+    i++;
+  }
+  *pos = i;
+  /* a node may have several streams: check all slots of this node */
+  while(i < list_len && node_list[i] == id) {
+    if(stream_list[i] == stream_id) {
       return 1;
     }
-    node_list++;
-    stream_list++;  
-    list_len--;
+    i++;
   }
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+#if LWB_CONF_SCHED_BULK
+void
+lwb_sched_proc_backlog(uint16_t id, uint8_t stream_id, uint8_t backlog)
+{
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+  uint16_t pos = lwb_sched_get_stream(id, stream_id);
+  if(pos != LWB_SCHED_STREAMS_INVALID) {
+    streams.backlog[pos] = backlog;
+  }
+#else /* LWB_CONF_SCHED_STREAM_ARRAYS */
+  lwb_stream_list_t* s = lwb_sched_get_stream(id, stream_id);
+  if(s) {
+    s->backlog = backlog;
+  }
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
+}
+#endif /* LWB_CONF_SCHED_BULK */
+/*---------------------------------------------------------------------------*/
 void 
 lwb_sched_set_period(uint16_t p)
 {
   if (p) { period = p; }
 }
 /*---------------------------------------------------------------------------*/
-uint16_t 
-lwb_sched_compute(lwb_schedule_t * const sched, 
-                  const uint8_t * const streams_to_update, 
-                  uint8_t reserve_slot_host) 
+/**
+ * @brief updates the streams of the nodes up to last_id according to the 
+ * packets received in the current round and removes the streams with too
+ * many consecutive misses (first part of the schedule computation)
+ * @param[in] sched the schedule of the current round
+ * @param[in] streams_to_update the stream IDs of the received packets
+ * @param[in] n_slots the number of data slots processed so far
+ * @param[in] last_id the largest node ID whose data slots are all known
+ * @remark the streams are processed in the order of their node IDs, the 
+ * position is kept until the new schedule is computed
+ */
+static void
+lwb_sched_update_streams(const lwb_schedule_t * const sched, 
+                         const uint8_t * const streams_to_update, 
+                         uint8_t n_slots,
+                         uint16_t last_id)
 {
-  static uint16_t slots_tmp[LWB_CONF_MAX_DATA_SLOTS];
-    
-  first_index = 0; 
-  n_slots_assigned = 0;
-  
-  memset(streams, 0, sizeof(streams));   /* clear content of the stream list */
-  lwb_stream_list_t *curr_stream = list_head(streams_list);
-  /* loop through all the streams in the list */
-  while(curr_stream != NULL) {
+  if(!update_started) {
+    update_started = 1;
+    update_slot_pos = 0;
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+    update_pos = 0;
+#else /* LWB_CONF_SCHED_STREAM_ARRAYS */
+    update_pos = list_head(streams_list);
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
+  }
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+  while(update_pos < n_streams && streams.id[update_pos] <= last_id) {
+    uint16_t i = update_pos;
+    if(lwb_sched_stream_in_list(streams.id[i], streams.stream_id[i], 
+        sched->slot, streams_to_update, n_slots, &update_slot_pos)) {
+      streams.n_cons_missed[i] = 0;
+    } else if(streams.n_cons_missed[i] & 0x80) {
+      /* no packet received from this stream */
+      streams.n_cons_missed[i] &= 0x7f; /* clear the last bit */
+      streams.n_cons_missed[i]++;
+    }
+    if(streams.n_cons_missed[i] > LWB_CONF_SCHED_STREAM_REMOVAL_THRES) {
+      /* too many consecutive slots without reception: delete this stream, 
+       * the next stream moves to position i */
+      lwb_sched_del_stream(i);
+    } else {
+      update_pos++;
+    }
+  }
+#else /* LWB_CONF_SCHED_STREAM_ARRAYS */
+  lwb_stream_list_t *curr_stream;
+  while(update_pos != NULL && update_pos->id <= last_id) {
+    curr_stream = update_pos;
+    update_pos = curr_stream->next;
     if(lwb_sched_stream_in_list(curr_stream->id, curr_stream->stream_id, 
-        sched->slot, streams_to_update, LWB_SCHED_N_SLOTS(sched))) {
+        sched->slot, streams_to_update, n_slots, &update_slot_pos)) {
       curr_stream->n_cons_missed = 0;
     } else if(curr_stream->n_cons_missed & 0x80) {
       /* no packet received from this stream */
@@ -270,13 +512,44 @@ lwb_sched_compute(lwb_schedule_t * const sched,
     }
     if(curr_stream->n_cons_missed > LWB_CONF_SCHED_STREAM_REMOVAL_THRES) {
       /* too many consecutive slots without reception: delete this stream */
-      lwb_stream_list_t *stream_to_remove = curr_stream;
-      curr_stream = curr_stream->next;
-      lwb_sched_del_stream(stream_to_remove);
-    } else {
-      curr_stream = curr_stream->next;
+      lwb_sched_del_stream(curr_stream);
     }
   }
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
+}
+/*---------------------------------------------------------------------------*/
+void 
+lwb_sched_proc_slot(const lwb_schedule_t * const sched,
+                    const uint8_t * const streams_to_update,
+                    uint8_t slot_idx)
+{
+  uint16_t last_id = LWB_SCHED_LAST_KNOWN_ID(sched, slot_idx);
+  if(last_id) {
+    lwb_sched_update_streams(sched, streams_to_update, slot_idx + 1, last_id);
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint16_t 
+lwb_sched_compute(lwb_schedule_t * const sched, 
+                  const uint8_t * const streams_to_update, 
+                  uint8_t reserve_slot_host) 
+{
+  static uint16_t slots_tmp[LWB_CONF_MAX_DATA_SLOTS];
+    
+  first_index = 0; 
+  n_slots_assigned = 0;
+  
+  /* update the remaining streams (all streams if lwb_sched_proc_slot() has
+   * not been called in this round) */
+  lwb_sched_update_streams(sched, streams_to_update, 
+                           LWB_SCHED_N_SLOTS(sched), 0xffff);
+  update_started = 0;
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+  uint16_t i;
+#else /* LWB_CONF_SCHED_STREAM_ARRAYS */
+  lwb_stream_list_t *curr_stream;
+  memset(streams, 0, sizeof(streams));   /* clear content of the stream list */
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
   /* clear the content of the schedule (do NOT move this line further above!)*/
   memset(sched->slot, 0, sizeof(sched->slot));  
   
@@ -301,6 +574,86 @@ lwb_sched_compute(lwb_schedule_t * const sched,
 
   /* random initial position in the list */
   uint16_t rand_init_pos = (random_rand() >> 1) % n_streams;
+#if LWB_CONF_SCHED_BULK
+  /* the data slots that are not needed for the periodic traffic are spread
+   * over the streams with a backlog, in proportion to the backlog */
+  uint16_t bulk_total = 0;
+  int32_t  bulk_spare = LWB_CONF_MAX_DATA_SLOTS - n_slots_assigned - used_bw;
+  uint16_t n_prev;
+ #if LWB_CONF_SCHED_STREAM_ARRAYS
+  for(i = 0; i < n_streams; i++) {
+    bulk_total += streams.backlog[i];
+  }
+ #else /* LWB_CONF_SCHED_STREAM_ARRAYS */
+  for(curr_stream = list_head(streams_list); curr_stream != 0; 
+      curr_stream = curr_stream->next) {
+    bulk_total += curr_stream->backlog;
+  }
+ #endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
+  if(bulk_spare <= 0) {
+    bulk_total = 0;     /* no spare slots */
+  }
+#endif /* LWB_CONF_SCHED_BULK */
+  
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+  i = rand_init_pos;
+  do {
+  #if LWB_CONF_SCHED_BULK
+    n_prev = n_slots_assigned;
+  #endif /* LWB_CONF_SCHED_BULK */
+    /* assign slots for this stream, if possible */
+    if((n_slots_assigned < LWB_CONF_MAX_DATA_SLOTS) && 
+       (time >= (streams.ipi[i] + streams.last_assigned[i]))) {
+      /* the number of slots to assign to stream i */
+      uint16_t to_assign = (time - streams.last_assigned[i]) / 
+                           streams.ipi[i];  /* elapsed time / period */
+  #if LWB_CONF_DATA_ACK
+      /* no packet received in the last round? -> give extra slot */
+      if(streams.n_cons_missed[i]) {
+        to_assign++;
+      }
+  #endif /* LWB_CONF_DATA_ACK */
+      if(to_assign > LWB_CONF_MAX_DATA_SLOTS - n_slots_assigned) {
+        to_assign = LWB_CONF_MAX_DATA_SLOTS - n_slots_assigned;
+      }
+      streams.last_assigned[i] += (to_assign - streams.n_cons_missed[i]) *
+                                  streams.ipi[i];
+  #if LWB_CONF_SCHED_BURST
+      /* consecutive slots per IPI, as many as fit into this round */
+      to_assign = MIN(to_assign * streams.burst[i], 
+                      LWB_CONF_MAX_DATA_SLOTS - n_slots_assigned);
+  #endif /* LWB_CONF_SCHED_BURST */
+      for(; to_assign > 0; to_assign--, n_slots_assigned++) {
+        slots_tmp[n_slots_assigned] = streams.id[i];
+      }
+      /* set the last bit, we are expecting a packet from this stream in 
+       * the next round */
+      streams.n_cons_missed[i] |= 0x80; 
+    }
+  #if LWB_CONF_SCHED_BULK
+    if(bulk_total && streams.backlog[i]) {
+      /* the periodic slots drain the backlog as well */
+      uint16_t n_bulk = n_slots_assigned - n_prev;
+      streams.backlog[i] -= MIN(streams.backlog[i], n_bulk);
+      /* bulk slots, right after the periodic slots of this stream */
+      n_bulk = MAX(1, (uint32_t)bulk_spare * streams.backlog[i] / bulk_total);
+      n_bulk = MIN(n_bulk, MIN(streams.backlog[i], 
+                               LWB_CONF_MAX_DATA_SLOTS - n_slots_assigned));
+      streams.backlog[i] -= n_bulk;
+      for(; n_bulk > 0; n_bulk--, n_slots_assigned++) {
+        slots_tmp[n_slots_assigned] = streams.id[i];
+      }
+    }
+  #endif /* LWB_CONF_SCHED_BULK */
+    /* go to the next stream */
+    i++;
+    if(i == n_streams) {
+      /* end of the arrays: start again from the first stream */
+      i = 0;
+      first_index = n_slots_assigned; 
+    }
+  } while(i != rand_init_pos);
+#else /* LWB_CONF_SCHED_STREAM_ARRAYS */
   uint16_t i;
   
   curr_stream = list_head(streams_list);
@@ -311,6 +664,9 @@ lwb_sched_compute(lwb_schedule_t * const sched,
   /* initial stream being processed */
   lwb_stream_list_t *init_stream = curr_stream;
   do {
+  #if LWB_CONF_SCHED_BULK
+    n_prev = n_slots_assigned;
+  #endif /* LWB_CONF_SCHED_BULK */
     /* assign slots for this stream, if possible */
     if((n_slots_assigned < LWB_CONF_MAX_DATA_SLOTS) && 
        (time >= (curr_stream->ipi + curr_stream->last_assigned))) {
@@ -328,6 +684,11 @@ lwb_sched_compute(lwb_schedule_t * const sched,
       }
       curr_stream->last_assigned += (to_assign - curr_stream->n_cons_missed) *
                                     curr_stream->ipi;
+  #if LWB_CONF_SCHED_BURST
+      /* consecutive slots per IPI, as many as fit into this round */
+      to_assign = MIN(to_assign * curr_stream->burst, 
+                      LWB_CONF_MAX_DATA_SLOTS - n_slots_assigned);
+  #endif /* LWB_CONF_SCHED_BURST */
       for(; to_assign > 0; to_assign--, n_slots_assigned++) {
         slots_tmp[n_slots_assigned] = curr_stream->id;
         streams[n_slots_assigned] = curr_stream;
@@ -336,6 +697,23 @@ lwb_sched_compute(lwb_schedule_t * const sched,
        * the next round */
       curr_stream->n_cons_missed |= 0x80; 
     }
+  #if LWB_CONF_SCHED_BULK
+    if(bulk_total && curr_stream->backlog) {
+      /* the periodic slots drain the backlog as well */
+      uint16_t n_bulk = n_slots_assigned - n_prev;
+      curr_stream->backlog -= MIN(curr_stream->backlog, n_bulk);
+      /* bulk slots, right after the periodic slots of this stream */
+      n_bulk = MAX(1, (uint32_t)bulk_spare * curr_stream->backlog / 
+                      bulk_total);
+      n_bulk = MIN(n_bulk, MIN(curr_stream->backlog, 
+                               LWB_CONF_MAX_DATA_SLOTS - n_slots_assigned));
+      curr_stream->backlog -= n_bulk;
+      for(; n_bulk > 0; n_bulk--, n_slots_assigned++) {
+        slots_tmp[n_slots_assigned] = curr_stream->id;
+        streams[n_slots_assigned] = curr_stream;
+      }
+    }
+  #endif /* LWB_CONF_SCHED_BULK */
     /* go to the next stream in the list */
     curr_stream = curr_stream->next;
     if(curr_stream == NULL) {
@@ -344,6 +722,7 @@ lwb_sched_compute(lwb_schedule_t * const sched,
       first_index = n_slots_assigned; 
     }
   } while(curr_stream != init_stream);
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
   
   /* copy into new data structure to keep the node IDs ordered */
   memcpy(&sched->slot[reserve_slot_host], &slots_tmp[first_index], 
@@ -355,6 +734,9 @@ set_schedule: ;
 #if LWB_CONF_DATA_ACK
   uint16_t last_n_slots = LWB_SCHED_N_SLOTS(sched);
 #endif /* LWB_CONF_DATA_ACK */
+#if LWB_CONF_DATA_QUEUE_DEPTH
+  n_slots_assigned = lwb_sched_add_queue_depth_slots(sched, n_slots_assigned);
+#endif /* LWB_CONF_DATA_QUEUE_DEPTH */
   sched->n_slots = n_slots_assigned;
   if(n_pending_sack) {
     LWB_SCHED_SET_SACK_SLOT(sched);
@@ -369,9 +751,11 @@ set_schedule: ;
 #endif /* LWB_CONF_DATA_ACK */
   
   uint8_t compressed_size;
+#if LWB_CONF_SCHED_VAR_SLOTS
+  lwb_sched_set_slot_len(sched);   /* before the slots are compressed */
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
 #if LWB_CONF_SCHED_COMPRESS
-  compressed_size = lwb_sched_compress((uint8_t*)sched->slot, 
-                                       n_slots_assigned);
+  compressed_size = lwb_sched_compress(sched);
   if((compressed_size + LWB_SCHED_PKT_HEADER_LEN) > LWB_CONF_MAX_PKT_LEN) {
     DEBUG_PRINT_ERROR("compressed schedule is too big!");
   }
@@ -394,12 +778,25 @@ set_schedule: ;
 uint16_t 
 lwb_sched_init(lwb_schedule_t* sched) 
 {
+#if !LWB_CONF_SCHED_STREAM_ARRAYS
   /* initialize streams member and list */
   memb_init(&streams_memb);
   list_init(streams_list);
+#if LWB_CONF_SCHED_HASH_INDEX
+  lwb_sched_index_init();
+#endif /* LWB_CONF_SCHED_HASH_INDEX */
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
+#if LWB_CONF_SCHED_VAR_SLOTS
+  lwb_sched_slot_len_init();
+#endif /* LWB_CONF_SCHED_VAR_SLOTS */
+#if LWB_CONF_DATA_QUEUE_DEPTH
+  lwb_sched_queue_depth_init();
+#endif /* LWB_CONF_DATA_QUEUE_DEPTH */
   n_streams = 0;
   n_slots_assigned = 0;
   n_pending_sack = 0;
+  used_bw = 0;
+  update_started = 0;
   time = 0;                             /* global time starts now */
   period = LWB_CONF_SCHED_PERIOD_IDLE; 
   sched->n_slots = 0;
@@ -415,6 +812,26 @@ lwb_sched_init(lwb_schedule_t* sched)
   return LWB_SCHED_PKT_HEADER_LEN; /* empty schedule, no slots allocated yet */
 }
 /*---------------------------------------------------------------------------*/
+uint16_t
+lwb_sched_set_time(lwb_schedule_t* sched, uint32_t t)
+{
+  time = t;     /* the streams are kept */
+  if(sched) {
+    sched->n_slots = 0;
+    LWB_SCHED_SET_CONT_SLOT(sched);     /* include a contention slot */
+    sched->time = time;
+    sched->period = period;
+    LWB_SCHED_SET_AS_1ST(sched); 
+  }
+  return LWB_SCHED_PKT_HEADER_LEN;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+lwb_sched_get_n_streams(void)
+{
+  return n_streams;
+}
+/*---------------------------------------------------------------------------*/
 
 #endif /* LWB_SCHED_STATIC */
 
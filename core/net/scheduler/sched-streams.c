@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @addtogroup  lwb-scheduler
+ * @{
+ *
+ * @defgroup    sched-streams Stream arrays
+ * @{
+ *
+ * @file 
+ * @brief stream information of the host stored in sorted parallel arrays
+ *
+ * An alternative to the linked list of stream info structures: the fields 
+ * of all streams are kept in separate arrays which are sorted by node ID, 
+ * i.e. the schedulers iterate over contiguous memory and the streams are 
+ * found with a binary search. Inserting and removing a stream shifts the 
+ * following entries.
+ */
+ 
+#include "lwb.h"
+
+#if LWB_CONF_SCHED_STREAM_ARRAYS
+
+/* shifts the entries [from, to) of all arrays by one position, dir must be 
+ * +1 (make space at position from) or -1 (overwrite position from - 1) */
+#define SCHED_STREAMS_SHIFT(s, from, to, dir) { \
+  memmove(&(s)->id[(from) + (dir)], &(s)->id[from], \
+          ((to) - (from)) * sizeof((s)->id[0])); \
+  memmove(&(s)->ipi[(from) + (dir)], &(s)->ipi[from], \
+          ((to) - (from)) * sizeof((s)->ipi[0])); \
+  memmove(&(s)->last_assigned[(from) + (dir)], &(s)->last_assigned[from], \
+          ((to) - (from)) * sizeof((s)->last_assigned[0])); \
+  memmove(&(s)->stream_id[(from) + (dir)], &(s)->stream_id[from], \
+          ((to) - (from)) * sizeof((s)->stream_id[0])); \
+  memmove(&(s)->n_cons_missed[(from) + (dir)], &(s)->n_cons_missed[from], \
+          ((to) - (from)) * sizeof((s)->n_cons_missed[0])); \
+  SCHED_STREAMS_SHIFT_BURST(s, from, to, dir); \
+  SCHED_STREAMS_SHIFT_BACKLOG(s, from, to, dir); \
+}
+#if LWB_CONF_SCHED_BURST
+#define SCHED_STREAMS_SHIFT_BURST(s, from, to, dir) \
+  memmove(&(s)->burst[(from) + (dir)], &(s)->burst[from], \
+          ((to) - (from)) * sizeof((s)->burst[0]))
+#else /* LWB_CONF_SCHED_BURST */
+#define SCHED_STREAMS_SHIFT_BURST(s, from, to, dir)
+#endif /* LWB_CONF_SCHED_BURST */
+#if LWB_CONF_SCHED_BULK
+#define SCHED_STREAMS_SHIFT_BACKLOG(s, from, to, dir) \
+  memmove(&(s)->backlog[(from) + (dir)], &(s)->backlog[from], \
+          ((to) - (from)) * sizeof((s)->backlog[0]))
+#else /* LWB_CONF_SCHED_BULK */
+#define SCHED_STREAMS_SHIFT_BACKLOG(s, from, to, dir)
+#endif /* LWB_CONF_SCHED_BULK */
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief returns the position of the first stream with a node ID >= id 
+ * (lower bound) or > id (upper bound)
+ */
+static inline uint16_t
+lwb_sched_streams_bound(const lwb_sched_streams_t* s, 
+                        uint16_t n_streams,
+                        uint16_t id,
+                        uint8_t upper)
+{
+  uint16_t lo = 0, hi = n_streams;
+  while(lo < hi) {
+    uint16_t mid = (lo + hi) >> 1;
+    if(s->id[mid] < id || (upper && s->id[mid] == id)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+lwb_sched_streams_find(const lwb_sched_streams_t* s, 
+                       uint16_t n_streams,
+                       uint16_t id, 
+                       uint8_t stream_id)
+{
+  uint16_t i = lwb_sched_streams_bound(s, n_streams, id, 0);
+  /* a node may have several streams: check all entries with this node ID */
+  while(i < n_streams && s->id[i] == id) {
+    if(s->stream_id[i] == stream_id) {
+      return i;
+    }
+    i++;
+  }
+  return LWB_SCHED_STREAMS_INVALID;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+lwb_sched_streams_insert(lwb_sched_streams_t* s, 
+                         uint16_t n_streams,
+                         uint16_t id, 
+                         uint8_t stream_id)
+{
+  if(n_streams >= LWB_CONF_MAX_N_STREAMS) {
+    return LWB_SCHED_STREAMS_INVALID;
+  }
+  uint16_t pos = lwb_sched_streams_bound(s, n_streams, id, 1);
+  SCHED_STREAMS_SHIFT(s, pos, n_streams, 1);
+  s->id[pos]            = id;
+  s->ipi[pos]           = 0;
+  s->last_assigned[pos] = 0;
+  s->stream_id[pos]     = stream_id;
+  s->n_cons_missed[pos] = 0;
+#if LWB_CONF_SCHED_BURST
+  s->burst[pos]         = 1;
+#endif /* LWB_CONF_SCHED_BURST */
+#if LWB_CONF_SCHED_BULK
+  s->backlog[pos]       = 0;
+#endif /* LWB_CONF_SCHED_BULK */
+  return pos;
+}
+/*---------------------------------------------------------------------------*/
+void
+lwb_sched_streams_remove(lwb_sched_streams_t* s, 
+                         uint16_t n_streams,
+                         uint16_t pos)
+{
+  if(pos < n_streams) {
+    SCHED_STREAMS_SHIFT(s, pos + 1, n_streams, -1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+
+#endif /* LWB_CONF_SCHED_STREAM_ARRAYS */
+
+/**
+ * @}
+ * @}
+ */
@@ -43,9 +43,7 @@ volatile uint8_t  lwb_joined_streams_cnt = 0;    /* number of active streams */
 void 
 lwb_stream_init() 
 {
-  memset(streams, 0, 
-         (LWB_STREAM_INFO_HEADER_LEN + LWB_CONF_STREAM_EXTRA_DATA_LEN) * 
-         LWB_CONF_MAX_N_STREAMS_PER_NODE);
+  memset(streams, 0, sizeof(streams));
   lwb_pending_requests = 0;
   lwb_joined_streams_cnt = 0;
 }
@@ -93,6 +91,7 @@ lwb_stream_add(const lwb_stream_req_t* const stream_info)
       memcpy((uint8_t*)&streams[i] + 2,     /* skip the first 2 bytes */
              (uint8_t*)stream_info + 4,     /* skip the first 4 bytes */
              LWB_STREAM_REQ_HEADER_LEN - 4 + LWB_CONF_STREAM_EXTRA_DATA_LEN);
+      streams[i].max_len = stream_info->max_len;
       streams[i].state = LWB_STREAM_STATE_WAITING;                 /* rejoin */    
       lwb_pending_requests |= (1 << i);     /* set the 'request pending' bit */
       DEBUG_PRINT_INFO("stream with ID %u updated (IPI %u)", 
@@ -109,6 +108,8 @@ lwb_stream_add(const lwb_stream_req_t* const stream_info)
     /* copy the stream info (skip the first 2 bytes, the node ID) */
     memcpy((uint8_t*)&streams[idx], (uint8_t*)stream_info + 2, 
            (LWB_STREAM_REQ_HEADER_LEN + LWB_CONF_STREAM_EXTRA_DATA_LEN - 2));
+    streams[idx].max_len = stream_info->max_len;
+    streams[idx].prio = LWB_PRIO_LOWEST;
     streams[idx].state = LWB_STREAM_STATE_WAITING;
     lwb_pending_requests |= (1 << idx);     /* set the 'request pending' bit */
     DEBUG_PRINT_INFO("stream with ID %u added (IPI %u)", 
@@ -173,11 +174,52 @@ lwb_stream_prepare_req(lwb_stream_req_t* const out_srq_pkt, uint8_t stream_id)
     memcpy((uint8_t*)out_srq_pkt + 3,  /* skip the first 3 bytes */
            (uint8_t*)&streams[stream_id] + 1, 
            LWB_STREAM_REQ_HEADER_LEN - 3 + LWB_CONF_STREAM_EXTRA_DATA_LEN);
+    out_srq_pkt->max_len = streams[stream_id].max_len;
     return 1;
   }
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+uint8_t
+lwb_stream_get_max_len(uint8_t stream_id)
+{
+  uint8_t i = 0;
+  for(; i < LWB_CONF_MAX_N_STREAMS_PER_NODE; i++) {
+    if(streams[i].id == stream_id && 
+       streams[i].state != LWB_STREAM_STATE_INACTIVE) {
+      return streams[i].max_len;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+lwb_stream_set_prio(uint8_t stream_id, uint8_t prio)
+{
+  uint8_t i = 0;
+  for(; i < LWB_CONF_MAX_N_STREAMS_PER_NODE; i++) {
+    if(streams[i].id == stream_id && 
+       streams[i].state != LWB_STREAM_STATE_INACTIVE) {
+      streams[i].prio = (prio < LWB_CONF_OUT_N_PRIO) ? prio : LWB_PRIO_LOWEST;
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+lwb_stream_get_prio(uint8_t stream_id)
+{
+  uint8_t i = 0;
+  for(; i < LWB_CONF_MAX_N_STREAMS_PER_NODE; i++) {
+    if(streams[i].id == stream_id && 
+       streams[i].state != LWB_STREAM_STATE_INACTIVE) {
+      return streams[i].prio;
+    }
+  }
+  return LWB_PRIO_LOWEST;
+}
+/*---------------------------------------------------------------------------*/
 lwb_stream_state_t lwb_stream_get_state(uint8_t stream_id)
 {
   uint8_t i = 0;
@@ -189,4 +231,16 @@ lwb_stream_state_t lwb_stream_get_state(uint8_t stream_id)
   }
   return LWB_STREAM_STATE_INACTIVE;    
 }
+/*---------------------------------------------------------------------------*/
+uint8_t
+lwb_stream_get_first_id(void)
+{
+  uint8_t i = 0;
+  for(; i < LWB_CONF_MAX_N_STREAMS_PER_NODE; i++) {
+    if(streams[i].state != LWB_STREAM_STATE_INACTIVE) {
+      return streams[i].id;
+    }
+  }
+  return 0;
+}
 /*---------------------------------------------------------------------------*/
\ No newline at end of file
@@ -57,6 +57,12 @@
 #define LWB_STREAMS_ACTIVE              ( lwb_joined_streams_cnt != 0 )
 
 #define LWB_INVALID_STREAM_ID           0xff
+/* reserved, marks an aggregated data packet (LWB_CONF_DATA_AGGREGATION) */
+#define LWB_AGGR_STREAM_ID              0xfe
+/* reserved, marks a fragment of a message (LWB_CONF_FRAG, see frag.h) */
+#define LWB_FRAG_STREAM_ID              0xfd
+/* reserved, marks a data packet with a backlog (LWB_CONF_SCHED_BULK) */
+#define LWB_BULK_STREAM_ID              0xfc
 
 /**
  * @brief the different states of a stream
@@ -87,6 +93,8 @@ typedef struct {
 #if LWB_CONF_STREAM_EXTRA_DATA_LEN
   uint8_t             extra_data[LWB_CONF_STREAM_EXTRA_DATA_LEN];
 #endif /* LWB_CONF_STREAM_EXTRA_DATA_LEN */
+  uint8_t             max_len;  /* max. payload length (see lwb_stream_req_t) */
+  uint8_t             prio;     /* priority class of the outgoing messages */
 } lwb_stream_t;
 
 
@@ -140,6 +148,27 @@ uint8_t
 lwb_stream_prepare_req(lwb_stream_req_t* const out_srq_pkt, uint8_t stream_id);
 
 
+/**
+ * @brief get the max. payload length of a stream
+ * @return the max. payload length as passed in the stream request or 0 if the
+ * stream does not exist or has no limit
+ */
+uint8_t lwb_stream_get_max_len(uint8_t stream_id);
+
+/**
+ * @brief set the priority class of the outgoing messages of a stream (local
+ * setting, not part of the stream request)
+ * @param prio the priority class, 0 = highest (see LWB_CONF_OUT_N_PRIO)
+ * @return 1 if successful, 0 if the stream does not exist
+ */
+uint8_t lwb_stream_set_prio(uint8_t stream_id, uint8_t prio);
+
+/**
+ * @brief get the priority class of the outgoing messages of a stream
+ * @return the priority class or LWB_PRIO_LOWEST if the stream does not exist
+ */
+uint8_t lwb_stream_get_prio(uint8_t stream_id);
+
 /**
  * @brief get the state of the stream
  * @return LWB_STREAM_STATE_WAITING if the stream request is pending, 
@@ -148,6 +177,14 @@ lwb_stream_prepare_req(lwb_stream_req_t* const out_srq_pkt, uint8_t stream_id);
  */
 lwb_stream_state_t lwb_stream_get_state(uint8_t stream_id);
 
+/**
+ * @brief get the ID of the first stream of this node (used with LWB_VERSION 2
+ * where the stream of a message is implied)
+ * @return the ID of the first stream that has not been disabled or 0 if there
+ * is no such stream
+ */
+uint8_t lwb_stream_get_first_id(void);
+
 
 #endif /* __STREAM_H__ */
 
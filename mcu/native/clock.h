@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @addtogroup  Platform
+ * @{
+ *
+ * @defgroup    clock Clock
+ * @{
+ *
+ * @file
+ *
+ * @brief virtual clock of the native platform
+ *
+ * There is no real clock on the native platform. Instead, a virtual time
+ * (in HF ticks) is advanced in discrete steps from one timer event to the
+ * next, i.e. the code runs as fast as the host machine allows, and the
+ * execution of code itself does not consume any (virtual) time.
+ */
+
+#ifndef __CLOCK_H__
+#define __CLOCK_H__
+
+/* emulate the same clock speeds as on the CC430 */
+#define XT1CLK_SPEED    32768
+#define XT2CLK_SPEED    26000000LU
+#define MCLK_SPEED      (XT2CLK_SPEED / 2)      /* 13 MHz */
+#define ACLK_SPEED      (XT1CLK_SPEED / 1)
+#define SMCLK_SPEED     (XT2CLK_SPEED / 8)      /* 3.25 MHz */
+
+#define IS_XT2_ENABLED() 1
+#define ENABLE_XT2()
+#define ENABLE_XT1()
+#define DISABLE_XT2()
+#define DISABLE_XT1()
+#define DISABLE_ACLK()
+#define DISABLE_SMCLK()
+#define ENABLE_FLL()
+#define DISABLE_FLL()
+#define WAIT_FOR_OSC()
+
+/* corresponds to roughly 1.008246 seconds (HF timer overflows ~50x/sec.) */
+#define CLOCK_SECOND    50
+
+/* busy waiting does not consume any virtual time */
+#define WAIT_MS(ms)
+#define DELAY(ms)
+#define __delay_cycles(c)
+
+/**
+ * @brief the virtual time in HF clock ticks (SMCLK_SPEED) since startup
+ */
+extern rtimer_clock_t clock_vtime;
+
+/**
+ * @brief initialize the clock system (resets the virtual time)
+ */
+void clock_init(void);
+
+/**
+ * @brief get the virtual time of the next pending timer event (rtimer or
+ * etimer)
+ * @param[out] vtime the virtual time of the next event (HF ticks)
+ * @return 1 if there is a pending event, 0 otherwise
+ */
+uint8_t clock_next_event(rtimer_clock_t* vtime);
+
+/**
+ * @brief execute all timer events which are due at the current virtual time
+ * (rtimer callbacks and etimer poll)
+ */
+void clock_run_expired(void);
+
+/**
+ * @brief advance the virtual time to the next pending timer event (rtimer
+ * or etimer) and execute it
+ * @param[in] until upper bound for the virtual time (HF ticks)
+ * @return 1 if an event has been executed, 0 if there is no pending event 
+ * before 'until' (in this case the virtual time is set to 'until')
+ */
+uint8_t clock_advance(rtimer_clock_t until);
+
+
+#endif /* __CLOCK_H__ */
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief Glossy for the native platform
+ *
+ * There is no radio on the native platform: the initiator 'transmits' the
+ * packet n_tx_max times and receivers never receive anything. This is 
+ * sufficient to run the LWB host and source threads on the virtual clock.
+ */
+
+#include "contiki.h"
+#include "platform.h"
+
+/*---------------------------------------------------------------------------*/
+typedef struct {
+  rtimer_clock_t t_ref;
+  uint8_t *payload;
+  uint16_t initiator_id;
+  uint8_t payload_len;
+  uint8_t active;
+  uint8_t n_rx;
+  uint8_t n_tx;
+  uint8_t t_ref_updated;
+} glossy_state_t;
+/*---------------------------------------------------------------------------*/
+static glossy_state_t g;
+/*---------------------------- Glossy interface -----------------------------*/
+void
+glossy_start(uint16_t initiator_id, uint8_t *payload, uint8_t payload_len,
+             uint8_t n_tx_max, glossy_sync_t sync, glossy_rf_cal_t rf_cal)
+{
+  DEBUG_PRINT_VERBOSE("Glossy started: in=%u, pl=%u, n=%u, s=%u", initiator_id,
+                      payload_len, n_tx_max, sync);
+  g.active = 1;
+  g.initiator_id = initiator_id;
+  g.payload = payload;
+  g.payload_len = payload_len;
+  g.n_rx = 0;
+  g.n_tx = 0;
+  g.t_ref_updated = 0;
+
+  if(initiator_id == node_id) {
+    g.n_tx = n_tx_max;
+    if(sync == GLOSSY_WITH_SYNC) {
+      g.t_ref = rtimer_now_hf();
+      g.t_ref_updated = 1;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_stop(void)
+{
+  g.active = 0;
+  return g.n_rx;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_is_active(void)
+{
+  return g.active;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_get_n_rx(void)
+{
+  return g.n_rx;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_get_n_tx(void)
+{
+  return g.n_tx;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_get_payload_len(void)
+{
+  return g.payload_len;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_is_t_ref_updated(void)
+{
+  return g.t_ref_updated;
+}
+/*---------------------------------------------------------------------------*/
+rtimer_clock_t
+glossy_get_t_ref(void)
+{
+  return g.t_ref;
+}
+/*---------------------------------------------------------------------------*/
+#if GLOSSY_CONF_COLLECT_STATS
+uint8_t
+glossy_get_n_rx_started(void)
+{
+  return g.n_rx;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_get_n_crc_ok(void)
+{
+  return g.n_rx;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_get_n_rx_fail(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int8_t
+glossy_get_snr(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int8_t
+glossy_get_rssi(int8_t* rssi)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_get_relay_cnt_first_rx(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t 
+glossy_get_relay_cnt(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+glossy_get_per(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+glossy_get_fsr(void)
+{
+  return 10000;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+glossy_get_n_pkts(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+glossy_get_n_pkts_crcok(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+glossy_get_n_errors(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+glossy_get_flood_duration(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+glossy_get_t_to_first_rx(void)
+{
+  return 0;
+}
+#endif /* GLOSSY_CONF_COLLECT_STATS */
+/*---------------------------------------------------------------------------*/
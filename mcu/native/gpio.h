@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @addtogroup  Platform
+ * @{
+ *
+ * @defgroup    gpio GPIO
+ * @{
+ *
+ * @file
+ *
+ * @brief GPIO definitions for the native platform
+ *
+ * There are no GPIOs on the native platform, all pin operations are no-ops.
+ */
+
+#ifndef __GPIO_H__
+#define __GPIO_H__
+
+#define PIN0    0
+#define PIN1    1
+#define PIN2    2
+#define PIN3    3
+#define PIN4    4
+#define PIN5    5
+#define PIN6    6
+#define PIN7    7
+
+#define PORT1   1
+#define PORT2   2
+#define PORT3   3
+#define PORT4   4
+#define PORT5   5
+
+#define PIN_TO_BIT(pin)                 (1 << pin)
+
+#define LED_ON(portandpin)
+#define LED_OFF(portandpin)
+#define LED_TOGGLE(portandpin)
+
+#define PIN_XOR(p)
+#define PIN_SET(p)
+#define PIN_CLR(p)
+#define PIN_SEL(p)
+#define PIN_UNSEL(p)
+#define PIN_CFG_OUT(p)
+#define PIN_CFG_IN(p)
+#define PIN_MAP_AS_OUTPUT(p, map)
+#define PIN_MAP_AS_INPUT(p, map)
+#define PIN_CLR_IFG(p)
+#define PIN_PULLUP_EN(p)
+#define PIN_PULLDOWN_EN(p)
+#define PIN_IES_RISING(p)
+#define PIN_IES_FALLING(p)
+#define PIN_IES_TOGGLE(p)
+#define PIN_INT_EN(p)
+#define PIN_INT_OFF(p)
+#define PIN_CFG_INT(p)
+#define PIN_CFG_INT_INV(p)
+#define PIN_IFG(portandpin)             0
+#define PIN_GET(portandpin)             0
+
+#define GPIO_RESET()
+
+#endif /* __GPIO_H__ */
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief rtimer implementation for the native platform
+ * 
+ * Both the HF and the LF timer are derived from the virtual time 
+ * (clock_vtime, in HF ticks). The expired timers are executed from within
+ * clock_advance() in the same way as the timer ISRs on the CC430.
+ */
+
+#include "contiki.h"
+#include "platform.h"
+
+/*---------------------------------------------------------------------------*/
+static rtimer_t rt[NUM_OF_RTIMERS];     /* rtimer structs */
+static rtimer_clock_t hf_ofs;           /* virtual time of the last reset */
+static rtimer_clock_t lf_ofs;
+static uint8_t interrupts_enabled;
+/*---------------------------------------------------------------------------*/
+/* convert the virtual time (HF ticks) to LF ticks */
+#define VTIME_TO_LF(t)      ((t) * RTIMER_SECOND_LF / RTIMER_SECOND_HF)
+/*---------------------------------------------------------------------------*/
+static inline void
+update_rtimer_state(uint16_t timer)
+{
+  /* update the state only if the rtimer has not been manually */
+  /* stopped or re-scheduled by the callback function */
+  if(rt[timer].state == RTIMER_JUST_EXPIRED) {
+    if(rt[timer].period > 0) {
+      /* if it is periodic, schedule the new expiration */
+      rt[timer].time += rt[timer].period;
+      rt[timer].state = RTIMER_SCHEDULED;
+    } else {
+      rt[timer].state = RTIMER_INACTIVE;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* returns the expiration time of a scheduled rtimer in virtual time */
+static rtimer_clock_t
+rtimer_vtime(uint16_t timer)
+{
+  if(timer >= RTIMER_LF_0) {
+    /* first virtual time at which the LF timer reaches the expiration time */
+    rtimer_clock_t lf = rt[timer].time + lf_ofs;
+    return (lf * RTIMER_SECOND_HF + RTIMER_SECOND_LF - 1) / RTIMER_SECOND_LF;
+  }
+  return rt[timer].time + hf_ofs;
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_init(void)
+{
+  hf_ofs = clock_vtime;
+  lf_ofs = VTIME_TO_LF(clock_vtime);
+  interrupts_enabled = 1;
+  memset(rt, 0, sizeof(rt));
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_schedule(rtimer_id_t timer,
+                rtimer_clock_t start,
+                rtimer_clock_t period,
+                rtimer_callback_t func)
+{
+  if((timer < NUM_OF_RTIMERS) && (rt[timer].state != RTIMER_SCHEDULED)) {
+    rt[timer].func = func;
+    rt[timer].period = period;
+    rt[timer].time = start + period;
+    rt[timer].state = RTIMER_SCHEDULED;
+  } else {
+    DEBUG_PRINT_ERROR("invalid rtimer ID %u", timer);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void 
+rtimer_wait_for_event(rtimer_id_t timer, rtimer_callback_t func)
+{
+  /* there are no capture inputs on the native platform, the timer will 
+   * never fire */
+  if((timer < NUM_OF_RTIMERS) && (rt[timer].state != RTIMER_SCHEDULED)) {
+    rt[timer].func = func;
+    rt[timer].state = RTIMER_WFE;
+  } 
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_stop(rtimer_id_t timer)
+{
+  if(timer < NUM_OF_RTIMERS) {
+    rt[timer].state = RTIMER_INACTIVE;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_reset(void)
+{
+  hf_ofs = clock_vtime;
+  lf_ofs = VTIME_TO_LF(clock_vtime);
+}
+/*---------------------------------------------------------------------------*/
+inline void
+rtimer_update_enable(uint8_t enable)
+{
+  /* the etimer update is always enabled */
+}
+/*---------------------------------------------------------------------------*/
+inline uint8_t 
+rtimer_update_enabled(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_interrupts_enable(uint8_t enable)
+{
+  interrupts_enabled = enable;
+}
+/*---------------------------------------------------------------------------*/
+rtimer_clock_t
+rtimer_now_hf(void)
+{
+  return clock_vtime - hf_ofs;
+}
+/*---------------------------------------------------------------------------*/
+rtimer_clock_t
+rtimer_now_lf(void)
+{
+  return VTIME_TO_LF(clock_vtime) - lf_ofs;
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_now(rtimer_clock_t* const hf_val, rtimer_clock_t* const lf_val)
+{
+  if(hf_val && lf_val) {
+    *hf_val = rtimer_now_hf();
+    *lf_val = rtimer_now_lf();
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+rtimer_swext_addr(rtimer_id_t timer)
+{
+  /* there are no software extensions on the native platform */
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+rtimer_next_expiration(rtimer_id_t timer, rtimer_clock_t* exp_time)
+{
+   if(timer < NUM_OF_RTIMERS) {
+     *exp_time = rt[timer].time;
+     return (rt[timer].state == RTIMER_SCHEDULED);
+   }
+   return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+clock_next_event(rtimer_clock_t* vtime)
+{
+  uint16_t timer;
+  uint8_t found = 0;
+
+  if(interrupts_enabled) {
+    for(timer = 0; timer < NUM_OF_RTIMERS; timer++) {
+      if(rt[timer].state == RTIMER_SCHEDULED && 
+         (!found || rtimer_vtime(timer) < *vtime)) {
+        *vtime = rtimer_vtime(timer);
+        found = 1;
+      }
+    }
+  }
+  if(etimer_pending() && 
+     (!found || ((rtimer_clock_t)etimer_next_expiration_time() << 16) < 
+                *vtime)) {
+    *vtime = (rtimer_clock_t)etimer_next_expiration_time() << 16;
+    found = 1;
+  }
+  return found;
+}
+/*---------------------------------------------------------------------------*/
+void
+clock_run_expired(void)
+{
+  uint16_t timer;
+  
+  /* check whether there are etimers ready to be served */
+  if(etimer_pending() && 
+     ((rtimer_clock_t)etimer_next_expiration_time() << 16) <= clock_vtime) {
+    etimer_request_poll();
+  }
+  /* execute the callbacks of the expired rtimers (in the order of their
+   * interrupt priority) */
+  for(timer = 0; timer < NUM_OF_RTIMERS && interrupts_enabled; timer++) {
+    if((rt[timer].state == RTIMER_SCHEDULED) && 
+       (rtimer_vtime(timer) <= clock_vtime)) {
+      /* the timer has expired! */
+      rt[timer].state = RTIMER_JUST_EXPIRED;
+      /* execute the proper callback function */
+      rt[timer].func(&rt[timer]);
+      /* update or stop the timer */
+      update_rtimer_state(timer);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
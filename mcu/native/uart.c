@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief UART of the native platform
+ *
+ * All output (printf) goes to the standard output of the process, there is
+ * no input.
+ */
+
+#include "contiki.h"
+#include "platform.h"
+
+/*---------------------------------------------------------------------------*/
+static int (*uart0_input_handler)(unsigned char c);
+/*---------------------------------------------------------------------------*/
+void
+uart_set_input_handler(int (*input)(unsigned char c))
+{
+  uart0_input_handler = input;
+}
+/*---------------------------------------------------------------------------*/
+void
+uart_init(void)
+{
+  /* line buffered output (the program may be terminated at any time) */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+}
+/*---------------------------------------------------------------------------*/
+void
+uart_reinit(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+void
+uart_enable(uint8_t enable)
+{
+  if(enable) {
+    /* do whatever the application requires to do before UART is enabled */
+    UART_BEFORE_ENABLE;         
+  } else {
+    fflush(stdout);
+    /* do whatever the application requires to do after UART was disabled */
+    UART_AFTER_DISABLE;
+  }    
+}
+/*---------------------------------------------------------------------------*/
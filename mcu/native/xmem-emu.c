@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief emulated external memory of the native platform
+ *
+ * The memory is allocated linearly (no free), as the FRAM driver does.
+ */
+
+#include "contiki.h"
+#include "platform.h"
+
+#if !FRAM_CONF_ON
+
+/*---------------------------------------------------------------------------*/
+static uint8_t          xmem_emu_mem[XMEM_EMU_CONF_SIZE];
+static uint32_t         xmem_emu_alloc_offset = 0;
+static xmem_emu_stats_t xmem_emu_stats;
+/*---------------------------------------------------------------------------*/
+const xmem_emu_stats_t*
+xmem_emu_get_stats(void)
+{
+  return &xmem_emu_stats;
+}
+/*---------------------------------------------------------------------------*/
+void
+xmem_emu_reset_stats(void)
+{
+  memset(&xmem_emu_stats, 0, sizeof(xmem_emu_stats));
+}
+/*---------------------------------------------------------------------------*/
+void
+xmem_emu_free_all(void)
+{
+  xmem_emu_alloc_offset = 0;
+}
+/*---------------------------------------------------------------------------*/
+inline uint8_t 
+xmem_init(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+inline uint8_t 
+xmem_sleep(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+inline uint8_t 
+xmem_wakeup(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+inline uint32_t 
+xmem_alloc(uint32_t size)
+{
+  if(size > XMEM_EMU_CONF_SIZE - xmem_emu_alloc_offset) {
+    return XMEM_ALLOC_ERROR;
+  }
+  uint32_t addr = xmem_emu_alloc_offset;
+  xmem_emu_alloc_offset += size;
+  return addr;
+}
+/*---------------------------------------------------------------------------*/
+inline uint8_t 
+xmem_read(uint32_t start_address, uint16_t num_bytes, uint8_t *out_data) 
+{ 
+  if(start_address >= XMEM_EMU_CONF_SIZE || 
+     num_bytes > XMEM_EMU_CONF_SIZE - start_address) {
+    return 0;
+  }
+  memcpy(out_data, xmem_emu_mem + start_address, num_bytes);
+  xmem_emu_stats.n_read++;
+  xmem_emu_stats.n_bytes += num_bytes;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+inline uint8_t 
+xmem_write(uint32_t start_address, uint16_t num_bytes, const uint8_t *data) 
+{
+  if(start_address >= XMEM_EMU_CONF_SIZE || 
+     num_bytes > XMEM_EMU_CONF_SIZE - start_address) {
+    return 0;
+  }
+  memcpy(xmem_emu_mem + start_address, data, num_bytes);
+  xmem_emu_stats.n_write++;
+  xmem_emu_stats.n_bytes += num_bytes;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+inline uint8_t 
+xmem_erase(uint32_t start_address, uint16_t num_bytes) 
+{
+  if(start_address >= XMEM_EMU_CONF_SIZE || 
+     num_bytes > XMEM_EMU_CONF_SIZE - start_address) {
+    return 0;
+  }
+  memset(xmem_emu_mem + start_address, 0, num_bytes);
+  xmem_emu_stats.n_write++;
+  xmem_emu_stats.n_bytes += num_bytes;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+
+#endif /* FRAM_CONF_ON */
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @addtogroup  Platform
+ * @{
+ *
+ * @defgroup    xmem-emu Emulated external memory
+ * @{
+ *
+ * @file
+ *
+ * @brief external memory of the native platform
+ * 
+ * The external memory (xmem interface, see core/dev/xmem.h) is emulated in 
+ * RAM. All accesses are counted to estimate the traffic on the SPI bus of 
+ * a real external memory (FRAM).
+ */
+
+#ifndef __XMEM_EMU_H__
+#define __XMEM_EMU_H__
+
+#ifndef XMEM_EMU_CONF_SIZE
+#define XMEM_EMU_CONF_SIZE          0x40000   /* same as the FRAM (2 Mbit) */
+#endif /* XMEM_EMU_CONF_SIZE */
+
+/**
+ * @brief access statistics of the emulated external memory
+ */
+typedef struct {
+  uint32_t n_read;          /* number of xmem_read() calls */
+  uint32_t n_write;         /* number of xmem_write() calls */
+  uint32_t n_bytes;         /* total number of bytes read and written */
+} xmem_emu_stats_t;
+
+/**
+ * @brief returns the access statistics of the emulated external memory
+ */
+const xmem_emu_stats_t* xmem_emu_get_stats(void);
+
+/**
+ * @brief resets the access statistics
+ */
+void xmem_emu_reset_stats(void);
+
+/**
+ * @brief releases all memory blocks allocated with xmem_alloc(), e.g. before
+ * a module is initialized again
+ */
+void xmem_emu_free_all(void);
+
+#endif /* __XMEM_EMU_H__ */
+
+/**
+ * @}
+ * @}
+ */
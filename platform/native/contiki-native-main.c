@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief main function of the native platform
+ *
+ * usage: ./<app>.exe [-n node_id] [-t duration_s] [-s seed]
+ *
+ * The program runs until the virtual time reaches the specified duration
+ * (default: 3600 seconds).
+ */
+
+#include <getopt.h>
+#include "contiki.h"
+#include "platform.h"
+
+/*---------------------------------------------------------------------------*/
+#ifndef NATIVE_CONF_DURATION
+#define NATIVE_CONF_DURATION    3600            /* default duration in sec. */
+#endif /* NATIVE_CONF_DURATION */
+/*---------------------------------------------------------------------------*/
+#ifndef NODE_ID
+volatile uint16_t node_id = 1;
+#endif /* NODE_ID */
+/*---------------------------------------------------------------------------*/
+void
+print_processes(struct process *const processes[])
+{
+  uart_enable(1);
+  printf("Starting");
+  while(*processes != NULL) {
+    printf(" '%s'", (*processes)->name);
+    processes++;
+  }
+  printf("\r\n");
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  uint32_t duration = NATIVE_CONF_DURATION;
+  uint32_t seed = 0;
+  int opt;
+  
+  while((opt = getopt(argc, argv, "n:t:s:")) != -1) {
+    if(opt == 'n') {
+#ifndef NODE_ID
+      node_id = (uint16_t)strtoul(optarg, 0, 10);
+#endif /* NODE_ID */
+    } else if(opt == 't') {
+      duration = strtoul(optarg, 0, 10);
+    } else if(opt == 's') {
+      seed = strtoul(optarg, 0, 10);
+    } else {
+      fprintf(stderr, "usage: %s [-n node_id] [-t duration_s] [-s seed]\n",
+              argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  
+  clock_init();
+  rtimer_init();
+  uart_init();
+  uart_enable(1);
+  uart_set_input_handler(serial_line_input_byte);
+  printf("\r\n\r\nMCU: " MCU_TYPE "\r\n");
+  printf("Compiler: " COMPILER_INFO "\r\nDate: " COMPILE_DATE "\r\n");
+
+  if(node_id > 0) {
+    printf(CONTIKI_VERSION_STRING " started. Node ID is set to %u.\r\n",
+           node_id);
+  } else {
+    printf(CONTIKI_VERSION_STRING " started. Node ID is not set.\r\n");
+  }
+
+  process_init();
+  process_start(&etimer_process, NULL);
+
+  random_init(seed ? seed : node_id);
+  serial_line_init();
+  /* note: do not start the debug process here */
+
+  energest_init();
+  ENERGEST_ON(ENERGEST_TYPE_CPU);
+
+  /* start processes */
+  print_processes(autostart_processes);
+  autostart_start(autostart_processes);
+  debug_print_init();  
+  /* note: start debug process as last due to process_poll() execution order */
+  
+  while(1) {
+    int r;
+    do {
+      r = process_run();
+    } while(r > 0);
+    /* idle processing: fast-forward the virtual clock to the next event */
+    if(!clock_advance((rtimer_clock_t)duration * RTIMER_SECOND_HF)) {
+      break;
+    }
+  }
+  uart_enable(0);
+
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
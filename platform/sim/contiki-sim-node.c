@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief entry points of a simulated node
+ *
+ * Replaces the main function of the native platform: the simulator 
+ * initializes the node and executes its timer events (see sim-node.h).
+ * All global and static variables of the node code are private to the node
+ * since the simulator loads a separate instance of the node library for each
+ * node.
+ */
+
+#include "contiki.h"
+#include "platform.h"
+#include "sim-node.h"
+
+/*---------------------------------------------------------------------------*/
+#ifndef NODE_ID
+volatile uint16_t node_id;
+#else
+#error "NODE_ID must not be defined for the simulation"
+#endif /* NODE_ID */
+static uint32_t rand_state;
+/*---------------------------------------------------------------------------*/
+/* the random number generator of the libc is shared by all nodes, therefore
+ * each node uses its own generator (the node library is linked with 
+ * -Bsymbolic, i.e. random.c uses these functions) */
+void
+srand(unsigned int seed)
+{
+  rand_state = seed;
+}
+/*---------------------------------------------------------------------------*/
+int
+rand(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return (int)((rand_state >> 16) & 0x7fff);
+}
+/*---------------------------------------------------------------------------*/
+void
+sim_node_init(uint16_t id, uint32_t seed, uint64_t vtime)
+{
+  node_id = id;
+  clock_vtime = vtime;
+  rtimer_init();
+
+  process_init();
+  process_start(&etimer_process, NULL);
+
+  random_init(seed);
+  serial_line_init();
+  /* note: do not start the debug process here */
+
+  energest_init();
+  ENERGEST_ON(ENERGEST_TYPE_CPU);
+
+  /* start processes */
+  autostart_start(autostart_processes);
+  debug_print_init();  
+  /* note: start debug process as last due to process_poll() execution order */
+  
+  sim_node_run(vtime);
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+sim_node_next_event(uint64_t* vtime)
+{
+  rtimer_clock_t next;
+  if(clock_next_event(&next)) {
+    *vtime = next;
+    return 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+sim_node_run(uint64_t vtime)
+{
+  int r;
+  
+  if(vtime > clock_vtime) {
+    clock_vtime = vtime;
+  }
+  clock_run_expired();
+  do {
+    r = process_run();
+  } while(r > 0);
+}
+/*---------------------------------------------------------------------------*/
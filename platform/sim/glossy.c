@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief Glossy for the simulated platform
+ *
+ * Forwards the floods to the network simulator, which emulates the 
+ * propagation of the packets through the network (flood model, see 
+ * tools/sim/flood.c). The result of a flood is available after glossy_stop().
+ */
+
+#include "contiki.h"
+#include "platform.h"
+#include "sim-node.h"
+
+/*---------------------------------------------------------------------------*/
+typedef struct {
+  sim_flood_result_t res;
+  rtimer_clock_t t_ref;
+  rtimer_clock_t t_start;
+  rtimer_clock_t flood_duration;
+  uint8_t *payload;
+  uint8_t active;
+  uint32_t pkt_cnt;
+  uint32_t pkt_cnt_crcok;
+  uint32_t flood_cnt;
+  uint32_t flood_cnt_success;
+} glossy_state_t;
+/*---------------------------------------------------------------------------*/
+static glossy_state_t g;
+/*---------------------------- Glossy interface -----------------------------*/
+void
+glossy_start(uint16_t initiator_id, uint8_t *payload, uint8_t payload_len,
+             uint8_t n_tx_max, glossy_sync_t sync, glossy_rf_cal_t rf_cal)
+{
+  DEBUG_PRINT_VERBOSE("Glossy started: in=%u, pl=%u, n=%u, s=%u", initiator_id,
+                      payload_len, n_tx_max, sync);
+  memset(&g.res, 0, sizeof(sim_flood_result_t));
+  g.active = 1;
+  g.payload = payload;
+  g.res.payload_len = payload_len;
+  g.t_start = rtimer_now_hf();
+  sim_glossy_start(node_id, clock_vtime, initiator_id, payload, payload_len,
+                   n_tx_max, (sync == GLOSSY_WITH_SYNC));
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_stop(void)
+{
+  if(g.active) {
+    g.active = 0;
+    sim_glossy_stop(node_id, clock_vtime, g.payload, &g.res);
+    if(g.res.t_ref_updated) {
+      g.t_ref = rtimer_now_hf() - g.res.t_ref_age;
+    }
+    g.flood_duration = rtimer_now_hf() - g.t_start;
+    /* stats */
+    g.pkt_cnt += g.res.n_rx_started;
+    g.pkt_cnt_crcok += g.res.n_rx;
+    if(g.res.initiator_id != node_id) {
+      if(g.res.n_rx_started) {
+        g.flood_cnt++;
+      }
+      if(g.res.n_rx) {
+        g.flood_cnt_success++;
+      }
+    }
+    if(g.res.n_rx > 0) {
+      DEBUG_PRINT_VERBOSE("Glossy stopped: in=%u, pl=%u, n=%u, rc=%u", 
+                          g.res.initiator_id, g.res.payload_len, g.res.n_rx,
+                          g.res.relay_cnt_first_rx);
+    } else {
+      DEBUG_PRINT_VERBOSE("Glossy stopped (n_rx=0)");
+    }
+  }
+  return g.res.n_rx;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_is_active(void)
+{
+  return g.active;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_get_n_rx(void)
+{
+  return g.res.n_rx;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_get_n_tx(void)
+{
+  return g.res.n_tx;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_get_payload_len(void)
+{
+  return g.res.payload_len;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_is_t_ref_updated(void)
+{
+  return g.res.t_ref_updated;
+}
+/*---------------------------------------------------------------------------*/
+rtimer_clock_t
+glossy_get_t_ref(void)
+{
+  return g.t_ref;
+}
+/*---------------------------------------------------------------------------*/
+#if GLOSSY_CONF_COLLECT_STATS
+uint8_t
+glossy_get_n_rx_started(void)
+{
+  return g.res.n_rx_started;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_get_n_crc_ok(void)
+{
+  return g.res.n_rx;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_get_n_rx_fail(void)
+{
+  return g.res.n_rx_started - g.res.n_rx;
+}
+/*---------------------------------------------------------------------------*/
+int8_t
+glossy_get_snr(void)
+{
+  if(g.res.n_rx == 0) {
+    return 0;
+  }
+  return g.res.snr;
+}
+/*---------------------------------------------------------------------------*/
+int8_t
+glossy_get_rssi(int8_t* rssi)
+{
+  if(g.res.n_rx == 0) {
+    return 0;
+  }
+  if(rssi) {
+    rssi[0] = rssi[1] = rssi[2] = g.res.rssi;
+  }
+  return g.res.rssi;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+glossy_get_relay_cnt_first_rx(void)
+{
+  return g.res.relay_cnt_first_rx;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t 
+glossy_get_relay_cnt(void)
+{
+  return g.res.relay_cnt_first_rx & 0x0f;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+glossy_get_per(void)
+{
+  if(g.pkt_cnt) {
+    return 10000 - (uint16_t)((uint64_t)g.pkt_cnt_crcok * 10000 /
+                              (uint64_t)g.pkt_cnt);
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+glossy_get_fsr(void)
+{
+  if(g.flood_cnt) {
+    return (uint16_t)((uint64_t)g.flood_cnt_success * 10000 /
+                      (uint64_t)g.flood_cnt);
+  }
+  return 10000;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+glossy_get_n_pkts(void)
+{
+  return g.pkt_cnt;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+glossy_get_n_pkts_crcok(void)
+{
+  return g.pkt_cnt_crcok;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+glossy_get_n_errors(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+glossy_get_flood_duration(void)
+{
+  return (uint32_t)g.flood_duration;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+glossy_get_t_to_first_rx(void)
+{
+  return 0;
+}
+#endif /* GLOSSY_CONF_COLLECT_STATS */
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ *
+ * @brief platform includes and definitions for the simulated platform
+ * 
+ * The code of each simulated node is compiled into a shared library which
+ * the network simulator (tools/sim) loads once per node. The nodes run on
+ * the virtual clock of the native platform (see mcu/native/clock.h), the
+ * simulator advances the virtual time and emulates the Glossy floods.
+ * 
+ * @note generally, if one of the platform files is needed platform.h
+ * should be included instead of the specific file to preserve the 
+ * include order and prevent compiler warnings
+ */
+
+#ifndef __PLATFORM_H__
+#define __PLATFORM_H__
+
+/*
+ * include standard libraries
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define MCU_TYPE                    "native (sim)"
+#define COMPILER_INFO               "GCC " __VERSION__
+#define COMPILE_DATE                __DATE__
+
+/*
+ * include application specific config
+ */
+#include "config.h"                 /* application specific configuration */
+
+/*
+ * default configuration (values may be overwritten in config.h)
+ */
+#ifndef WATCHDOG_CONF_ON
+#define WATCHDOG_CONF_ON            0
+#endif /* WATCHDOG_CONF_ON */
+
+#ifndef LED_CONF_ON 
+#define LED_CONF_ON                 0
+#endif /* LED_CONF_ON */
+
+/* no radio, Glossy floods are emulated by the simulator */
+#undef RF_CONF_ON
+#define RF_CONF_ON                  0
+
+/* specify the number of timer modules (same as on the CC430) */
+#define RTIMER_CONF_NUM_HF          4  /* number of high-frequency timers */
+#define RTIMER_CONF_NUM_LF          3  /* number of low-frequency timers */     
+
+
+/*
+ * ERROR checks (verify parameters)
+ */
+#if LWB_CONF_USE_XMEM
+#error "LWB_CONF_USE_XMEM is not available on the simulated platform"
+#endif
+
+
+/*
+ * pin mapping (pins have no effect on the native platform)
+ */
+#define LED_RED                     PORT1, PIN0
+#define LED_0                       LED_RED 
+#define LED_STATUS                  LED_RED
+#define LED_ERROR                   LED_RED
+
+#define FLOCKLAB_LED1               PORT1, PIN0
+#define FLOCKLAB_LED2               PORT1, PIN1
+#define FLOCKLAB_LED3               PORT1, PIN2
+#define FLOCKLAB_SIG1               PORT1, PIN3
+#define FLOCKLAB_SIG2               PORT1, PIN4
+#define FLOCKLAB_INT1               PORT3, PIN6
+#define FLOCKLAB_INT2               PORT3, PIN7
+
+#define GLOSSY_DISABLE_INTERRUPTS
+#define GLOSSY_ENABLE_INTERRUPTS
+
+#define UART_ACTIVE                 0
+
+
+/*
+ * include MCU specific files
+ */
+#include "clock.h"
+#include "gpio.h"
+#include "pmm.h"
+#include "rtimer.h"
+#include "uart.h"
+#include "watchdog.h"
+#include "xmem-emu.h"
+
+#endif /* __PLATFORM_H__ */
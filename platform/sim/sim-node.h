@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ *
+ * @brief interface between the network simulator (tools/sim) and the 
+ * simulated nodes
+ *
+ * The simulator loads one instance of the node library per node and calls
+ * the node functions below (resolved by name). All times are given in 
+ * virtual time, i.e. HF clock ticks (SIM_HF_CLKSPEED) since the start of the
+ * simulation.
+ * The nodes call the simulator functions (sim_glossy_*) to take part in a
+ * Glossy flood. These functions are implemented in the simulator executable.
+ */
+
+#ifndef __SIM_NODE_H__
+#define __SIM_NODE_H__
+
+#include <stdint.h>
+
+/* the virtual time runs at the speed of the HF clock (SMCLK_SPEED) */
+#define SIM_HF_CLKSPEED         3250000LLU
+
+/* max. length of a Glossy payload */
+#define SIM_MAX_PAYLOAD_LEN     128
+
+/**
+ * @brief result of a Glossy flood, as seen by one node
+ */
+typedef struct {
+  uint64_t t_ref_age;         /* virtual time since the first transmission of
+                                 the initiator (only valid if t_ref_updated) */
+  uint16_t initiator_id;
+  uint8_t  payload_len;
+  uint8_t  n_rx;              /* number of successfully received packets */
+  uint8_t  n_rx_started;      /* number of detected packets (incl. failed) */
+  uint8_t  n_tx;              /* number of transmissions */
+  uint8_t  relay_cnt_first_rx;
+  uint8_t  t_ref_updated;
+  int8_t   rssi;              /* avg. RSSI of the received packets in dBm */
+  int8_t   snr;
+} sim_flood_result_t;
+
+/* 
+ * functions implemented by the node (node library)
+ */
+
+/**
+ * @brief initialize a node (corresponds to the power-up)
+ * @param[in] id node ID
+ * @param[in] seed seed for the random number generator of the node
+ * @param[in] vtime current virtual time
+ */
+void sim_node_init(uint16_t id, uint32_t seed, uint64_t vtime);
+
+/**
+ * @brief get the virtual time of the next timer event of a node
+ * @return 1 if there is a pending event, 0 otherwise
+ */
+uint8_t sim_node_next_event(uint64_t* vtime);
+
+/**
+ * @brief execute all events of a node which are due at the given virtual
+ * time and run all processes until the node is idle
+ */
+void sim_node_run(uint64_t vtime);
+
+typedef void (*sim_node_init_t)(uint16_t, uint32_t, uint64_t);
+typedef uint8_t (*sim_node_next_event_t)(uint64_t*);
+typedef void (*sim_node_run_t)(uint64_t);
+
+/* 
+ * functions implemented by the simulator
+ */
+
+/**
+ * @brief start a Glossy flood (initiator) or start listening for a flood 
+ * (receiver)
+ * @param[in] id ID of the calling node
+ * @param[in] vtime current virtual time
+ * @param[in] sync 1 if the packets carry a relay counter to synchronize the
+ * receivers (GLOSSY_WITH_SYNC), 0 otherwise
+ * @note the simulator copies the payload of an initiator
+ */
+void sim_glossy_start(uint16_t id, 
+                      uint64_t vtime,
+                      uint16_t initiator_id,
+                      const uint8_t* payload,
+                      uint8_t payload_len,
+                      uint8_t n_tx_max,
+                      uint8_t sync);
+
+/**
+ * @brief stop the Glossy flood, get the result
+ * @param[in] id ID of the calling node
+ * @param[in] vtime current virtual time
+ * @param[out] payload buffer for the received payload (receivers only)
+ * @param[out] result the result of the flood
+ */
+void sim_glossy_stop(uint16_t id,
+                     uint64_t vtime,
+                     uint8_t* payload,
+                     sim_flood_result_t* result);
+
+#endif /* __SIM_NODE_H__ */
@@ -0,0 +1,396 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ *
+ * @brief Glossy flood model
+ *
+ * A flood is divided into slots of the length of one packet transmission
+ * (incl. the RX/TX turnaround). The initiator transmits in slot 0. A node 
+ * that receives the packet for the first time in slot s relays it in slot
+ * s + 1 and then transmits in every other slot until it has transmitted the 
+ * packet n_tx_max times. Afterwards, it turns off the radio.
+ * In each slot, a listening node receives the packet from each transmitting
+ * neighbor with the packet reception ratio (PRR) of the link. If more than 
+ * one packet arrives, the reception succeeds with probability p_ci if all 
+ * packets are identical (constructive interference) or p_capture if they 
+ * differ (capture effect, the packet over the strongest link is received).
+ *
+ * A flood is resolved as soon as all nodes have executed their events for
+ * the virtual time at which the initiator(s) started the flood. Nodes which 
+ * are listening at that time take part in the flood. The result is handed 
+ * to a node in sim_glossy_stop(), provided that the first reception ended 
+ * before the node stopped Glossy.
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include "sim.h"
+
+/* header length of a Glossy packet */
+#define FLOOD_HEADER_LEN(sync)  ((sync) ? 4 : 3)
+/* physical layer overhead (preamble, sync word, length byte and CRC) */
+#define FLOOD_PHY_OVERHEAD      11
+/* max. number of concurrent initiators */
+#define FLOOD_MAX_INITIATORS    8
+/* max. number of slots */
+#define FLOOD_MAX_SLOTS         255
+/* a flood is the start of a new round if it is started at least this long
+ * after the start of the previous round (only floods with sync) */
+#define FLOOD_MIN_ROUND_PERIOD  SIM_HF_CLKSPEED
+
+/*---------------------------------------------------------------------------*/
+typedef struct {
+  uint16_t node;                /* index of the node */
+  uint8_t  payload_len;
+  uint8_t  n_tx_max;
+  uint8_t  sync;
+  uint8_t  payload[SIM_MAX_PAYLOAD_LEN];
+} flood_initiator_t;
+
+/* per node state during the resolution of a flood */
+typedef struct {
+  int16_t  pkt;                 /* index of the received packet (initiator) 
+                                   or -1 */
+  int16_t  next_tx;             /* next slot in which the node transmits */
+  uint8_t  n_tx;
+  uint8_t  n_tx_max;
+  uint8_t  n_rx;
+  uint8_t  n_rx_started;
+  uint8_t  first_rx;            /* slot of the first reception */
+  float    prr_first_rx;        /* PRR of the link of the first reception */
+  /* arrivals in the current slot */
+  uint8_t  n_arrivals;
+  uint8_t  mixed;               /* different packets arrived */
+  int16_t  best_pkt;
+  float    best_prr;
+} flood_node_t;
+
+static struct {
+  uint8_t  pending;
+  uint8_t  n_initiators;
+  uint64_t t_start;
+  flood_initiator_t init[FLOOD_MAX_INITIATORS];
+} flood;
+
+static pthread_mutex_t flood_lock = PTHREAD_MUTEX_INITIALIZER;
+static flood_node_t* state;
+static uint16_t*     participants;
+static uint16_t*     touched;
+/*---------------------------------------------------------------------------*/
+uint8_t
+flood_init(void)
+{
+  state = calloc(sim_num_nodes, sizeof(flood_node_t));
+  participants = calloc(sim_num_nodes, sizeof(uint16_t));
+  touched = calloc(sim_num_nodes, sizeof(uint16_t));
+  return (state && participants && touched);
+}
+/*---------------------------------------------------------------------------*/
+static uint64_t
+flood_slot_len(uint8_t payload_len, uint8_t sync)
+{
+  uint32_t n_bytes = FLOOD_PHY_OVERHEAD + FLOOD_HEADER_LEN(sync) +
+                     payload_len;
+  return (uint64_t)n_bytes * 8 * SIM_HF_CLKSPEED / sim_params.bitrate +
+         sim_params.t_rxtx;
+}
+/*---------------------------------------------------------------------------*/
+static void
+flood_update_round_stats(uint64_t t_start, uint64_t t_end)
+{
+  if(!sim_stats.rounds ||
+     (t_start - sim_stats.t_round_start) >= FLOOD_MIN_ROUND_PERIOD) {
+    /* new round */
+    if(sim_stats.rounds) {
+      uint64_t len = sim_stats.t_round_end - sim_stats.t_round_start;
+      sim_stats.round_len_sum += len;
+      if(len > sim_stats.round_len_max) {
+        sim_stats.round_len_max = len;
+      }
+    }
+    sim_stats.rounds++;
+    sim_stats.t_round_start = t_start;
+  }
+  sim_stats.t_round_end = t_end;
+}
+/*---------------------------------------------------------------------------*/
+void
+flood_resolve(void)
+{
+  uint16_t i, j, n_part = 0, n_touched, n_active;
+  uint8_t s, sync = 0;
+  uint64_t t_first_tx, t_slot;
+
+  if(!flood.pending) {
+    return;
+  }
+  flood.pending = 0;
+
+  /* the initiators may have been registered in any order (threads) */
+  for(i = 1; i < flood.n_initiators; i++) {
+    for(j = i; j > 0 && flood.init[j - 1].node > flood.init[j].node; j--) {
+      flood_initiator_t tmp = flood.init[j];
+      flood.init[j] = flood.init[j - 1];
+      flood.init[j - 1] = tmp;
+    }
+  }
+
+  /* the slot length is determined by the longest packet */
+  t_slot = 0;
+  for(i = 0; i < flood.n_initiators; i++) {
+    uint64_t len = flood_slot_len(flood.init[i].payload_len, 
+                                  flood.init[i].sync);
+    if(len > t_slot) {
+      t_slot = len;
+    }
+    sync |= flood.init[i].sync;
+  }
+  t_first_tx = flood.t_start + sim_params.t_tx_offset;
+
+  /* all nodes with an active Glossy take part in the flood */
+  for(i = 0; i < sim_num_nodes; i++) {
+    if(sim_nodes[i].glossy_active) {
+      flood_node_t* f = &state[i];
+      memset(f, 0, sizeof(flood_node_t));
+      f->pkt = -1;
+      f->next_tx = -1;
+      participants[n_part++] = i;
+    }
+  }
+  for(i = 0; i < flood.n_initiators; i++) {
+    flood_node_t* f = &state[flood.init[i].node];
+    f->pkt = i;
+    f->next_tx = 0;
+    f->n_tx_max = flood.init[i].n_tx_max;
+  }
+
+  /* slot by slot */
+  n_active = flood.n_initiators;
+  for(s = 0; s < FLOOD_MAX_SLOTS && n_active; s++) {
+    n_touched = 0;
+    for(i = 0; i < n_part; i++) {
+      uint16_t n = participants[i];
+      flood_node_t* f = &state[n];
+      sim_node_t* node = &sim_nodes[n];
+      if(f->next_tx != s) {
+        continue;
+      }
+      /* transmit */
+      for(j = 0; j < node->n_links; j++) {
+        uint16_t d = node->links[j].dst;
+        flood_node_t* r = &state[d];
+        float prr = node->links[j].prr;
+        if(!sim_nodes[d].glossy_active || r->next_tx == s ||
+           (r->pkt >= 0 && r->n_tx >= r->n_tx_max) ||
+           sim_rand() >= prr) {
+          /* not listening or packet lost */
+          continue;
+        }
+        if(!r->n_arrivals) {
+          touched[n_touched++] = d;
+          r->best_pkt = f->pkt;
+          r->best_prr = prr;
+        } else {
+          if(r->best_pkt != f->pkt) {
+            r->mixed = 1;
+          }
+          if(prr > r->best_prr) {
+            r->best_prr = prr;
+            r->best_pkt = f->pkt;
+          }
+        }
+        r->n_arrivals++;
+      }
+      f->n_tx++;
+      if(f->n_tx >= f->n_tx_max) {
+        f->next_tx = -1;
+        node->t_done = t_first_tx + (s + 1) * t_slot;
+        n_active--;
+      } else {
+        f->next_tx = s + 2;
+      }
+    }
+    /* receptions */
+    for(i = 0; i < n_touched; i++) {
+      uint16_t n = touched[i];
+      flood_node_t* r = &state[n];
+      double p_success = 1.0;
+      if(r->n_arrivals > 1) {
+        p_success = r->mixed ? sim_params.p_capture : sim_params.p_ci;
+      }
+      r->n_rx_started++;
+      if(sim_rand() < p_success && (r->pkt < 0 || r->pkt == r->best_pkt)) {
+        r->n_rx++;
+        if(r->pkt < 0) {
+          /* first reception */
+          r->pkt = r->best_pkt;
+          r->first_rx = s;
+          r->prr_first_rx = r->best_prr;
+          r->next_tx = s + 1;
+          r->n_tx_max = flood.init[r->pkt].n_tx_max;
+          sim_nodes[n].t_first_rx_end = t_first_tx + (s + 1) * t_slot;
+          n_active++;
+        }
+      }
+      r->n_arrivals = 0;
+      r->mixed = 0;
+    }
+  }
+
+  /* store the results */
+  for(i = 0; i < n_part; i++) {
+    uint16_t n = participants[i];
+    flood_node_t* f = &state[n];
+    sim_node_t* node = &sim_nodes[n];
+    sim_flood_result_t* res = &node->res;
+    memset(res, 0, sizeof(sim_flood_result_t));
+    node->res_valid = 1;
+    res->n_tx = f->n_tx;
+    res->n_rx = f->n_rx;
+    res->n_rx_started = f->n_rx_started;
+    if(f->pkt >= 0) {
+      flood_initiator_t* init = &flood.init[f->pkt];
+      res->initiator_id = sim_nodes[init->node].id;
+      res->payload_len = init->payload_len;
+      if(init->node != n) {
+        res->t_ref_age = t_first_tx;      /* converted in sim_glossy_stop() */
+        res->relay_cnt_first_rx = f->first_rx;
+        res->t_ref_updated = (init->sync != 0);
+        res->rssi = (int8_t)(sim_params.noise_floor + 3 + 
+                             27 * f->prr_first_rx);
+        res->snr = (int8_t)(res->rssi - sim_params.noise_floor);
+        memcpy(node->payload, init->payload, init->payload_len);
+      } else {
+        node->t_first_rx_end = flood.t_start;
+      }
+    }
+    if(f->pkt < 0 || f->n_tx < f->n_tx_max) {
+      /* did not complete the flood, radio stays on until glossy_stop() */
+      node->t_done = SIM_NO_EVENT;
+    }
+  }
+  sim_stats.floods++;
+  if(flood.n_initiators > 1) {
+    sim_stats.floods_concurrent++;
+  }
+  if(sync) {
+    flood_update_round_stats(flood.t_start, t_first_tx + s * t_slot);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+sim_glossy_start(uint16_t id,
+                 uint64_t vtime,
+                 uint16_t initiator_id,
+                 const uint8_t* payload,
+                 uint8_t payload_len,
+                 uint8_t n_tx_max,
+                 uint8_t sync)
+{
+  sim_node_t* node = sim_get_node(id);
+  if(!node) {
+    return;
+  }
+  node->glossy_active = 1;
+  node->res_valid = 0;
+  node->t_glossy_start = vtime;
+  node->t_done = SIM_NO_EVENT;
+
+  if(initiator_id == id) {
+    flood_initiator_t* init;
+    pthread_mutex_lock(&flood_lock);
+    if(flood.pending && flood.t_start != vtime) {
+      /* previous flood has not been resolved yet */
+      flood_resolve();
+    }
+    if(!flood.pending) {
+      flood.pending = 1;
+      flood.n_initiators = 0;
+      flood.t_start = vtime;
+    }
+    if(flood.n_initiators >= FLOOD_MAX_INITIATORS) {
+      pthread_mutex_unlock(&flood_lock);
+      return;
+    }
+    if(payload_len > SIM_MAX_PAYLOAD_LEN) {
+      payload_len = SIM_MAX_PAYLOAD_LEN;
+    }
+    init = &flood.init[flood.n_initiators++];
+    init->node = node - sim_nodes;
+    init->payload_len = payload_len;
+    init->n_tx_max = n_tx_max ? n_tx_max : 1;
+    init->sync = sync;
+    memcpy(init->payload, payload, payload_len);
+    pthread_mutex_unlock(&flood_lock);
+    node->floods_init++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+sim_glossy_stop(uint16_t id,
+                uint64_t vtime,
+                uint8_t* payload,
+                sim_flood_result_t* result)
+{
+  sim_node_t* node = sim_get_node(id);
+  if(!node) {
+    return;
+  }
+  if(flood.pending && flood.t_start < vtime) {
+    pthread_mutex_lock(&flood_lock);
+    if(flood.pending && flood.t_start < vtime) {
+      flood_resolve();
+    }
+    pthread_mutex_unlock(&flood_lock);
+  }
+  node->glossy_active = 0;
+  node->radio_on += ((node->t_done < vtime) ? node->t_done : vtime) -
+                    node->t_glossy_start;
+  if(node->res_valid && node->t_first_rx_end <= vtime) {
+    memcpy(result, &node->res, sizeof(sim_flood_result_t));
+    if(result->initiator_id != id && result->n_rx) {
+      memcpy(payload, node->payload, result->payload_len);
+      result->t_ref_age = vtime - node->res.t_ref_age;
+      node->floods_rcv++;
+      node->hop_sum += result->relay_cnt_first_rx;
+    }
+  } else {
+    memset(result, 0, sizeof(sim_flood_result_t));
+  }
+  if(node->res_valid && !result->n_rx && !result->n_tx) {
+    /* a flood took place, but the node did not receive it (in time) */
+    node->floods_missed++;
+  }
+  node->res_valid = 0;
+}
+/*---------------------------------------------------------------------------*/
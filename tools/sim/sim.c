@@ -0,0 +1,515 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ *
+ * @brief discrete-event network simulator for LWB
+ *
+ * Usage: <project>.exe [options]
+ *   -N <n>      number of nodes of the random topology (default: 50)
+ *   -w <m>      side length of the area of the random topology in meters
+ *   -r <m>      communication range of the random topology in meters
+ *   -f <file>   load the topology from a file (see topology.c)
+ *   -t <s>      simulated time in seconds (default: 60)
+ *   -s <seed>   seed
+ *   -b <ms>     max. boot delay of the nodes in milliseconds
+ *   -c <p>      capture probability for different concurrent packets
+ *   -i <p>      reception probability for identical concurrent packets
+ *   -l <file>   node library (default: <project>-node.so)
+ *   -j <n>      number of threads (default: 1)
+ *   -q          suppress the output of the nodes
+ *
+ * The node library contains the node code compiled for the simulation 
+ * platform. It is loaded once per node from a temporary copy, i.e. each
+ * node has its own copy of all global variables.
+ * The simulator repeatedly executes all nodes with an event at the earliest
+ * pending virtual time and then resolves the Glossy flood started at that 
+ * time (if any). At the end, it prints the per-node and overall statistics.
+ * Since LWB is time-triggered, many nodes have an event at the same time 
+ * (e.g. at the start of a slot). With -j, these nodes are executed in 
+ * parallel by a pool of worker threads, followed by a barrier at which the
+ * flood is resolved. The result does not depend on the number of threads.
+ */
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <pthread.h>
+#include "sim.h"
+
+/*---------------------------------------------------------------------------*/
+sim_params_t sim_params = {
+  .duration    = 60 * SIM_HF_CLKSPEED,
+  .boot_delay  = SIM_MS_TO_VTIME(1000),
+  .t_tx_offset = SIM_HF_CLKSPEED / 800,
+  .t_rxtx      = SIM_HF_CLKSPEED / 5000,          /* 200 us */
+  .seed        = 1,
+  .bitrate     = 250000,
+  .num_nodes   = 50,
+  .area        = 100,
+  .range       = 40,
+  .p_capture   = 0.5,
+  .p_ci        = 0.9,
+  .noise_floor = -100,
+  .num_threads = 1,
+};
+sim_node_t* sim_nodes;
+uint16_t    sim_num_nodes;
+sim_stats_t sim_stats;
+
+static uint64_t rand_state;
+static uint32_t* heap;              /* min-heap of nodes by next event */
+static uint32_t  heap_size;
+static FILE* report;
+/* the nodes due at the current time step, executed by the worker threads */
+static struct {
+  uint32_t* due;
+  uint32_t  n_due;
+  uint32_t  next;               /* index of the next node to execute */
+  uint64_t  now;
+  uint8_t   stop;
+} step;
+static pthread_t* workers;
+static pthread_barrier_t step_start;
+static pthread_barrier_t step_done;
+/*---------------------------------------------------------------------------*/
+void
+sim_rand_init(uint32_t seed)
+{
+  rand_state = ((uint64_t)seed << 1) | 1;
+}
+/*---------------------------------------------------------------------------*/
+double
+sim_rand(void)
+{
+  /* xorshift64* */
+  rand_state ^= rand_state >> 12;
+  rand_state ^= rand_state << 25;
+  rand_state ^= rand_state >> 27;
+  return (double)((rand_state * 2685821657736338717ULL) >> 11) /
+         (double)(1ULL << 53);
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_swap(uint32_t a, uint32_t b)
+{
+  uint32_t tmp = heap[a];
+  heap[a] = heap[b];
+  heap[b] = tmp;
+  sim_nodes[heap[a]].heap_pos = a;
+  sim_nodes[heap[b]].heap_pos = b;
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_push(uint32_t n)
+{
+  uint32_t i = heap_size++;
+  heap[i] = n;
+  sim_nodes[n].heap_pos = i;
+  while(i && sim_nodes[heap[(i - 1) / 2]].next_event >
+             sim_nodes[heap[i]].next_event) {
+    heap_swap(i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+heap_pop(void)
+{
+  uint32_t i = 0, top = heap[0];
+  heap_size--;
+  if(heap_size) {
+    heap[0] = heap[heap_size];
+    sim_nodes[heap[0]].heap_pos = 0;
+    while(1) {
+      uint32_t l = 2 * i + 1, r = l + 1, min = i;
+      if(l < heap_size && sim_nodes[heap[l]].next_event <
+                          sim_nodes[heap[min]].next_event) {
+        min = l;
+      }
+      if(r < heap_size && sim_nodes[heap[r]].next_event <
+                          sim_nodes[heap[min]].next_event) {
+        min = r;
+      }
+      if(min == i) {
+        break;
+      }
+      heap_swap(i, min);
+      i = min;
+    }
+  }
+  return top;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+load_nodes(void)
+{
+  uint16_t i;
+  long size;
+  uint8_t* lib;
+  char dir[256];
+  const char* tmp_dir;
+  FILE* f = fopen(sim_params.node_lib, "rb");
+
+  if(!f) {
+    fprintf(stderr, "can't open node library '%s'\n", sim_params.node_lib);
+    return 0;
+  }
+  fseek(f, 0, SEEK_END);
+  size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  lib = malloc(size);
+  if(!lib || fread(lib, 1, size, f) != (size_t)size) {
+    fprintf(stderr, "can't read node library\n");
+    fclose(f);
+    free(lib);
+    return 0;
+  }
+  fclose(f);
+
+  tmp_dir = getenv("TMPDIR");
+  snprintf(dir, sizeof(dir), "%s/lwb-sim-XXXXXX", tmp_dir ? tmp_dir : "/tmp");
+  if(!mkdtemp(dir)) {
+    fprintf(stderr, "can't create temporary directory\n");
+    free(lib);
+    return 0;
+  }
+  for(i = 0; i < sim_num_nodes; i++) {
+    sim_node_t* node = &sim_nodes[i];
+    char path[sizeof(dir) + 16];
+    /* the dynamic linker loads a library only once per file name, therefore
+     * each node gets its own (temporary) copy of the library */
+    snprintf(path, sizeof(path), "%s/%u.so", dir, node->id);
+    f = fopen(path, "wb");
+    if(!f) {
+      break;
+    }
+    if(fwrite(lib, 1, size, f) != (size_t)size) {
+      fclose(f);
+      unlink(path);
+      break;
+    }
+    fclose(f);
+    node->lib = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    unlink(path);
+    if(!node->lib) {
+      fprintf(stderr, "%s\n", dlerror());
+      break;
+    }
+    node->init = (sim_node_init_t)dlsym(node->lib, "sim_node_init");
+    node->get_next_event = (sim_node_next_event_t)dlsym(node->lib,
+                                                   "sim_node_next_event");
+    node->run = (sim_node_run_t)dlsym(node->lib, "sim_node_run");
+    if(!node->init || !node->get_next_event || !node->run) {
+      break;
+    }
+    /* power-up */
+    node->booted = 0;
+    node->next_event = (uint64_t)(sim_rand() * sim_params.boot_delay);
+    heap_push(i);
+  }
+  rmdir(dir);
+  free(lib);
+  if(i < sim_num_nodes) {
+    fprintf(stderr, "can't load node library instance\n");
+    return 0;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_node(uint32_t n, uint64_t now)
+{
+  sim_node_t* node = &sim_nodes[n];
+  uint64_t next;
+
+  if(!node->booted) {
+    node->booted = 1;
+    node->init(node->id, sim_params.seed + node->id, now);
+  } else {
+    node->run(now);
+  }
+  if(node->get_next_event(&next)) {
+    node->next_event = (next < now) ? now : next;
+  } else {
+    node->next_event = SIM_NO_EVENT;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_step(void)
+{
+  uint32_t i;
+  /* each thread takes the next node until all nodes have been executed */
+  while((i = __sync_fetch_and_add(&step.next, 1)) < step.n_due) {
+    run_node(step.due[i], step.now);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void*
+worker(void* arg)
+{
+  while(1) {
+    pthread_barrier_wait(&step_start);
+    if(step.stop) {
+      break;
+    }
+    run_step();
+    pthread_barrier_wait(&step_done);
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+start_workers(void)
+{
+  uint16_t i;
+
+  if(sim_params.num_threads < 2) {
+    return 1;
+  }
+  workers = malloc((sim_params.num_threads - 1) * sizeof(pthread_t));
+  if(!workers ||
+     pthread_barrier_init(&step_start, 0, sim_params.num_threads) ||
+     pthread_barrier_init(&step_done, 0, sim_params.num_threads)) {
+    return 0;
+  }
+  for(i = 0; i < sim_params.num_threads - 1; i++) {
+    if(pthread_create(&workers[i], 0, worker, 0)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+stop_workers(void)
+{
+  uint16_t i;
+
+  if(sim_params.num_threads < 2) {
+    return;
+  }
+  step.stop = 1;
+  pthread_barrier_wait(&step_start);
+  for(i = 0; i < sim_params.num_threads - 1; i++) {
+    pthread_join(workers[i], 0);
+  }
+  pthread_barrier_destroy(&step_start);
+  pthread_barrier_destroy(&step_done);
+  free(workers);
+}
+/*---------------------------------------------------------------------------*/
+static void
+run(void)
+{
+  uint32_t i;
+
+  step.due = malloc(sim_num_nodes * sizeof(uint32_t));
+  while(heap_size) {
+    step.now = sim_nodes[heap[0]].next_event;
+    if(step.now > sim_params.duration) {
+      break;
+    }
+    /* execute all nodes with an event at this time */
+    step.n_due = 0;
+    step.next = 0;
+    while(heap_size && sim_nodes[heap[0]].next_event == step.now) {
+      step.due[step.n_due++] = heap_pop();
+    }
+    if(sim_params.num_threads > 1 && step.n_due >= SIM_PARALLEL_MIN_NODES) {
+      pthread_barrier_wait(&step_start);
+      run_step();
+      pthread_barrier_wait(&step_done);
+    } else {
+      run_step();
+    }
+    /* all nodes are done with this time step: resolve the flood */
+    flood_resolve();
+    for(i = 0; i < step.n_due; i++) {
+      if(sim_nodes[step.due[i]].next_event != SIM_NO_EVENT) {
+        heap_push(step.due[i]);
+      }
+    }
+  }
+  free(step.due);
+}
+/*---------------------------------------------------------------------------*/
+static void
+print_report(void)
+{
+  uint16_t i;
+  uint64_t floods_rcv = 0, floods_missed = 0, hop_sum = 0, radio_on = 0;
+  double duration_ms = SIM_VTIME_TO_MS(sim_params.duration);
+
+  fprintf(report, "# node  init  rcvd  missed  rate[%%]  hops  "
+                  "radio_on[ms]  duty_cycle[%%]\n");
+  for(i = 0; i < sim_num_nodes; i++) {
+    sim_node_t* node = &sim_nodes[i];
+    uint32_t total = node->floods_rcv + node->floods_missed;
+    fprintf(report, "%6u %5u %5u %7u %8.2f %5.2f %13.1f %14.3f\n",
+            node->id, node->floods_init, node->floods_rcv, 
+            node->floods_missed,
+            total ? 100.0 * node->floods_rcv / total : 0.0,
+            node->floods_rcv ? (double)node->hop_sum / node->floods_rcv : 0.0,
+            SIM_VTIME_TO_MS(node->radio_on),
+            100.0 * SIM_VTIME_TO_MS(node->radio_on) / duration_ms);
+    floods_rcv += node->floods_rcv;
+    floods_missed += node->floods_missed;
+    hop_sum += node->hop_sum;
+    radio_on += node->radio_on;
+  }
+  if(sim_stats.rounds) {
+    /* the last round */
+    uint64_t len = sim_stats.t_round_end - sim_stats.t_round_start;
+    sim_stats.round_len_sum += len;
+    if(len > sim_stats.round_len_max) {
+      sim_stats.round_len_max = len;
+    }
+  }
+  fprintf(report, "# nodes:              %u\n", sim_num_nodes);
+  fprintf(report, "# simulated time:     %.1f s\n", duration_ms / 1000);
+  fprintf(report, "# floods:             %u (%u with multiple initiators)\n",
+          sim_stats.floods, sim_stats.floods_concurrent);
+  fprintf(report, "# reception rate:     %.2f %%\n",
+          (floods_rcv + floods_missed) ?
+          100.0 * floods_rcv / (floods_rcv + floods_missed) : 0.0);
+  fprintf(report, "# avg. hop count:     %.2f\n",
+          floods_rcv ? (double)hop_sum / floods_rcv : 0.0);
+  fprintf(report, "# rounds:             %u\n", sim_stats.rounds);
+  fprintf(report, "# avg. round length:  %.2f ms (max. %.2f ms)\n",
+          sim_stats.rounds ?
+          SIM_VTIME_TO_MS(sim_stats.round_len_sum) / sim_stats.rounds : 0.0,
+          SIM_VTIME_TO_MS(sim_stats.round_len_max));
+  fprintf(report, "# avg. radio duty cycle: %.3f %%\n",
+          100.0 * SIM_VTIME_TO_MS(radio_on) / sim_num_nodes / duration_ms);
+}
+/*---------------------------------------------------------------------------*/
+static char*
+default_node_lib(const char* exe)
+{
+  size_t len = strlen(exe);
+  char* lib = malloc(len + 8);
+  if(lib) {
+    strcpy(lib, exe);
+    if(len > 4 && strcmp(lib + len - 4, ".exe") == 0) {
+      lib[len - 4] = 0;
+    }
+    strcat(lib, "-node.so");
+  }
+  return lib;
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char** argv)
+{
+  int opt;
+  char* node_lib = 0;
+
+  while((opt = getopt(argc, argv, "N:w:r:f:t:s:b:c:i:l:j:q")) != -1) {
+    switch(opt) {
+    case 'N':
+      sim_params.num_nodes = (uint16_t)atoi(optarg);
+      break;
+    case 'w':
+      sim_params.area = atof(optarg);
+      break;
+    case 'r':
+      sim_params.range = atof(optarg);
+      break;
+    case 'f':
+      sim_params.topology_file = optarg;
+      break;
+    case 't':
+      sim_params.duration = (uint64_t)(atof(optarg) * SIM_HF_CLKSPEED);
+      break;
+    case 's':
+      sim_params.seed = (uint32_t)strtoul(optarg, 0, 0);
+      break;
+    case 'b':
+      sim_params.boot_delay = SIM_MS_TO_VTIME(atoi(optarg));
+      break;
+    case 'c':
+      sim_params.p_capture = atof(optarg);
+      break;
+    case 'i':
+      sim_params.p_ci = atof(optarg);
+      break;
+    case 'l':
+      sim_params.node_lib = optarg;
+      break;
+    case 'j':
+      sim_params.num_threads = (uint16_t)atoi(optarg);
+      break;
+    case 'q':
+      sim_params.quiet = 1;
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-N nodes] [-w area] [-r range] [-f file] "
+                      "[-t seconds] [-s seed] [-b boot_delay_ms] "
+                      "[-c p_capture] [-i p_ci] [-l node_lib] [-j threads] [-q]\n",
+              argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if(!sim_params.node_lib) {
+    node_lib = default_node_lib(argv[0]);
+    sim_params.node_lib = node_lib;
+  }
+  report = stdout;
+  if(sim_params.quiet) {
+    /* the nodes print to stdout */
+    report = fdopen(dup(fileno(stdout)), "w");
+    if(!report || !freopen("/dev/null", "w", stdout)) {
+      return EXIT_FAILURE;
+    }
+  }
+  sim_rand_init(sim_params.seed);
+  if(!topology_init() || !flood_init()) {
+    return EXIT_FAILURE;
+  }
+  heap = malloc(sim_num_nodes * sizeof(uint32_t));
+  if(!heap || !load_nodes() || !start_workers()) {
+    return EXIT_FAILURE;
+  }
+  run();
+  stop_workers();
+  fflush(stdout);
+  print_report();
+  fclose(report);
+  free(heap);
+  free(node_lib);
+  topology_free();
+  return EXIT_SUCCESS;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ *
+ * @brief discrete-event network simulator for LWB
+ *
+ * Each node runs the unmodified node code (LWB, Glossy interface, 
+ * application) on the virtual clock of the native platform. The simulator
+ * advances the virtual time from one node event to the next and emulates
+ * the Glossy floods with a flood model (see flood.c).
+ */
+
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sim-node.h"
+
+#define SIM_MAX_NODES           4096
+#define SIM_NO_EVENT            UINT64_MAX
+/* min. number of nodes with an event at the same time to execute them in
+ * parallel (the synchronization overhead outweighs the gain otherwise) */
+#define SIM_PARALLEL_MIN_NODES  8
+
+/* conversion between virtual time and milliseconds */
+#define SIM_MS_TO_VTIME(ms)     ((uint64_t)(ms) * SIM_HF_CLKSPEED / 1000)
+#define SIM_VTIME_TO_MS(t)      ((double)(t) * 1000.0 / SIM_HF_CLKSPEED)
+
+/**
+ * @brief simulation parameters
+ */
+typedef struct {
+  uint64_t duration;        /* simulated time (virtual time) */
+  uint64_t boot_delay;      /* max. boot delay of the nodes (virtual time) */
+  uint64_t t_tx_offset;     /* delay between the start of Glossy and the first
+                               transmission of the initiator (virtual time) */
+  uint64_t t_rxtx;          /* RX/TX turnaround time (virtual time) */
+  uint32_t seed;
+  uint32_t bitrate;         /* radio bitrate in bits per second */
+  uint16_t num_nodes;       /* number of nodes (generated topology) */
+  uint16_t num_threads;     /* number of threads executing the nodes */
+  double   area;            /* side length of the area (generated topology) */
+  double   range;           /* max. communication range (gen. topology) */
+  double   p_capture;       /* prob. that a receiver captures one of several
+                               different packets transmitted concurrently */
+  double   p_ci;            /* prob. that a receiver decodes the same packet
+                               transmitted concurrently by several nodes
+                               (constructive interference) */
+  double   noise_floor;     /* in dBm */
+  const char* topology_file;
+  const char* node_lib;
+  uint8_t  quiet;           /* suppress the output of the nodes */
+} sim_params_t;
+
+/**
+ * @brief a (directed) wireless link
+ */
+typedef struct {
+  uint16_t dst;             /* index of the destination node */
+  float    prr;             /* packet reception ratio */
+} sim_link_t;
+
+/**
+ * @brief state of a simulated node
+ */
+typedef struct {
+  uint16_t id;
+  uint8_t  booted;
+  uint64_t next_event;      /* virtual time of the next event */
+  uint32_t heap_pos;
+  /* node instance */
+  void* lib;
+  sim_node_init_t       init;
+  sim_node_next_event_t get_next_event;
+  sim_node_run_t        run;
+  /* topology */
+  double x;
+  double y;
+  sim_link_t* links;        /* outgoing links */
+  uint16_t n_links;
+  /* Glossy state */
+  uint8_t  glossy_active;
+  uint8_t  res_valid;
+  uint64_t t_glossy_start;
+  uint64_t t_first_rx_end;  /* end of the first reception (virtual time) */
+  uint64_t t_done;          /* end of the participation in the flood */
+  sim_flood_result_t res;
+  uint8_t  payload[SIM_MAX_PAYLOAD_LEN];
+  /* statistics */
+  uint64_t radio_on;        /* radio-on time (virtual time) */
+  uint32_t floods_init;     /* floods initiated by this node */
+  uint32_t floods_rcv;      /* floods received by this node */
+  uint32_t floods_missed;   /* floods not received by this node */
+  uint32_t hop_sum;         /* sum of relay_cnt_first_rx of received floods */
+} sim_node_t;
+
+/**
+ * @brief global statistics
+ */
+typedef struct {
+  uint32_t floods;
+  uint32_t floods_concurrent;   /* floods with multiple initiators */
+  uint32_t rounds;
+  uint64_t round_len_sum;
+  uint64_t round_len_max;
+  uint64_t t_round_start;
+  uint64_t t_round_end;
+} sim_stats_t;
+
+
+extern sim_params_t sim_params;
+extern sim_node_t*  sim_nodes;
+extern uint16_t     sim_num_nodes;
+extern sim_stats_t  sim_stats;
+
+/**
+ * @brief get the node with the given ID
+ * @return pointer to the node or 0 if there is no node with this ID
+ */
+sim_node_t* sim_get_node(uint16_t id);
+
+/**
+ * @brief uniformly distributed random number in [0, 1)
+ */
+double sim_rand(void);
+
+/**
+ * @brief seed the random number generator of the simulator
+ */
+void sim_rand_init(uint32_t seed);
+
+/**
+ * @brief load the topology from a file or generate a random topology
+ * @return 1 if successful, 0 otherwise
+ */
+uint8_t topology_init(void);
+
+/**
+ * @brief release the memory allocated for the topology
+ */
+void topology_free(void);
+
+/**
+ * @brief resolve the pending flood (if any), i.e. compute the propagation of
+ * the packet(s) through the network
+ * @note must be called after all nodes have executed their events for the
+ * current virtual time
+ */
+void flood_resolve(void);
+
+/**
+ * @brief allocate the memory for the flood model
+ * @note sim_glossy_start() and sim_glossy_stop() may be called concurrently
+ * by the nodes, flood_resolve() must not
+ */
+uint8_t flood_init(void);
+
+#endif /* __SIM_H__ */
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2016, Swiss Federal Institute of Technology (ETH Zurich).
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ *
+ * @brief network topology of the simulation
+ *
+ * The topology is either loaded from a file or generated randomly. 
+ * A topology file contains one directed link per line:
+ *
+ *   <source node ID> <destination node ID> <PRR>
+ *
+ * Lines starting with '#' are ignored. A random topology consists of
+ * num_nodes nodes placed uniformly at random in a square area. The PRR of a 
+ * link is 1 up to half the communication range and then decreases linearly to
+ * 0 at the communication range. The nodes get the IDs 1 to num_nodes.
+ */
+
+#include <math.h>
+#include "sim.h"
+
+#define TOPOLOGY_MAX_LINE_LEN   128
+
+/*---------------------------------------------------------------------------*/
+static uint16_t node_idx[65536];        /* node index + 1 (0 = no node) */
+/*---------------------------------------------------------------------------*/
+sim_node_t*
+sim_get_node(uint16_t id)
+{
+  if(node_idx[id]) {
+    return &sim_nodes[node_idx[id] - 1];
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static sim_node_t*
+topology_add_node(uint16_t id)
+{
+  sim_node_t* node = sim_get_node(id);
+  if(node) {
+    return node;
+  }
+  if(sim_num_nodes >= SIM_MAX_NODES) {
+    fprintf(stderr, "too many nodes (max. %u)\n", SIM_MAX_NODES);
+    return 0;
+  }
+  node = &sim_nodes[sim_num_nodes];
+  memset(node, 0, sizeof(sim_node_t));
+  node->id = id;
+  node_idx[id] = ++sim_num_nodes;
+  return node;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+topology_add_link(sim_node_t* src, sim_node_t* dst, float prr)
+{
+  sim_link_t* links;
+  uint16_t i;
+  
+  if(src == dst || prr <= 0) {
+    return 1;
+  }
+  for(i = 0; i < src->n_links; i++) {
+    if(src->links[i].dst == (dst - sim_nodes)) {
+      src->links[i].prr = prr;            /* update existing link */
+      return 1;
+    }
+  }
+  links = realloc(src->links, (src->n_links + 1) * sizeof(sim_link_t));
+  if(!links) {
+    return 0;
+  }
+  src->links = links;
+  src->links[src->n_links].dst = dst - sim_nodes;
+  src->links[src->n_links].prr = (prr > 1) ? 1 : prr;
+  src->n_links++;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+topology_load(const char* filename)
+{
+  char line[TOPOLOGY_MAX_LINE_LEN];
+  unsigned int src, dst, line_no = 0;
+  float prr;
+  FILE* f = fopen(filename, "r");
+  
+  if(!f) {
+    fprintf(stderr, "can't open topology file '%s'\n", filename);
+    return 0;
+  }
+  while(fgets(line, sizeof(line), f)) {
+    sim_node_t *s, *d;
+    line_no++;
+    if(line[0] == '#' || line[strspn(line, " \t\r\n")] == 0) {
+      continue;
+    }
+    if(sscanf(line, "%u %u %f", &src, &dst, &prr) != 3 ||
+       src > 0xffff || dst > 0xffff) {
+      fprintf(stderr, "%s:%u: invalid link\n", filename, line_no);
+      fclose(f);
+      return 0;
+    }
+    s = topology_add_node(src);
+    d = topology_add_node(dst);
+    if(!s || !d || !topology_add_link(s, d, prr)) {
+      fclose(f);
+      return 0;
+    }
+  }
+  fclose(f);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static float
+topology_prr(double dist)
+{
+  if(dist <= sim_params.range / 2) {
+    return 1.0f;
+  } else if(dist >= sim_params.range) {
+    return 0.0f;
+  }
+  return (float)(2.0 * (sim_params.range - dist) / sim_params.range);
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+topology_generate(void)
+{
+  uint16_t i, j;
+  
+  for(i = 0; i < sim_params.num_nodes; i++) {
+    sim_node_t* node = topology_add_node(i + 1);
+    if(!node) {
+      return 0;
+    }
+    node->x = sim_rand() * sim_params.area;
+    node->y = sim_rand() * sim_params.area;
+  }
+  for(i = 0; i < sim_num_nodes; i++) {
+    for(j = 0; j < sim_num_nodes; j++) {
+      double dx = sim_nodes[i].x - sim_nodes[j].x;
+      double dy = sim_nodes[i].y - sim_nodes[j].y;
+      if(!topology_add_link(&sim_nodes[i], &sim_nodes[j],
+                            topology_prr(sqrt(dx * dx + dy * dy)))) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+topology_init(void)
+{
+  sim_nodes = calloc(SIM_MAX_NODES, sizeof(sim_node_t));
+  if(!sim_nodes) {
+    return 0;
+  }
+  if(sim_params.topology_file) {
+    if(!topology_load(sim_params.topology_file)) {
+      return 0;
+    }
+  } else if(!topology_generate()) {
+    return 0;
+  }
+  if(!sim_num_nodes) {
+    fprintf(stderr, "empty topology\n");
+    return 0;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+topology_free(void)
+{
+  uint16_t i;
+  for(i = 0; i < sim_num_nodes; i++) {
+    free(sim_nodes[i].links);
+  }
+  free(sim_nodes);
+  sim_nodes = 0;
+  sim_num_nodes = 0;
+}
+/*---------------------------------------------------------------------------*/